@@ -131,7 +131,7 @@ public:
   virtual common::Error
   produce(portable::Cache &input,
           std::vector<portable::Transporter *> &nearby_transporters,
-          std::vector<portable::Portable *> &output) = 0;
+          std::vector<portable::Resource> &output) = 0;
 
   // Helpers
   virtual std::string to_string() const = 0;
@@ -0,0 +1,97 @@
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <buildings/Building.h>
+#include <buildings/Recipes.h>
+#include <common/Errors.h>
+#include <portables/resources/Cache.h>
+#include <tiles/Tile.h>
+#include <tiles/Tile_map.h>
+#include <tiles/components/Area.h>
+#include <tiles/components/Terrain.h>
+
+namespace building
+{
+Building_mask affordable(const Needs &have)
+{
+  return CONSTRUCTION_COSTS.buildings(CONSTRUCTION_COSTS.match(have));
+}
+
+Building_mask sites(const tile::Tile *tile)
+{
+  if ((nullptr == tile) || (!tile::is_valid(tile->get_terrain())))
+  {
+    return 0;
+  }
+  Building_mask retval = TERRAIN_SITES[tile->get_terrain()];
+  if ((0 != (retval & SHORE_SITES)) && (!tile->is_shore()))
+  {
+    retval &= ~SHORE_SITES;
+  }
+  return retval;
+}
+
+Building_mask buildable(const portable::Cache &input, const tile::Tile *tile)
+{
+  Building_mask retval = sites(tile);
+  return (0 != retval) ? (retval & affordable(input.counts())) : 0;
+}
+
+Building_mask producible(const Needs &have)
+{
+  return PRODUCTION_RECIPES.buildings(PRODUCTION_RECIPES.match(have));
+}
+
+bool can_build(const Building::Type t, const portable::Cache &input,
+               const tile::Tile *tile)
+{
+  return (is_valid(t) && (0 != (building_bit(t) & buildable(input, tile))));
+}
+
+common::Error remove_construction_resources(const Building::Type t,
+                                            portable::Cache &input)
+{
+  if (!is_valid(t))
+  {
+    return common::ERR_INVALID;
+  }
+  return input.remove(CONSTRUCTION_COSTS[t].needs);
+}
+
+void match_areas(std::span<const tile::Tile *const> tiles,
+                 std::vector<Area_match> &result)
+{
+  result.clear();
+  for (const tile::Tile *tile : tiles)
+  {
+    if (nullptr == tile)
+    {
+      continue;
+    }
+    // The tile's share of the answer is the same for each of its areas.
+    const Building_mask room =
+        (nullptr == tile->get_building()) ? sites(tile) : 0;
+    for (const tile::Area &area : tile->get_areas())
+    {
+      const Needs &have = area.get_resource_counts();
+      result.push_back({tile, &area,
+                        (0 != room) ? (room & affordable(have)) : 0,
+                        producible(have)});
+    }
+  }
+}
+
+common::Error match_areas(const tile::Tile_map &map,
+                          std::vector<Area_match> &result)
+{
+  const tile::Compiled_map *compiled = map.compiled();
+  if (nullptr == compiled)
+  {
+    result.clear();
+    return common::ERR_FAIL;
+  }
+  match_areas(compiled->tiles, result);
+  return common::ERR_NONE;
+}
+} // namespace building
@@ -0,0 +1,318 @@
+#ifndef RECIPES_H
+#define RECIPES_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <buildings/Building.h>
+#include <common/Errors.h>
+#include <portables/resources/Cache.h>
+#include <portables/resources/Resource.h>
+#include <tiles/components/Terrain.h>
+
+namespace tile
+{
+class Area;
+class Tile;
+class Tile_map;
+} // namespace tile
+
+namespace building
+{
+/// Resources a recipe takes, indexed by portable::Resource::Type.
+using Needs = portable::Cache::Counts;
+
+/// Mask with bit t set for each Building::Type t.
+using Building_mask = uint16_t;
+static_assert(BUILDING_NAMES_SIZE <= 16);
+
+constexpr Building_mask building_bit(const Building::Type t)
+{
+  return static_cast<Building_mask>(1u << t);
+}
+
+/// Builds a list of needs from the amounts of the types it takes.
+/// @param[in] amounts  Type and amount of each resource taken
+/// @return The needs, with every other type at 0
+constexpr Needs
+needs_of(std::initializer_list<std::pair<portable::Resource::Type, uint16_t>>
+             amounts)
+{
+  Needs retval{};
+  for (const auto &[t, amount] : amounts)
+  {
+    retval[t] = amount;
+  }
+  return retval;
+}
+
+/// One way for a building to be built or to produce: the resources it takes.
+struct Recipe
+{
+  Building::Type building;
+  Needs needs;
+};
+
+/// A fixed set of recipes, matched against resource counts all at once.
+/// Rather than comparing counts against each recipe in turn, the recipes are
+/// turned on their side: for every resource type and amount, there's a mask
+/// of the recipes that need more than that. Matching is then one lookup per
+/// resource type, however many recipes there are.
+template <size_t N> class Recipe_book
+{
+public:
+  using Mask = uint32_t;
+  static_assert(N <= 32);
+
+  /// Counts past this all look the same to the book; no recipe may need more.
+  static constexpr uint16_t MAX_AMOUNT = 7;
+  static constexpr Mask ALL = (N == 32) ? ~Mask{0} : ((Mask{1} << N) - 1);
+
+  constexpr Recipe_book(const std::array<Recipe, N> &recipes)
+      : m_recipes(recipes), m_short{}, m_buildings{}
+  {
+    for (size_t i = 0; i < N; i++)
+    {
+      for (size_t r = 0; r < portable::RESOURCE_TYPES; r++)
+      {
+        for (uint16_t a = 0; (a < recipes[i].needs[r]) && (a <= MAX_AMOUNT);
+             a++)
+        {
+          m_short[r][a] |= Mask{1} << i;
+        }
+      }
+      m_buildings[i] = building_bit(recipes[i].building);
+    }
+  }
+
+  /// Returns whether every recipe fits within MAX_AMOUNT of each type
+  constexpr bool fits() const
+  {
+    for (const Recipe &recipe : m_recipes)
+    {
+      for (uint16_t amount : recipe.needs)
+      {
+        if (MAX_AMOUNT < amount)
+        {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  inline const Recipe &operator[](const size_t i) const
+  {
+    return m_recipes[i];
+  }
+  static constexpr size_t size() { return N; }
+
+  /// Returns the recipes the input counts cover.
+  /// @param[in] have  Amount available of every resource type
+  /// @return Mask with bit i set when recipe i is covered
+  inline Mask match(const Needs &have) const
+  {
+    Mask shortfall = 0;
+    for (size_t r = 0; r < portable::RESOURCE_TYPES; r++)
+    {
+      uint16_t amount = (MAX_AMOUNT < have[r]) ? MAX_AMOUNT : have[r];
+      shortfall |= m_short[r][amount];
+    }
+    return ALL & ~shortfall;
+  }
+
+  /// Returns the buildings the input recipes belong to
+  /// @param[in] recipes  Mask of recipes, as returned by match()
+  inline Building_mask buildings(const Mask recipes) const
+  {
+    Building_mask retval = 0;
+    for (size_t i = 0; i < N; i++)
+    {
+      retval |= m_buildings[i] & (0 - ((recipes >> i) & 1));
+    }
+    return retval;
+  }
+
+private:
+  std::array<Recipe, N> m_recipes;
+  Mask m_short[portable::RESOURCE_TYPES][MAX_AMOUNT + 1];
+  Building_mask m_buildings[N];
+};
+
+/// What each building costs to build, in Building::Type order.
+inline constexpr Recipe_book<BUILDING_NAMES_SIZE> CONSTRUCTION_COSTS({{
+    {Building::Type::woodcutter, needs_of({{portable::Resource::boards, 1}})},
+    {Building::Type::oil_rig,
+     needs_of({{portable::Resource::boards, 3},
+               {portable::Resource::stone, 1}})},
+    {Building::Type::quarry, needs_of({{portable::Resource::boards, 2}})},
+    {Building::Type::clay_pit, needs_of({{portable::Resource::boards, 3}})},
+    {Building::Type::mine,
+     needs_of({{portable::Resource::boards, 3},
+               {portable::Resource::stone, 1}})},
+    {Building::Type::sawmill,
+     needs_of({{portable::Resource::boards, 2},
+               {portable::Resource::stone, 1}})},
+    {Building::Type::coal_burner, needs_of({{portable::Resource::boards, 3}})},
+    {Building::Type::papermill,
+     needs_of({{portable::Resource::boards, 1},
+               {portable::Resource::stone, 1}})},
+    {Building::Type::stone_factory,
+     needs_of({{portable::Resource::boards, 2}})},
+    {Building::Type::mint,
+     needs_of({{portable::Resource::boards, 2},
+               {portable::Resource::stone, 1}})},
+    {Building::Type::stock_exchange,
+     needs_of({{portable::Resource::stone, 3}})},
+    {Building::Type::wagon_factory,
+     needs_of({{portable::Resource::boards, 2},
+               {portable::Resource::stone, 1}})},
+    {Building::Type::truck_factory,
+     needs_of({{portable::Resource::boards, 2},
+               {portable::Resource::stone, 2}})},
+    {Building::Type::raft_factory,
+     needs_of({{portable::Resource::boards, 1},
+               {portable::Resource::stone, 1}})},
+    {Building::Type::rowboat_factory,
+     needs_of({{portable::Resource::boards, 2},
+               {portable::Resource::stone, 1}})},
+    {Building::Type::steamer_factory,
+     needs_of({{portable::Resource::boards, 2},
+               {portable::Resource::stone, 2}})},
+}});
+static_assert(CONSTRUCTION_COSTS.fits());
+
+/// What it takes for each building to produce once. Buildings with more than
+/// one way to produce have a recipe for each; primary producers need nothing.
+/// Transporters a factory needs, like the wagon factory's donkey, aren't
+/// resources and aren't listed.
+inline constexpr Recipe_book<18> PRODUCTION_RECIPES({{
+    {Building::Type::woodcutter, needs_of({})},
+    {Building::Type::oil_rig, needs_of({})},
+    {Building::Type::quarry, needs_of({})},
+    {Building::Type::clay_pit, needs_of({})},
+    {Building::Type::mine, needs_of({})},
+    {Building::Type::sawmill, needs_of({{portable::Resource::trunks, 1}})},
+    {Building::Type::coal_burner, needs_of({{portable::Resource::boards, 2}})},
+    {Building::Type::coal_burner, needs_of({{portable::Resource::trunks, 2}})},
+    {Building::Type::papermill, needs_of({{portable::Resource::boards, 2}})},
+    {Building::Type::papermill, needs_of({{portable::Resource::trunks, 2}})},
+    {Building::Type::stone_factory, needs_of({{portable::Resource::clay, 1}})},
+    {Building::Type::mint,
+     needs_of({{portable::Resource::fuel, 1}, {portable::Resource::gold, 2}})},
+    {Building::Type::stock_exchange,
+     needs_of({{portable::Resource::paper, 1},
+               {portable::Resource::coins, 2}})},
+    {Building::Type::wagon_factory,
+     needs_of({{portable::Resource::boards, 2}})},
+    {Building::Type::truck_factory,
+     needs_of({{portable::Resource::fuel, 1}, {portable::Resource::iron, 1}})},
+    {Building::Type::raft_factory, needs_of({{portable::Resource::trunks, 2}})},
+    {Building::Type::rowboat_factory,
+     needs_of({{portable::Resource::boards, 5}})},
+    {Building::Type::steamer_factory,
+     needs_of({{portable::Resource::fuel, 2}, {portable::Resource::iron, 1}})},
+}});
+static_assert(PRODUCTION_RECIPES.fits());
+
+/// Buildings allowed on each terrain, before checking for the shore.
+inline constexpr Building_mask LAND_SITES =
+    building_bit(Building::Type::clay_pit) |
+    building_bit(Building::Type::sawmill) |
+    building_bit(Building::Type::coal_burner) |
+    building_bit(Building::Type::papermill) |
+    building_bit(Building::Type::stone_factory) |
+    building_bit(Building::Type::mint) |
+    building_bit(Building::Type::stock_exchange) |
+    building_bit(Building::Type::wagon_factory) |
+    building_bit(Building::Type::truck_factory) |
+    building_bit(Building::Type::raft_factory) |
+    building_bit(Building::Type::rowboat_factory) |
+    building_bit(Building::Type::steamer_factory);
+inline constexpr Building_mask TERRAIN_SITES[tile::MAX_TERRAIN_TYPES] = {
+    0,                                                     // desert
+    LAND_SITES | building_bit(Building::Type::woodcutter), // forest
+    LAND_SITES | building_bit(Building::Type::mine),       // mountain
+    LAND_SITES,                                            // plains
+    LAND_SITES | building_bit(Building::Type::quarry),     // rock
+    building_bit(Building::Type::oil_rig)};                // sea
+
+/// Buildings that can only go on the shore.
+inline constexpr Building_mask SHORE_SITES =
+    building_bit(Building::Type::clay_pit) |
+    building_bit(Building::Type::raft_factory) |
+    building_bit(Building::Type::rowboat_factory) |
+    building_bit(Building::Type::steamer_factory);
+
+/// What can be done in one area: what could be built there, and which
+/// buildings would have what they need to produce.
+struct Area_match
+{
+  const tile::Tile *tile;
+  const tile::Area *area;
+  Building_mask buildable;
+  Building_mask producible;
+};
+
+/// Returns the buildings whose construction costs the input covers.
+/// @param[in] have  Amount available of every resource type
+Building_mask affordable(const Needs &have);
+
+/// Returns the buildings the input tile has room for. Does not check the tile
+/// for existing buildings.
+/// @param[in] tile
+/// @return Mask of buildings. 0 if tile is null.
+Building_mask sites(const tile::Tile *tile);
+
+/// Returns the buildings that can be placed on the input tile. Does not check
+/// tile for existing buildings, or if the constructing transporter has access
+/// to a specific area.
+/// @param[in] input  Resources available for constructing the building
+/// @param[in] tile  tile to be placing the building
+Building_mask buildable(const portable::Cache &input, const tile::Tile *tile);
+
+/// Returns the buildings that would have the resources to produce at least
+/// once with the input. Doesn't know how much each has already produced.
+/// @param[in] have  Amount available of every resource type
+Building_mask producible(const Needs &have);
+
+/// Determines whether the building can be placed on the input tile. Same
+/// checks as buildable(), for a single building.
+/// @param[in] t  Building to place
+/// @param[in] input  Resources available for constructing the building
+/// @param[in] tile  tile to be placing the building
+bool can_build(const Building::Type t, const portable::Cache &input,
+               const tile::Tile *tile);
+
+/// Removes the construction cost of a building from the input resources.
+/// Nothing is removed if any of it is missing.
+/// @param[in] t  Building being built
+/// @param[in] input  Resources to take the cost from
+/// @return
+///   - common::ERR_NONE on success
+///   - common::ERR_INVALID on invalid building type
+///   - common::ERR_FAIL if input doesn't cover the cost
+common::Error remove_construction_resources(const Building::Type t,
+                                            portable::Cache &input);
+
+/// Matches every area of the input tiles. Tiles with a building already on
+/// them have nothing buildable.
+/// @param[in] tiles
+/// @param[out] result  One match per area, in tile then area order
+void match_areas(std::span<const tile::Tile *const> tiles,
+                 std::vector<Area_match> &result);
+
+/// Same as above for every tile of a locked map, in its compiled order.
+/// @return
+///   - common::ERR_NONE on success
+///   - common::ERR_FAIL if the map isn't locked
+common::Error match_areas(const tile::Tile_map &map,
+                          std::vector<Area_match> &result);
+} // namespace building
+
+#endif
@@ -105,7 +105,7 @@ public:
   virtual common::Error
   produce(portable::Cache &input,
           std::vector<portable::Transporter *> &nearby_transporters,
-          std::vector<portable::Portable *> &output) = 0;
+          std::vector<portable::Resource> &output) = 0;
 
   virtual std::string to_string() const = 0;
   virtual nlohmann::json to_json() const = 0;
@@ -3,6 +3,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <buildings/Recipes.h>
 #include <buildings/factories/Raft_factory.h>
 #include <common/Errors.h>
 #include <players/Player.h>
@@ -47,7 +48,7 @@ bool Raft_factory::can_produce(
 common::Error
 Raft_factory::produce(portable::Cache &input,
                       std::vector<portable::Transporter *> &nearby_transporters,
-                      std::vector<portable::Portable *> &output)
+                      std::vector<portable::Resource> &output)
 {
   if (!can_produce(input, nearby_transporters))
   {
@@ -82,24 +83,14 @@ Raft_factory::produce(portable::Cache &input,
 bool Raft_factory::can_build(const portable::Cache &input,
                              const tile::Tile *tile)
 {
-  return ((input.count(portable::Resource::Type::boards) >= 1) &&
-          (input.count(portable::Resource::Type::stone) >= 1) &&
-          (nullptr != tile) &&
-          (tile::is_valid(tile->get_terrain())) &&
-          (tile::Terrain::sea != tile->get_terrain()) &&
-          (tile::Terrain::desert != tile->get_terrain()) &&
-          (tile->is_shore()));
+  return building::can_build(Building::Type::raft_factory, input, tile);
 }
 
 common::Error Raft_factory::remove_construction_resources(
   portable::Cache &input)
 {
-  common::Error err = input.remove(portable::Resource::Type::boards, 1);
-  if (!err)
-  {
-    err = input.remove(portable::Resource::Type::stone, 1);
-  }
-  return err;
+  return building::remove_construction_resources(
+      Building::Type::raft_factory, input);
 }
 
 std::string Raft_factory::to_string() const
@@ -3,6 +3,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <buildings/Recipes.h>
 #include <buildings/factories/Rowboat_factory.h>
 #include <common/Errors.h>
 #include <players/Player.h>
@@ -48,7 +49,7 @@ bool Rowboat_factory::can_produce(
 common::Error Rowboat_factory::produce(
     portable::Cache &input,
     std::vector<portable::Transporter *> &nearby_transporters,
-    std::vector<portable::Portable *> &output)
+    std::vector<portable::Resource> &output)
 {
   if (!can_produce(input, nearby_transporters))
   {
@@ -83,24 +84,14 @@ common::Error Rowboat_factory::produce(
 bool Rowboat_factory::can_build(const portable::Cache &input,
                                 const tile::Tile *tile)
 {
-  return ((input.count(portable::Resource::Type::boards) >= 2) &&
-          (input.count(portable::Resource::Type::stone) >= 1) &&
-          (nullptr != tile) &&
-          (tile::is_valid(tile->get_terrain())) &&
-          (tile::Terrain::sea != tile->get_terrain()) &&
-          (tile::Terrain::desert != tile->get_terrain()) &&
-          (tile->is_shore()));
+  return building::can_build(Building::Type::rowboat_factory, input, tile);
 }
 
 common::Error Rowboat_factory::remove_construction_resources(
   portable::Cache &input)
 {
-  common::Error err = input.remove(portable::Resource::Type::boards, 2);
-  if (!err)
-  {
-    err = input.remove(portable::Resource::Type::stone, 1);
-  }
-  return err;
+  return building::remove_construction_resources(
+      Building::Type::rowboat_factory, input);
 }
 
 std::string Rowboat_factory::to_string() const
@@ -3,6 +3,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <buildings/Recipes.h>
 #include <buildings/factories/Truck_factory.h>
 #include <common/Errors.h>
 #include <players/Player.h>
@@ -49,7 +50,7 @@ bool Truck_factory::can_produce(
 common::Error Truck_factory::produce(
     portable::Cache &input,
     std::vector<portable::Transporter *> &nearby_transporters,
-    std::vector<portable::Portable *> &output)
+    std::vector<portable::Resource> &output)
 {
   if (!can_produce(input, nearby_transporters))
   {
@@ -89,23 +90,14 @@ common::Error Truck_factory::produce(
 bool Truck_factory::can_build(const portable::Cache &input,
                               const tile::Tile *tile)
 {
-  return ((input.count(portable::Resource::Type::boards) >= 2) &&
-          (input.count(portable::Resource::Type::stone) >= 2) &&
-          (nullptr != tile) &&
-          (tile::is_valid(tile->get_terrain())) &&
-          (tile::Terrain::sea != tile->get_terrain()) &&
-          (tile::Terrain::desert != tile->get_terrain()));
+  return building::can_build(Building::Type::truck_factory, input, tile);
 }
 
 common::Error Truck_factory::remove_construction_resources(
   portable::Cache &input)
 {
-  common::Error err = input.remove(portable::Resource::Type::boards, 2);
-  if (!err)
-  {
-    err = input.remove(portable::Resource::Type::stone, 2);
-  }
-  return err;
+  return building::remove_construction_resources(
+      Building::Type::truck_factory, input);
 }
 
 std::string Truck_factory::to_string() const
@@ -2,6 +2,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <buildings/Recipes.h>
 #include <buildings/producers/Clay_pit.h>
 #include <common/Errors.h>
 #include <players/Player.h>
@@ -31,7 +32,7 @@ Clay_pit Clay_pit::operator=(const Clay_pit &other)
 common::Error
 Clay_pit::produce(portable::Cache &input,
                   std::vector<portable::Transporter *> &nearby_transporters,
-                  std::vector<portable::Portable *> &output)
+                  std::vector<portable::Resource> &output)
 {
   if (!can_produce(input, nearby_transporters))
   {
@@ -41,10 +42,8 @@ Clay_pit::produce(portable::Cache &input,
   uint8_t max = (m_is_powered ? m_production_max * 2 : m_production_max);
   uint8_t to_produce = max - m_production_current;
 
-  for (uint8_t i = 0; i < to_produce; i++)
-  {
-    output.push_back(new portable::Resource(portable::Resource::Type::clay));
-  }
+  output.insert(output.end(), to_produce,
+                portable::Resource(portable::Resource::Type::clay));
   m_production_current += to_produce;
 
   // TODO Ask each nearby transporter (in turn order) whether they'd like the
@@ -54,17 +53,13 @@ Clay_pit::produce(portable::Cache &input,
 
 bool Clay_pit::can_build(const portable::Cache &input, const tile::Tile *tile)
 {
-  return ((input.count(portable::Resource::Type::boards) >= 3) &&
-          (nullptr != tile) &&
-          (tile::is_valid(tile->get_terrain())) &&
-          (tile::Terrain::sea != tile->get_terrain()) &&
-          (tile::Terrain::desert != tile->get_terrain()) &&
-          (tile->is_shore()));
+  return building::can_build(Building::Type::clay_pit, input, tile);
 }
 
 common::Error Clay_pit::remove_construction_resources(portable::Cache &input)
 {
-  return input.remove(portable::Resource::Type::boards, 3);
+  return building::remove_construction_resources(
+      Building::Type::clay_pit, input);
 }
 
 std::string Clay_pit::to_string() const
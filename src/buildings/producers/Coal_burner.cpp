@@ -3,6 +3,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <buildings/Recipes.h>
 #include <buildings/producers/Coal_burner.h>
 #include <common/Errors.h>
 #include <players/Player.h>
@@ -46,7 +47,7 @@ bool Coal_burner::can_produce(
 common::Error
 Coal_burner::produce(portable::Cache &input,
                      std::vector<portable::Transporter *> &nearby_transporters,
-                     std::vector<portable::Portable *> &output)
+                     std::vector<portable::Resource> &output)
 {
   if (!can_produce(input, nearby_transporters))
   {
@@ -69,10 +70,8 @@ Coal_burner::produce(portable::Cache &input,
     err = input.remove(portable::Resource::Type::boards, board_production * 2);
     if (!err)
     {
-      for (uint8_t i = 0; i < board_production; i++)
-      {
-        output.push_back(new portable::Resource(portable::Resource::fuel));
-      }
+      output.insert(output.end(), board_production,
+                    portable::Resource(portable::Resource::fuel));
       m_production_current += board_production;
     }
   }
@@ -87,10 +86,8 @@ Coal_burner::produce(portable::Cache &input,
     err = input.remove(portable::Resource::Type::trunks, trunk_production * 2);
     if (!err)
     {
-      for (uint8_t i = 0; i < trunk_production; i++)
-      {
-        output.push_back(new portable::Resource(portable::Resource::fuel));
-      }
+      output.insert(output.end(), trunk_production,
+                    portable::Resource(portable::Resource::fuel));
       m_production_current += trunk_production;
     }
   }
@@ -103,16 +100,13 @@ Coal_burner::produce(portable::Cache &input,
 bool Coal_burner::can_build(const portable::Cache &input,
                             const tile::Tile *tile)
 {
-  return ((input.count(portable::Resource::Type::boards) >= 3) &&
-          (nullptr != tile) &&
-          (tile::is_valid(tile->get_terrain())) &&
-          (tile::Terrain::sea != tile->get_terrain()) &&
-          (tile::Terrain::desert != tile->get_terrain()));
+  return building::can_build(Building::Type::coal_burner, input, tile);
 }
 
 common::Error Coal_burner::remove_construction_resources(portable::Cache &input)
 {
-  return input.remove(portable::Resource::Type::boards, 3);
+  return building::remove_construction_resources(
+      Building::Type::coal_burner, input);
 }
 
 std::string Coal_burner::to_string() const
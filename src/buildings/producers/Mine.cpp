@@ -4,6 +4,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <buildings/Recipes.h>
 #include <buildings/producers/Mine.h>
 #include <common/Errors.h>
 #include <players/Player.h>
@@ -67,7 +68,7 @@ bool Mine::can_produce(
 common::Error
 Mine::produce(portable::Cache &input,
               std::vector<portable::Transporter *> &nearby_transporters,
-              std::vector<portable::Portable *> &output)
+              std::vector<portable::Resource> &output)
 {
   if (!can_produce(input, nearby_transporters))
   {
@@ -79,10 +80,11 @@ Mine::produce(portable::Cache &input,
   to_produce = static_cast<uint8_t>(
       std::min((int)to_produce, (int)m_remaining_resources.size()));
 
+  output.reserve(output.size() + to_produce);
   for (uint8_t i = 0; i < to_produce; i++)
   {
     portable::Resource::Type next = m_remaining_resources.back();
-    output.push_back(new portable::Resource(next));
+    output.emplace_back(next);
     m_remaining_resources.pop_back();
   }
   m_production_current += to_produce;
@@ -94,20 +96,12 @@ Mine::produce(portable::Cache &input,
 
 bool Mine::can_build(const portable::Cache &input, const tile::Tile *tile)
 {
-  return ((input.count(portable::Resource::Type::boards) >= 3) &&
-          (input.count(portable::Resource::Type::stone) >= 1) &&
-          (nullptr != tile) &&
-          (tile::Terrain::mountain == tile->get_terrain()));
+  return building::can_build(Building::Type::mine, input, tile);
 }
 
 common::Error Mine::remove_construction_resources(portable::Cache &input)
 {
-  common::Error err = input.remove(portable::Resource::Type::stone);
-  if (!err)
-  {
-    err = input.remove(portable::Resource::Type::boards, 3);
-  }
-  return err;
+  return building::remove_construction_resources(Building::Type::mine, input);
 }
 
 uint8_t Mine::count(const portable::Resource::Type t) const
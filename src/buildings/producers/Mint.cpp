@@ -3,6 +3,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <buildings/Recipes.h>
 #include <buildings/producers/Mint.h>
 #include <common/Errors.h>
 #include <players/Player.h>
@@ -46,7 +47,7 @@ bool Mint::can_produce(
 common::Error
 Mint::produce(portable::Cache &input,
               std::vector<portable::Transporter *> &nearby_transporters,
-              std::vector<portable::Portable *> &output)
+              std::vector<portable::Resource> &output)
 {
   if (!can_produce(input, nearby_transporters))
   {
@@ -73,11 +74,8 @@ Mint::produce(portable::Cache &input,
 
   if (!err)
   {
-    for (uint8_t i = 0; i < to_produce; i++)
-    {
-      output.push_back(new portable::Resource(
-          portable::Resource::Type::coins));
-    }
+    output.insert(output.end(), to_produce,
+                  portable::Resource(portable::Resource::Type::coins));
 
     m_production_current += to_produce;
   }
@@ -89,22 +87,12 @@ Mint::produce(portable::Cache &input,
 
 bool Mint::can_build(const portable::Cache &input, const tile::Tile *tile)
 {
-  return ((input.count(portable::Resource::Type::boards) >= 2) &&
-          (input.count(portable::Resource::Type::stone) >= 1) &&
-          (nullptr != tile) &&
-          (tile::is_valid(tile->get_terrain())) &&
-          (tile::Terrain::sea != tile->get_terrain()) &&
-          (tile::Terrain::desert != tile->get_terrain()));
+  return building::can_build(Building::Type::mint, input, tile);
 }
 
 common::Error Mint::remove_construction_resources(portable::Cache &input)
 {
-  common::Error err = input.remove(portable::Resource::Type::stone);
-  if (!err)
-  {
-    err = input.remove(portable::Resource::Type::boards, 2);
-  }
-  return err;
+  return building::remove_construction_resources(Building::Type::mint, input);
 }
 
 std::string Mint::to_string() const
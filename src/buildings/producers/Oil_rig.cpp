@@ -2,6 +2,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <buildings/Recipes.h>
 #include <buildings/producers/Oil_rig.h>
 #include <common/Errors.h>
 #include <players/Player.h>
@@ -31,7 +32,7 @@ Oil_rig Oil_rig::operator=(const Oil_rig &other)
 common::Error
 Oil_rig::produce(portable::Cache &input,
                  std::vector<portable::Transporter *> &nearby_transporters,
-                 std::vector<portable::Portable *> &output)
+                 std::vector<portable::Resource> &output)
 {
   if (!can_produce(input, nearby_transporters))
   {
@@ -41,10 +42,8 @@ Oil_rig::produce(portable::Cache &input,
   uint8_t max = (m_is_powered ? m_production_max * 2 : m_production_max);
   uint8_t to_produce = max - m_production_current;
 
-  for (uint8_t i = 0; i < to_produce; i++)
-  {
-    output.push_back(new portable::Resource(portable::Resource::Type::fuel));
-  }
+  output.insert(output.end(), to_produce,
+                portable::Resource(portable::Resource::Type::fuel));
   m_production_current += to_produce;
 
   // TODO Ask each nearby transporter (in turn order) whether they'd like the
@@ -54,20 +53,13 @@ Oil_rig::produce(portable::Cache &input,
 
 bool Oil_rig::can_build(const portable::Cache &input, const tile::Tile *tile)
 {
-  return ((input.count(portable::Resource::Type::boards) >= 3) &&
-          (input.count(portable::Resource::Type::stone) >= 1) &&
-          (nullptr != tile) &&
-          (tile::Terrain::sea == tile->get_terrain()));
+  return building::can_build(Building::Type::oil_rig, input, tile);
 }
 
 common::Error Oil_rig::remove_construction_resources(portable::Cache &input)
 {
-  common::Error err = input.remove(portable::Resource::Type::stone);
-  if (!err)
-  {
-    err = input.remove(portable::Resource::Type::boards, 3);
-  }
-  return err;
+  return building::remove_construction_resources(
+      Building::Type::oil_rig, input);
 }
 
 std::string Oil_rig::to_string() const
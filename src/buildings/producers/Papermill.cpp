@@ -3,6 +3,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <buildings/Recipes.h>
 #include <buildings/producers/Papermill.h>
 #include <common/Errors.h>
 #include <players/Player.h>
@@ -46,7 +47,7 @@ bool Papermill::can_produce(
 common::Error
 Papermill::produce(portable::Cache &input,
                    std::vector<portable::Transporter *> &nearby_transporters,
-                   std::vector<portable::Portable *> &output)
+                   std::vector<portable::Resource> &output)
 {
   if (!can_produce(input, nearby_transporters))
   {
@@ -69,10 +70,8 @@ Papermill::produce(portable::Cache &input,
     err = input.remove(portable::Resource::Type::boards, board_production * 2);
     if (!err)
     {
-      for (uint8_t i = 0; i < board_production; i++)
-      {
-        output.push_back(new portable::Resource(portable::Resource::paper));
-      }
+      output.insert(output.end(), board_production,
+                    portable::Resource(portable::Resource::paper));
       m_production_current += board_production;
     }
   }
@@ -87,10 +86,8 @@ Papermill::produce(portable::Cache &input,
     err = input.remove(portable::Resource::Type::trunks, trunk_production * 2);
     if (!err)
     {
-      for (uint8_t i = 0; i < trunk_production; i++)
-      {
-        output.push_back(new portable::Resource(portable::Resource::paper));
-      }
+      output.insert(output.end(), trunk_production,
+                    portable::Resource(portable::Resource::paper));
       m_production_current += trunk_production;
     }
   }
@@ -102,22 +99,13 @@ Papermill::produce(portable::Cache &input,
 
 bool Papermill::can_build(const portable::Cache &input, const tile::Tile *tile)
 {
-  return ((input.count(portable::Resource::Type::boards) >= 1) &&
-          (input.count(portable::Resource::Type::stone) >= 1) &&
-          (nullptr != tile) &&
-          (tile::is_valid(tile->get_terrain())) &&
-          (tile::Terrain::sea != tile->get_terrain()) &&
-          (tile::Terrain::desert != tile->get_terrain()));
+  return building::can_build(Building::Type::papermill, input, tile);
 }
 
 common::Error Papermill::remove_construction_resources(portable::Cache &input)
 {
-  common::Error err = input.remove(portable::Resource::Type::boards);
-  if (!err)
-  {
-    input.remove(portable::Resource::Type::stone);
-  }
-  return err;
+  return building::remove_construction_resources(
+      Building::Type::papermill, input);
 }
 
 std::string Papermill::to_string() const
@@ -3,6 +3,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <buildings/Recipes.h>
 #include <buildings/producers/Quarry.h>
 #include <common/Errors.h>
 #include <players/Player.h>
@@ -32,7 +33,7 @@ Quarry Quarry::operator=(const Quarry &other)
 common::Error
 Quarry::produce(portable::Cache &input,
                 std::vector<portable::Transporter *> &nearby_transporters,
-                std::vector<portable::Portable *> &output)
+                std::vector<portable::Resource> &output)
 {
   if (!can_produce(input, nearby_transporters))
   {
@@ -41,10 +42,8 @@ Quarry::produce(portable::Cache &input,
 
   uint8_t max = (m_is_powered ? m_production_max * 2 : m_production_max);
   uint8_t to_produce = max - m_production_current;
-  for (uint8_t i = 0; i < to_produce; i++)
-  {
-    output.push_back(new portable::Resource(portable::Resource::Type::stone));
-  }
+  output.insert(output.end(), to_produce,
+                portable::Resource(portable::Resource::Type::stone));
   m_production_current += to_produce;
 
   // TODO Ask nearby transporters (in turn order) whether they'd like the
@@ -54,15 +53,12 @@ Quarry::produce(portable::Cache &input,
 
 bool Quarry::can_build(const portable::Cache &input, const tile::Tile *tile)
 {
-  return ((input.count(portable::Resource::Type::boards) >= 2) &&
-          (nullptr != tile) &&
-          (tile::is_valid(tile->get_terrain())) &&
-          (tile::Terrain::rock == tile->get_terrain()));
+  return building::can_build(Building::Type::quarry, input, tile);
 }
 
 common::Error Quarry::remove_construction_resources(portable::Cache &input)
 {
-  return input.remove(portable::Resource::Type::boards, 2);
+  return building::remove_construction_resources(Building::Type::quarry, input);
 }
 
 std::string Quarry::to_string() const
@@ -3,6 +3,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <buildings/Recipes.h>
 #include <buildings/producers/Sawmill.h>
 #include <common/Errors.h>
 #include <players/Player.h>
@@ -45,7 +46,7 @@ bool Sawmill::can_produce(
 common::Error
 Sawmill::produce(portable::Cache &input,
                  std::vector<portable::Transporter *> &nearby_transporters,
-                 std::vector<portable::Portable *> &output)
+                 std::vector<portable::Resource> &output)
 {
   if (!can_produce(input, nearby_transporters))
   {
@@ -63,11 +64,8 @@ Sawmill::produce(portable::Cache &input,
       input.remove(portable::Resource::Type::trunks, to_produce / 2);
   if (!err)
   {
-    for (uint8_t i = 0; i < to_produce; i++)
-    {
-      output.push_back(new portable::Resource(
-          portable::Resource::Type::boards));
-    }
+    output.insert(output.end(), to_produce,
+                  portable::Resource(portable::Resource::Type::boards));
     m_production_current += to_produce;
   }
 
@@ -78,22 +76,13 @@ Sawmill::produce(portable::Cache &input,
 
 bool Sawmill::can_build(const portable::Cache &input, const tile::Tile *tile)
 {
-  return ((input.count(portable::Resource::Type::boards) >= 2) &&
-          (input.count(portable::Resource::Type::stone) >= 1) &&
-          (nullptr != tile) &&
-          (tile::is_valid(tile->get_terrain())) &&
-          (tile::Terrain::sea != tile->get_terrain()) &&
-          (tile::Terrain::desert != tile->get_terrain()));
+  return building::can_build(Building::Type::sawmill, input, tile);
 }
 
 common::Error Sawmill::remove_construction_resources(portable::Cache &input)
 {
-  common::Error err = input.remove(portable::Resource::Type::boards, 2);
-  if (!err)
-  {
-    err = input.remove(portable::Resource::Type::stone, 1);
-  }
-  return err;
+  return building::remove_construction_resources(
+      Building::Type::sawmill, input);
 }
 
 std::string Sawmill::to_string() const
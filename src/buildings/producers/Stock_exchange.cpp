@@ -3,6 +3,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <buildings/Recipes.h>
 #include <buildings/producers/Stock_exchange.h>
 #include <common/Errors.h>
 #include <players/Player.h>
@@ -49,7 +50,7 @@ bool Stock_exchange::can_produce(
 common::Error Stock_exchange::produce(
     portable::Cache &input,
     std::vector<portable::Transporter *> &nearby_transporters,
-    std::vector<portable::Portable *> &output)
+    std::vector<portable::Resource> &output)
 {
   if (!can_produce(input, nearby_transporters))
   {
@@ -77,11 +78,8 @@ common::Error Stock_exchange::produce(
 
   if (!err)
   {
-    for (uint8_t i = 0; i < to_produce; i++)
-    {
-      output.push_back(new portable::Resource(
-          portable::Resource::Type::stock));
-    }
+    output.insert(output.end(), to_produce,
+                  portable::Resource(portable::Resource::Type::stock));
     m_production_current += to_produce;
   }
 
@@ -93,17 +91,14 @@ common::Error Stock_exchange::produce(
 bool Stock_exchange::can_build(const portable::Cache &input,
                                const tile::Tile *tile)
 {
-  return ((input.count(portable::Resource::Type::stone) >= 3) &&
-          (nullptr != tile) &&
-          (tile::is_valid(tile->get_terrain())) &&
-          (tile::Terrain::sea != tile->get_terrain()) &&
-          (tile::Terrain::desert != tile->get_terrain()));
+  return building::can_build(Building::Type::stock_exchange, input, tile);
 }
 
 common::Error
 Stock_exchange::remove_construction_resources(portable::Cache &input)
 {
-  return input.remove(portable::Resource::Type::stone, 3);
+  return building::remove_construction_resources(
+      Building::Type::stock_exchange, input);
 }
 
 std::string Stock_exchange::to_string() const
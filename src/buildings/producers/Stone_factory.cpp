@@ -3,6 +3,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <buildings/Recipes.h>
 #include <buildings/producers/Stone_factory.h>
 #include <common/Errors.h>
 #include <players/Player.h>
@@ -47,7 +48,7 @@ bool Stone_factory::can_produce(
 common::Error Stone_factory::produce(
     portable::Cache &input,
     std::vector<portable::Transporter *> &nearby_transporters,
-    std::vector<portable::Portable *> &output)
+    std::vector<portable::Resource> &output)
 {
   if (!can_produce(input, nearby_transporters))
   {
@@ -66,11 +67,8 @@ common::Error Stone_factory::produce(
 
   if (!err)
   {
-    for (uint8_t i = 0; i < to_produce; i++)
-    {
-      output.push_back(new portable::Resource(
-          portable::Resource::Type::stone));
-    }
+    output.insert(output.end(), to_produce,
+                  portable::Resource(portable::Resource::Type::stone));
     m_production_current += to_produce;
   }
 
@@ -82,17 +80,14 @@ common::Error Stone_factory::produce(
 bool Stone_factory::can_build(const portable::Cache &input,
                               const tile::Tile *tile)
 {
-  return ((input.count(portable::Resource::Type::boards) >= 2) &&
-          (nullptr != tile) &&
-          (tile::is_valid(tile->get_terrain())) &&
-          (tile::Terrain::sea != tile->get_terrain()) &&
-          (tile::Terrain::desert != tile->get_terrain()));
+  return building::can_build(Building::Type::stone_factory, input, tile);
 }
 
 common::Error
 Stone_factory::remove_construction_resources(portable::Cache &input)
 {
-  return input.remove(portable::Resource::Type::boards, 2);
+  return building::remove_construction_resources(
+      Building::Type::stone_factory, input);
 }
 
 std::string Stone_factory::to_string() const
@@ -2,6 +2,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include <buildings/Recipes.h>
 #include <buildings/producers/Woodcutter.h>
 #include <common/Errors.h>
 #include <players/Player.h>
@@ -34,7 +35,7 @@ Woodcutter Woodcutter::operator=(const Woodcutter &other)
 common::Error
 Woodcutter::produce(portable::Cache &input,
                     std::vector<portable::Transporter *> &nearby_transporters,
-                    std::vector<portable::Portable *> &output)
+                    std::vector<portable::Resource> &output)
 {
   if (!can_produce(input, nearby_transporters))
   {
@@ -43,10 +44,8 @@ Woodcutter::produce(portable::Cache &input,
 
   uint8_t max = (m_is_powered ? m_production_max * 2 : m_production_max);
   uint8_t to_produce = max - m_production_current;
-  for (uint8_t i = 0; i < to_produce; i++)
-  {
-    output.push_back(new portable::Resource(portable::Resource::Type::trunks));
-  }
+  output.insert(output.end(), to_produce,
+                portable::Resource(portable::Resource::Type::trunks));
   m_production_current += to_produce;
 
   // TODO Ask each nearby transporter (in turn order) whether they'd like the
@@ -56,14 +55,13 @@ Woodcutter::produce(portable::Cache &input,
 
 bool Woodcutter::can_build(const portable::Cache &input, const tile::Tile *tile)
 {
-  return ((input.count(portable::Resource::Type::boards) >= 1) &&
-          (nullptr != tile) &&
-          (tile::Terrain::forest == tile->get_terrain()));
+  return building::can_build(Building::Type::woodcutter, input, tile);
 }
 
 common::Error Woodcutter::remove_construction_resources(portable::Cache &input)
 {
-  return input.remove(portable::Resource::Type::boards, 1);
+  return building::remove_construction_resources(
+      Building::Type::woodcutter, input);
 }
 
 std::string Woodcutter::to_string() const
@@ -47,10 +47,10 @@ static common::Error make_building(const Building::Type to_build,
       result = std::make_unique<Oil_rig>(*(static_cast<Oil_rig *>(to_copy)));
     }
     else
-      err = common::ERR_NONE;
     {
       result = std::make_unique<Oil_rig>();
     }
+    err = common::ERR_NONE;
     break;
   case building::Building::Type::quarry:
     if (nullptr != to_copy)
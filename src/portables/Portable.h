@@ -1,6 +1,7 @@
 #ifndef PORTABLE_H
 #define PORTABLE_H
 
+#include <cstdint>
 #include <set>
 
 #include <nlohmann/json.hpp>
@@ -10,6 +11,10 @@
 
 namespace portable
 {
+/// Base of anything players can carry around. Keeps track of which players
+/// have carried it this phase, as a mask with bit c set for player::Color c.
+/// There's nothing virtual about it, so whatever derives from it can stay a
+/// plain, trivially copyable value.
 class Portable
 {
 public:
@@ -39,78 +44,93 @@ public:
                                         {resource, "resource"},
                                         {transporter, "transporter"}});
 
-  Portable(std::set<player::Color> carriers, Object obj)
-      : m_carriers(carriers), m_object(obj)
+  /// Returns the carrier mask bit of the input player. The neutral color, and
+  /// invalid ones, have none.
+  /// @param[in] player
+  /// @return The player's bit. 0 if the player can't be a carrier.
+  static constexpr uint8_t carrier_bit(const player::Color player)
   {
-    if (m_carriers.contains(player::Color::neutral))
-    {
-      m_carriers.erase(player::Color::neutral);
-    }
-    if (m_carriers.contains(player::Color::invalid))
+    return ((0 <= player) && (player::MAX_PLAYER_COLORS > player))
+               ? static_cast<uint8_t>(1 << player)
+               : 0;
+  }
+
+  constexpr Portable() = default;
+  Portable(const std::set<player::Color> &carriers)
+  {
+    // Neutral and invalid colors have no bit, so they drop out here.
+    for (player::Color clr : carriers)
     {
-      m_carriers.erase(player::Color::invalid);
+      m_carriers |= carrier_bit(clr);
     }
   }
-  Portable(Object obj) : m_object(obj) {}
-  virtual ~Portable() {}
 
-  virtual void reset() { m_carriers.clear(); }
+  inline void reset() { m_carriers = 0; }
 
-  virtual bool can_add_carrier(const player::Color player) const
+  inline bool can_add_carrier(const player::Color player) const
   {
-    return ((player::is_valid(player)) && (!m_carriers.contains(player)));
+    return ((player::is_valid(player)) && (!was_carried_by(player)));
   };
 
-  virtual common::Error add_carrier(const player::Color player)
+  inline common::Error add_carrier(const player::Color player)
   {
     if (!player::is_valid(player))
     {
       return common::ERR_INVALID;
     }
-    if (m_carriers.contains(player))
+    if (was_carried_by(player))
     {
       return common::ERR_FAIL;
     }
 
-    if (player != player::Color::neutral)
-    {
-      m_carriers.insert(player);
-    }
+    m_carriers |= carrier_bit(player);
     return common::ERR_NONE;
   };
 
-  virtual common::Error remove_carrier(const player::Color player)
+  inline common::Error remove_carrier(const player::Color player)
   {
     if (!player::is_valid(player))
     {
       return common::ERR_INVALID;
     }
-    if (!m_carriers.contains(player))
+    if (!was_carried_by(player))
     {
       return common::ERR_FAIL;
     }
 
-    m_carriers.erase(player);
+    m_carriers &= static_cast<uint8_t>(~carrier_bit(player));
     return common::ERR_NONE;
   };
 
-  inline bool was_carried() const { return (0 < m_carriers.size()); }
+  inline bool was_carried() const { return (0 != m_carriers); }
 
   inline bool was_carried_by(player::Color player) const
   {
-    return m_carriers.contains(player);
+    return (0 != (m_carriers & carrier_bit(player)));
   }
 
-  inline Object get_object() const { return m_object; }
+  /// Returns the carrier mask, with bit c set for each player::Color c that
+  /// carried it this phase.
+  inline uint8_t get_carrier_bits() const { return m_carriers; }
 
-  inline std::set<player::Color> get_carriers() const { return m_carriers; }
+  std::set<player::Color> get_carriers() const
+  {
+    std::set<player::Color> retval;
+    for (uint8_t c = 0; c < player::MAX_PLAYER_COLORS; c++)
+    {
+      if (m_carriers & (1 << c))
+      {
+        retval.insert(static_cast<player::Color>(c));
+      }
+    }
+    return retval;
+  }
 
 protected:
-  std::set<player::Color> m_carriers;
-  Object m_object;
+  uint8_t m_carriers = 0;
 
 private:
 };
 } // namespace portable
 
-#endif
\ No newline at end of file
+#endif
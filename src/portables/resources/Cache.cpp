@@ -1,7 +1,8 @@
 #include <algorithm>
+#include <bit>
 #include <iterator>
-#include <map>
 #include <ostream>
+#include <utility>
 
 #include <nlohmann/json.hpp>
 
@@ -12,465 +13,408 @@
 
 namespace portable
 {
+Cache::Cache()
+    : m_piles(), m_pile_count(0), m_piled(0), m_phase(0), m_p_clock(nullptr)
+{
+  clear();
+}
+
+bool Cache::operator==(Cache const &other) const
+{
+  return m_totals == other.m_totals;
+}
 
-Cache::Cache() {}
+bool Cache::operator!=(Cache const &other) const { return !(*this == other); }
 
-Cache::Cache(const Cache &other)
+Cache Cache::operator+(const Cache &other) const
 {
-  for (uint8_t r = 0; r < RESOURCE_NAMES_SIZE; r++)
-  {
-    Resource::Type key = static_cast<Resource::Type>(r);
-    if (other.m_resources.find(key) != other.m_resources.end())
-    {
-      std::vector<std::unique_ptr<Resource>> res_list;
-      m_resources.insert({key, std::move(res_list)});
-      for (size_t i = 0; i < other.m_resources.at(key).size(); i++)
-      {
-        if (nullptr != other.m_resources.at(key).at(i))
-        {
-          m_resources.at(key).push_back(std::make_unique<Resource>(
-              *(other.m_resources.at(key).at(i).get())));
-        }
-      }
-    }
-  }
+  Cache retval(*this);
+  retval += other;
+  return retval;
 }
 
-Cache::~Cache() { clear(); }
+Cache Cache::operator+(const std::vector<Resource> &res_list) const
+{
+  Cache merged(*this);
+  merged += res_list;
+  return merged;
+}
 
-bool Cache::operator==(Cache &other)
+void Cache::operator+=(Cache const &other)
 {
-  for (uint8_t r = 0; r < RESOURCE_NAMES_SIZE; r++)
+  if (&other == this)
   {
-    Resource::Type key = static_cast<Resource::Type>(r);
-    if ((m_resources.find(key) != m_resources.end()) !=
-        (other.m_resources.find(key) != other.m_resources.end()))
-    {
-      return false;
-    }
-    if ((m_resources.find(key) != m_resources.end()) &&
-        (m_resources.at(key).size() != other.m_resources.at(key).size()))
-    {
-      return false;
-    }
+    (*this) += Cache(other);
+    return;
+  }
+  refresh();
+  for (size_t r = 0; r < RESOURCE_TYPES; r++)
+  {
+    m_totals[r] += other.m_totals[r];
+  }
+  // Carriers from an earlier phase no longer count, so then everything lands
+  // in the neutral pile.
+  if (other.stale())
+  {
+    return;
+  }
+  for (size_t i = 0; i < other.m_pile_count; i++)
+  {
+    const Pile &pile = other.m_piles[i];
+    add_pile(pile.type, pile.carriers, pile.amount);
   }
-
-  return true;
 }
 
-bool Cache::operator==(Cache const &other) const
+void Cache::operator+=(std::vector<Resource> const &res_list)
 {
-  for (uint8_t r = 0; r < RESOURCE_NAMES_SIZE; r++)
+  for (const Resource &res : res_list)
   {
-    Resource::Type key = static_cast<Resource::Type>(r);
-    if ((m_resources.find(key) != m_resources.end()) !=
-        (other.m_resources.find(key) != other.m_resources.end()))
-    {
-      return false;
-    }
-    if ((m_resources.find(key) != m_resources.end()) &&
-        (m_resources.at(key).size() != other.m_resources.at(key).size()))
+    if (Resource::is_valid(res.get_type()))
     {
-      return false;
+      put(res.get_type(), res.get_carrier_bits());
     }
   }
+}
 
-  return true;
+void Cache::clear()
+{
+  m_totals.fill(0);
+  m_pile_count = 0;
+  m_piled = 0;
+  m_phase = phase();
 }
 
-bool Cache::operator!=(Cache &other) { return !(*this == other); }
-bool Cache::operator!=(Cache const &other) const { return !(*this == other); }
+void Cache::reset()
+{
+  m_pile_count = 0;
+  m_piled = 0;
+  m_phase = phase();
+}
 
-Cache Cache::operator=(const Cache &other)
+void Cache::set_clock(const Phase_clock *clock)
 {
-  clear();
-  for (uint8_t r = 0; r < RESOURCE_NAMES_SIZE; r++)
+  refresh();
+  m_p_clock = clock;
+  m_phase = phase();
+}
+
+uint16_t Cache::count(const Resource::Type res) const
+{
+  return Resource::is_valid(res) ? m_totals[res] : 0;
+}
+
+uint16_t Cache::count_moveable(const Resource::Type res,
+                               const player::Color player) const
+{
+  if ((!Resource::is_valid(res)) || (!player::is_valid(player)))
+  {
+    return 0;
+  }
+  if ((player::Color::neutral == player) || (0 == (m_piled & (1u << res))) ||
+      stale())
   {
-    Resource::Type key = static_cast<Resource::Type>(r);
-    if (other.m_resources.find(key) != other.m_resources.end())
+    return m_totals[res];
+  }
+  uint16_t carried = 0;
+  const uint8_t bit = Portable::carrier_bit(player);
+  // There are few enough piles that a straight scan beats a binary search.
+  for (size_t i = 0; (i < m_pile_count) && (m_piles[i].type <= res); i++)
+  {
+    if ((res == m_piles[i].type) && (0 != (m_piles[i].carriers & bit)))
     {
-      std::vector<std::unique_ptr<Resource>> res_list;
-      for (size_t i = 0; i < other.m_resources.at(key).size(); i++)
-      {
-        Resource *r_ptr = other.m_resources.at(key).at(i).get();
-        res_list.push_back(std::make_unique<Resource>(*r_ptr));
-      }
-      m_resources.insert({key, std::move(res_list)});
+      carried += m_piles[i].amount;
     }
   }
-  return (*this);
+  return m_totals[res] - carried;
 }
 
-Cache Cache::operator+(const Cache &other)
+std::vector<Resource> Cache::all() const
 {
-  Cache retval;
-  for (size_t i = 0; i < portable::RESOURCE_NAMES_SIZE; i++)
+  std::vector<Resource> result;
+  result.reserve(size());
+  for (Resource res : view())
   {
-    portable::Resource::Type key = static_cast<portable::Resource::Type>(i);
-    std::vector<std::unique_ptr<portable::Resource>> r_list;
-    if (other.m_resources.find(key) != other.m_resources.end())
-    {
-      for (const auto &res : other.m_resources.at(key))
-      {
-        if (nullptr != res)
-        {
-          r_list.push_back(std::make_unique<portable::Resource>(*res.get()));
-        }
-      }
-    }
-    if (m_resources.find(key) != other.m_resources.end())
-    {
-      for (const auto &res : m_resources.at(key))
-      {
-        if (nullptr != res)
-        {
-          r_list.push_back(std::make_unique<portable::Resource>(*res.get()));
-        }
-      }
-    }
-
-    if (!r_list.empty())
-    {
-      retval.m_resources.insert({key, std::move(r_list)});
-    }
+    result.push_back(res);
   }
-
-  return retval;
+  return result;
 }
 
-Cache Cache::operator+(const Cache &other) const
+std::vector<Resource> Cache::all_moveable(const player::Color p) const
 {
-  Cache retval;
-  for (size_t i = 0; i < portable::RESOURCE_NAMES_SIZE; i++)
+  std::vector<Resource> result;
+  if (!player::is_valid(p))
   {
-    portable::Resource::Type key = static_cast<portable::Resource::Type>(i);
-    std::vector<std::unique_ptr<portable::Resource>> r_list;
-    if (other.m_resources.find(key) != other.m_resources.end())
+    return result;
+  }
+  if (stale())
+  {
+    return all();
+  }
+  const uint8_t skip = Portable::carrier_bit(p);
+  for (size_t r = 0; r < RESOURCE_TYPES; r++)
+  {
+    if (0 == m_totals[r])
     {
-      for (const auto &res : other.m_resources.at(key))
-      {
-        if (nullptr != res)
-        {
-          r_list.push_back(std::make_unique<portable::Resource>(*res.get()));
-        }
-      }
+      continue;
     }
-    if (m_resources.find(key) != other.m_resources.end())
+    const Resource::Type t = static_cast<Resource::Type>(r);
+    result.insert(result.end(), neutral(r, false), Resource(t));
+    for (size_t i = first_pile(r);
+         (i < m_pile_count) && (r == m_piles[i].type); i++)
     {
-      for (const auto &res : m_resources.at(key))
+      if (0 == (m_piles[i].carriers & skip))
       {
-        if (nullptr != res)
-        {
-          r_list.push_back(std::make_unique<portable::Resource>(*res.get()));
-        }
+        result.insert(result.end(), m_piles[i].amount,
+                      Resource::from_bits(t, m_piles[i].carriers));
       }
     }
-
-    if (!r_list.empty())
-    {
-      retval.m_resources.insert({key, std::move(r_list)});
-    }
   }
+  return result;
+}
 
-  return retval;
+common::Error Cache::add(const Resource &res)
+{
+  if (!Resource::is_valid(res.get_type()))
+  {
+    return common::ERR_INVALID;
+  }
+  put(res.get_type(), res.get_carrier_bits());
+  return common::ERR_NONE;
 }
 
-Cache Cache::operator+(const std::vector<Resource *> &res_list)
+common::Error Cache::add(const Resource::Type res)
 {
-  Cache merged = Cache(*this);
-  for (auto r_ptr : res_list)
+  if (!Resource::is_valid(res))
   {
-    if (nullptr == r_ptr)
-    {
-      continue;
-    }
-    Resource::Type key = r_ptr->get_type();
-    if (merged.m_resources.find(key) == m_resources.end())
-    {
-      std::vector<std::unique_ptr<portable::Resource>> r_list;
-      merged.m_resources.insert({key, std::move(r_list)});
-    }
-    merged.m_resources.at(key).push_back(
-        std::make_unique<portable::Resource>(*r_ptr));
+    return common::ERR_INVALID;
   }
-  return merged;
+  put(res, 0);
+  return common::ERR_NONE;
 }
 
-Cache Cache::operator+(const std::vector<Resource *> &res_list) const
+common::Error Cache::add(const std::vector<Resource> &res_list)
 {
-  Cache merged = Cache(*this);
-  for (auto r_ptr : res_list)
+  // Validate resources list before we add any
+  for (const Resource &res : res_list)
   {
-    if (nullptr == r_ptr)
-    {
-      continue;
-    }
-    Resource::Type key = r_ptr->get_type();
-    if (merged.m_resources.find(key) == m_resources.end())
+    if (!Resource::is_valid(res.get_type()))
     {
-      std::vector<std::unique_ptr<Resource>> r_list;
-      merged.m_resources.insert({key, std::move(r_list)});
+      return common::ERR_INVALID;
     }
-    merged.m_resources.at(key).push_back(std::make_unique<Resource>(*r_ptr));
   }
-  return merged;
+
+  (*this) += res_list;
+  return common::ERR_NONE;
 }
 
-void Cache::operator+=(Cache const &other)
+uint16_t Cache::take(const Resource::Type t, const uint16_t amount,
+                     const uint8_t skip, std::vector<Resource> *taken,
+                     Cache *into)
 {
-  for (size_t i = 0; i < RESOURCE_NAMES_SIZE; i++)
+  refresh();
+  uint16_t remaining = amount;
+  // Resources moved by the most players are the least useful to keep around,
+  // so those go first, and the neutral pile goes last.
+  const size_t first = first_pile(t);
+  size_t last = first;
+  while ((last < m_pile_count) && (t == m_piles[last].type))
+  {
+    last++;
+  }
+  for (size_t i = last; (i-- > first) && (0 < remaining);)
   {
-    Resource::Type key = static_cast<Resource::Type>(i);
-    if (other.m_resources.find(key) == other.m_resources.end())
+    const uint8_t carriers = m_piles[i].carriers;
+    if (0 != (carriers & skip))
     {
       continue;
     }
-    if (m_resources.find(key) == m_resources.end())
+    uint16_t n = std::min(remaining, m_piles[i].amount);
+    m_piles[i].amount -= n;
+    if (0 == m_piles[i].amount)
     {
-      std::vector<std::unique_ptr<Resource>> r_list;
-      m_resources.insert({key, std::move(r_list)});
+      erase_pile(i);
     }
-
-    for (const auto &r_ptr : other.m_resources.at(key))
+    remaining -= n;
+    if (nullptr != taken)
     {
-      if (nullptr != r_ptr)
-      {
-        m_resources.at(key).push_back(std::make_unique<Resource>(*r_ptr));
-      }
+      taken->insert(taken->end(), n, Resource::from_bits(t, carriers));
+    }
+    if (nullptr != into)
+    {
+      into->put(t, carriers, n);
     }
   }
-}
-
-void Cache::operator+=(std::vector<Resource *> const &res_list)
-{
-  for (auto r_ptr : res_list)
+  m_totals[t] -= (amount - remaining);
+  if (0 < remaining)
   {
-    if (nullptr == r_ptr)
+    uint16_t n = std::min(remaining, neutral(t, false));
+    m_totals[t] -= n;
+    remaining -= n;
+    if (nullptr != taken)
     {
-      continue;
+      taken->insert(taken->end(), n, Resource(t));
     }
-    Resource::Type key = r_ptr->get_type();
-    if (m_resources.find(key) == m_resources.end())
+    if (nullptr != into)
     {
-      std::vector<std::unique_ptr<Resource>> r_list;
-      m_resources.insert({key, std::move(r_list)});
+      into->put(t, 0, n);
     }
-    m_resources.at(key).push_back(std::make_unique<Resource>(*r_ptr));
   }
+  return amount - remaining;
 }
 
-void Cache::clear() { m_resources.clear(); }
-
-void Cache::reset()
+void Cache::put(const Resource::Type t, const uint8_t carriers,
+                const uint16_t amount)
 {
-  for (uint8_t r = 0; r < RESOURCE_NAMES_SIZE; r++)
+  refresh();
+  m_totals[t] += amount;
+  if (0 != carriers)
   {
-    Resource::Type key = static_cast<Resource::Type>(r);
-    if (m_resources.find(key) != m_resources.end())
-    {
-      for (size_t i = 0; i < m_resources.at(key).size(); i++)
-      {
-        if (nullptr == m_resources.at(key).at(i))
-        {
-          continue;
-        }
-        m_resources.at(key).at(i)->reset();
-      }
-    }
+    add_pile(t, carriers, amount);
   }
-
-  clean();
 }
 
-void Cache::clean()
+void Cache::add_pile(const size_t t, const uint8_t carriers,
+                     const uint16_t amount)
 {
-  for (uint8_t r = 0; r < RESOURCE_NAMES_SIZE; r++)
+  auto before = [](const Pile &a, const Pile &b)
   {
-    Resource::Type key = static_cast<Resource::Type>(r);
-    if (m_resources.find(key) == m_resources.end())
-    {
-      continue;
-    }
+    return (a.type < b.type) ||
+           ((a.type == b.type) && (a.carriers < b.carriers));
+  };
+  const Pile pile{static_cast<uint8_t>(t), carriers, amount};
+  Pile *end = m_piles.data() + m_pile_count;
+  Pile *it = std::lower_bound(m_piles.data(), end, pile, before);
+  if ((it != end) && (t == it->type) && (carriers == it->carriers))
+  {
+    it->amount += amount;
+    return;
+  }
 
-    for (auto i = m_resources.at(key).end() - 1;
-         i >= m_resources.at(key).begin(); --i)
+  if (MAX_PILES == m_pile_count)
+  {
+    // Out of room; the pile moved by the fewest players forgets its carriers,
+    // which may well be the new one.
+    auto weaker = [](const Pile &a, const Pile &b)
     {
-      if (nullptr == *i)
-      {
-        m_resources.at(key).erase(i);
-      }
-    }
-
-    if (m_resources.at(key).empty())
+      const int a_count = std::popcount(a.carriers);
+      const int b_count = std::popcount(b.carriers);
+      return (a_count < b_count) ||
+             ((a_count == b_count) && (a.amount < b.amount));
+    };
+    Pile *weakest = std::min_element(m_piles.data(), end, weaker);
+    if (!weaker(*weakest, pile))
     {
-      m_resources.erase(key);
+      return;
     }
+    erase_pile(weakest - m_piles.data());
+    end = m_piles.data() + m_pile_count;
+    it = std::lower_bound(m_piles.data(), end, pile, before);
   }
+  std::copy_backward(it, end, end + 1);
+  *it = pile;
+  m_pile_count++;
+  m_piled |= (1u << t);
 }
 
-uint16_t Cache::count(const Resource::Type res) const
+void Cache::erase_pile(const size_t i)
 {
-  uint16_t total = 0;
-  if ((Resource::is_valid(res)) && (m_resources.find(res) != m_resources.end()))
+  const uint8_t t = m_piles[i].type;
+  std::copy(m_piles.begin() + i + 1, m_piles.begin() + m_pile_count,
+            m_piles.begin() + i);
+  m_pile_count--;
+  if (((0 == i) || (t != m_piles[i - 1].type)) &&
+      ((i == m_pile_count) || (t != m_piles[i].type)))
   {
-    total = static_cast<uint16_t>(m_resources.at(res).size());
+    m_piled &= ~(1u << t);
   }
-  return total;
 }
 
-uint16_t Cache::count_moveable(const Resource::Type res,
-                               const player::Color player) const
+size_t Cache::first_pile(const size_t t) const
 {
-  uint16_t total = 0;
-  if ((Resource::is_valid(res)) && (player::is_valid(player)) &&
-      (m_resources.find(res) != m_resources.end()))
-  {
-    if (player::Color::neutral == player)
-    {
-      total = static_cast<uint16_t>(m_resources.at(res).size());
-    }
-    else
-    {
-      for (size_t i = 0; i < m_resources.at(res).size(); i++)
-      {
-        total +=
-            (!m_resources.at(res).at(i).get()->was_carried_by(player) ? 1 : 0);
-      }
-    }
-  }
-  return total;
+  return std::lower_bound(m_piles.begin(), m_piles.begin() + m_pile_count, t,
+                          [](const Pile &pile, const size_t type)
+                          { return pile.type < type; }) -
+         m_piles.begin();
 }
 
-std::vector<Resource *> Cache::all() const
+uint16_t Cache::neutral(const size_t t, const bool stale) const
 {
-  std::vector<Resource *> result;
-  for (uint8_t r = 0; r < portable::RESOURCE_NAMES_SIZE; r++)
+  uint16_t amount = m_totals[t];
+  if (stale)
   {
-    portable::Resource::Type res_type =
-        static_cast<portable::Resource::Type>(r);
-    if (m_resources.find(res_type) != m_resources.end())
-    {
-      for (uint8_t i = 0; i < m_resources.at(res_type).size(); i++)
-      {
-        result.push_back(m_resources.at(res_type).at(i).get());
-      }
-    }
+    return amount;
   }
-  return result;
+  for (size_t i = first_pile(t); (i < m_pile_count) && (t == m_piles[i].type);
+       i++)
+  {
+    amount -= m_piles[i].amount;
+  }
+  return amount;
 }
 
-std::vector<Resource *> Cache::all_moveable(const player::Color p) const
+void Cache::merge_from(Cache &&other)
 {
-  std::vector<Resource *> result;
-  for (uint8_t r = 0; r < RESOURCE_NAMES_SIZE; r++)
+  if (&other == this)
   {
-    Resource::Type key = static_cast<Resource::Type>(r);
-    if (m_resources.find(key) == m_resources.end())
-    {
-      continue;
-    }
-    for (uint8_t i = 0; i < m_resources.at(key).size(); i++)
-    {
-      if (!m_resources.at(key).at(i)->was_carried_by(p))
-      {
-        result.push_back(m_resources.at(key).at(i).get());
-      }
-    }
+    return;
   }
-  return result;
+  (*this) += other;
+  other.clear();
 }
 
-common::Error Cache::add(Resource *&res)
+common::Error Cache::splice(const Resource::Type res, const uint16_t amount,
+                            Cache &other)
 {
-  if ((nullptr == res) || (!Resource::is_valid(res->get_type())))
+  if ((!Resource::is_valid(res)) || (&other == this))
   {
     return common::ERR_INVALID;
   }
-
-  if (m_resources.find(res->get_type()) != m_resources.end())
+  if (other.count(res) < amount)
   {
-    m_resources.at(res->get_type()).push_back(std::make_unique<Resource>(*res));
-  }
-  else
-  {
-    std::vector<std::unique_ptr<Resource>> r_list;
-    r_list.push_back(std::make_unique<Resource>(*res));
-    m_resources.insert({res->get_type(), std::move(r_list)});
+    return common::ERR_FAIL;
   }
+
+  other.take(res, amount, 0, nullptr, this);
   return common::ERR_NONE;
 }
 
-common::Error Cache::add(const Resource::Type res)
+common::Error Cache::remove(const Resource::Type res, const uint16_t amount)
 {
   if (!Resource::is_valid(res))
   {
     return common::ERR_INVALID;
   }
-
-  if (m_resources.find(res) != m_resources.end())
-  {
-    m_resources.at(res).push_back(std::make_unique<Resource>(res));
-  }
-  else
+  if (count(res) < amount)
   {
-    std::vector<std::unique_ptr<Resource>> r_list;
-    r_list.push_back(std::make_unique<Resource>(res));
-    m_resources.insert({res, std::move(r_list)});
+    return common::ERR_FAIL;
   }
+
+  take(res, amount, 0, nullptr);
   return common::ERR_NONE;
 }
 
-common::Error Cache::add(std::vector<Resource *> &res_list)
+common::Error Cache::remove(const Counts &amounts)
 {
-  // Validate resources list before we add any
-  for (size_t i = 0; i < res_list.size(); i++)
+  for (size_t r = 0; r < RESOURCE_TYPES; r++)
   {
-    if ((nullptr == res_list.at(i)) ||
-        (!Resource::is_valid(res_list.at(i)->get_type())))
+    if (m_totals[r] < amounts[r])
     {
-      return common::ERR_INVALID;
+      return common::ERR_FAIL;
     }
   }
 
-  for (size_t i = 0; i < res_list.size(); i++)
+  for (size_t r = 0; r < RESOURCE_TYPES; r++)
   {
-    Resource::Type res_type = res_list.at(i)->get_type();
-    if (m_resources.find(res_type) != m_resources.end())
+    if (0 != amounts[r])
     {
-      m_resources.at(res_type).push_back(
-          std::make_unique<Resource>(*(res_list.at(i))));
-    }
-    else
-    {
-      std::vector<std::unique_ptr<Resource>> new_list;
-      new_list.push_back(std::make_unique<Resource>(*(res_list.at(i))));
-      m_resources.insert({res_type, std::move(new_list)});
+      take(static_cast<Resource::Type>(r), amounts[r], 0, nullptr);
     }
   }
   return common::ERR_NONE;
 }
 
-common::Error Cache::add(std::vector<Portable *> &res_list)
-{
-  std::vector<Resource *> res_to_add;
-  common::Error err = common::ERR_FAIL;
-  // Convert all resource pointers from input to something usable.
-  for (size_t i = 0; i < res_list.size(); i++)
-  {
-    if (res_list.at(i)->get_object() == Portable::Object::resource)
-    {
-      res_to_add.push_back(static_cast<Resource *>(res_list.at(i)));
-    }
-  }
-
-  if (res_to_add.size() > 0)
-  {
-    err = add(res_to_add);
-  }
-  return err;
-}
-
-common::Error Cache::remove(const Resource::Type res, const uint16_t amount)
+common::Error Cache::get(const Resource::Type res,
+                         std::vector<Resource> &result, const uint16_t amount)
 {
   if (!Resource::is_valid(res))
   {
@@ -481,104 +425,36 @@ common::Error Cache::remove(const Resource::Type res, const uint16_t amount)
     return common::ERR_FAIL;
   }
 
-  m_resources.at(res).erase(m_resources.at(res).end() - amount,
-                            m_resources.at(res).end());
-
+  result.reserve(result.size() + amount);
+  take(res, amount, 0, &result);
   return common::ERR_NONE;
 }
 
-common::Error Cache::get(const Resource::Type res,
-                         std::vector<std::unique_ptr<Resource>> &result,
-                         const uint16_t amount)
-{
-  common::Error err = common::ERR_NONE;
-  if (!Resource::is_valid(res))
-  {
-    err = common::ERR_INVALID;
-  }
-  else if (count(res) < amount)
-  {
-    err = common::ERR_FAIL;
-  }
-
-  if ((common::ERR_NONE == err) && (0 != amount))
-  {
-    for (uint16_t i = 0; i < amount; i++)
-    {
-      size_t idx = m_resources.at(res).size() - i;
-      result.push_back(std::move(m_resources.at(res).at(idx)));
-    }
-    m_resources.at(res).erase(m_resources.at(res).end() - amount,
-                              m_resources.at(res).end());
-  }
-
-  return err;
-}
-
 common::Error Cache::get(const Resource::Type res, const player::Color clr,
-                         std::vector<std::unique_ptr<Resource>> &result,
+                         std::vector<Resource> &result,
                          const uint16_t amount)
 {
-  common::Error err = common::ERR_NONE;
   if ((!Resource::is_valid(res)) || (!player::is_valid(clr)))
   {
-    err = common::ERR_INVALID;
-  }
-  else if (count_moveable(res, clr) < amount)
-  {
-    err = common::ERR_FAIL;
+    return common::ERR_INVALID;
   }
-
-  if ((common::ERR_NONE == err) && (0 != amount))
+  if (count_moveable(res, clr) < amount)
   {
-    std::vector<std::unique_ptr<Resource>> unmoved;
-    std::vector<std::unique_ptr<Resource>> to_remove;
-    size_t pre_move = m_resources.at(res).size();
-    size_t idx = 0;
-    while ((idx != m_resources.at(res).size()) && (to_remove.size() < amount))
-    {
-      if (m_resources.at(res).at(idx)->was_carried_by(clr))
-      {
-        unmoved.push_back(std::move(m_resources.at(res).at(idx)));
-      }
-      else
-      {
-        to_remove.push_back(std::move(m_resources.at(res).at(idx)));
-      }
-      idx++;
-    }
-
-    if ((!err) && (to_remove.size() != amount))
-    {
-      // We somehow didn't remove enough resources, despite checking first.
-      err = common::ERR_FAIL;
-    }
-    else if (!err)
-    {
-      m_resources.at(res) = std::move(unmoved);
-      // m_resources.erase(res);
-      // m_resources.insert({res, std::move(unmoved)});
-      // for (size_t i = 0; i < to_remove.size(); i++)
-      // {
-      //   result.push_back(std::move(to_remove.at(i)));
-      // }
-      result = std::move(to_remove);
-    }
+    return common::ERR_FAIL;
   }
 
-  return err;
+  result.clear();
+  result.reserve(amount);
+  take(res, amount, Portable::carrier_bit(clr), &result);
+  return common::ERR_NONE;
 }
 
 uint32_t Cache::size() const
 {
   uint32_t total = 0;
-  for (uint8_t r = 0; r < RESOURCE_NAMES_SIZE; r++)
+  for (uint16_t amount : m_totals)
   {
-    Resource::Type key = static_cast<Resource::Type>(r);
-    if (m_resources.find(key) != m_resources.end())
-    {
-      total += static_cast<uint32_t>(m_resources.at(key).size());
-    }
+    total += amount;
   }
   return total;
 }
@@ -591,23 +467,11 @@ std::ostream &operator<<(std::ostream &os, Cache const &res_cache)
 
 void to_json(nlohmann::json &j, const Cache &res_cache)
 {
-  for (size_t r = 0; r < RESOURCE_NAMES_SIZE; r++)
+  for (const Resource res : res_cache.view())
   {
-    Resource::Type key = static_cast<Resource::Type>(r);
-    if (res_cache.m_resources.find(key) != res_cache.m_resources.end())
-    {
-      std::string res_key = Resource::to_string(key);
-      for (size_t i = 0; i < res_cache.m_resources.at(key).size(); i++)
-      {
-        if (nullptr != res_cache.m_resources.at(key).at(i))
-        {
-          Resource res = *(res_cache.m_resources.at(key).at(i));
-          nlohmann::json res_json;
-          to_json(res_json, res);
-          j[res_key].push_back(res_json);
-        }
-      }
-    }
+    nlohmann::json res_json;
+    to_json(res_json, res);
+    j[Resource::to_string(res.get_type())].push_back(res_json);
   }
 }
 
@@ -624,7 +488,6 @@ void from_json(const nlohmann::json &j, Cache &res_cache)
     }
 
     std::vector<Resource> res_json_list = value.get<std::vector<Resource>>();
-    std::vector<std::unique_ptr<Resource>> res_list;
     for (auto resource : res_json_list)
     {
       if (t != resource.get_type())
@@ -634,9 +497,8 @@ void from_json(const nlohmann::json &j, Cache &res_cache)
             << " list: " << Resource::to_string(resource.get_type());
         throw nlohmann::json::type_error::create(501, msg.str(), j);
       }
-      res_list.push_back(std::make_unique<Resource>(resource));
+      res_cache.put(t, resource.get_carrier_bits());
     }
-    res_cache.m_resources.insert({t, std::move(res_list)});
   }
 }
-} // namespace portable
\ No newline at end of file
+} // namespace portable
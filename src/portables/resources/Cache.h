@@ -1,8 +1,14 @@
 #ifndef CACHE_H
 #define CACHE_H
 
-#include <map>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <ostream>
+#include <type_traits>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
@@ -13,19 +19,55 @@
 namespace portable
 {
 
+/// Movement phase counter for one game. Every cache attached to the clock
+/// starts a new movement phase when it ticks; see Cache::set_clock().
+class Phase_clock
+{
+public:
+  /// Returns the current movement phase
+  inline uint32_t now() const
+  {
+    return m_phase.load(std::memory_order_relaxed);
+  }
+
+  /// Starts a new movement phase for every cache attached to the clock.
+  inline void next() { m_phase.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint32_t> m_phase{0};
+};
+
 /// Class to manage resources left in a tile's area. This does not include any
 /// resources that are being carried by transporters in that area, nor resources
 /// left on a building.
 ///
 /// Resource amounts are organized as follows:
-/// There are lists of resources for each player, along with a neutral pile. At
-/// the start of a move phase, all resources should be shifted into the "neutral
-/// pile" (call the reset function). Any transporter can pickup these resources.
+/// Resources are counted by type and by the set of players that have moved
+/// them this phase; resources moved by nobody make up the "neutral pile". At
+/// the start of a move phase, all resources should be shifted into the neutral
+/// pile (call the reset function). Any transporter can pickup these resources.
 /// Whenever a transporter drops a resource in an area, that resource can no
 /// longer be moved by any other transporter owned by that player for that
-/// movement phase. To enforce this, players drop resources into a pile labeled
-/// with their own color. Players can move resources from other players' piles
-/// in the same movement phase.
+/// movement phase. To enforce this, the resource is counted with its carriers.
+/// Players can move resources carried only by other players in the same
+/// movement phase.
+///
+/// Rather than resetting every cache on the board, a cache can be attached to
+/// its game's Phase_clock, and a new movement phase started for all of the
+/// game's caches at once by ticking the clock. Each cache remembers the phase
+/// its carriers were counted in; carriers from an earlier phase read as if
+/// the cache had been reset, and are folded into the neutral pile the next
+/// time the cache changes. Caches without a clock are only reset by reset().
+///
+/// Each type's total is kept in a flat array. Resources nobody has moved yet
+/// are whatever part of the total isn't carried, and the few carried piles sit
+/// in a short inline list sorted by type and carriers. Counting a type takes
+/// constant time; anything involving carriers only walks that type's carried
+/// piles. Nothing is allocated, so copying a cache is a plain memcpy.
+///
+/// The list holds MAX_PILES carried piles. Should an area ever see more kinds
+/// at once, the pile moved by the fewest players (the smallest, among those)
+/// forgets its carriers, and rejoins the neutral pile.
 ///
 /// Because this does not represent resource amounts held by transporters, all
 /// resources can be used during the build and wonder brick phases.
@@ -34,21 +76,130 @@ namespace portable
 class Cache
 {
 public:
+  /// Amount of every resource type, indexed by Resource::Type.
+  using Counts = std::array<uint16_t, RESOURCE_TYPES>;
+
+  /// Most carried piles a cache keeps track of at once.
+  static constexpr size_t MAX_PILES = 8;
+
+  /// Read-only range over every resource in a cache, in resource type order.
+  /// Walks the cache's counts in place without allocating, so it's only good
+  /// until the cache changes. Resources are made as they're reached.
+  class View
+  {
+  public:
+    class iterator
+    {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = Resource;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const Resource *;
+      using reference = Resource;
+
+      iterator() = default;
+      iterator(const Cache *cache, const size_t type)
+          : m_p_cache(cache), m_type(type), m_stale(cache->stale())
+      {
+        skip_empty();
+      }
+
+      Resource operator*() const
+      {
+        return Resource::from_bits(
+            static_cast<Resource::Type>(m_type),
+            (NEUTRAL == m_pile ? 0 : m_p_cache->m_piles[m_pile].carriers));
+      }
+      iterator &operator++()
+      {
+        if (++m_index >= amount())
+        {
+          next_pile();
+          skip_empty();
+        }
+        return *this;
+      }
+      iterator operator++(int)
+      {
+        iterator retval = *this;
+        ++(*this);
+        return retval;
+      }
+      bool operator==(const iterator &other) const
+      {
+        return ((m_type == other.m_type) && (m_pile == other.m_pile) &&
+                (m_index == other.m_index));
+      }
+
+    private:
+      static constexpr size_t NEUTRAL = static_cast<size_t>(-1);
+
+      // Amount in the current pile.
+      uint16_t amount() const
+      {
+        return (NEUTRAL == m_pile ? m_p_cache->neutral(m_type, m_stale)
+                                  : m_p_cache->m_piles[m_pile].amount);
+      }
+
+      // Steps from the neutral pile to the type's carried piles, and from the
+      // last of those on to the next type. Carriers from an earlier phase
+      // don't count, so then there's only the neutral pile.
+      void next_pile()
+      {
+        m_index = 0;
+        m_pile = (NEUTRAL == m_pile ? m_p_cache->first_pile(m_type)
+                                    : m_pile + 1);
+        if (m_stale || (m_pile >= m_p_cache->m_pile_count) ||
+            (m_type != m_p_cache->m_piles[m_pile].type))
+        {
+          m_type++;
+          m_pile = NEUTRAL;
+        }
+      }
+
+      // Moves on to the next pile with anything in it.
+      void skip_empty()
+      {
+        while (m_type < RESOURCE_TYPES)
+        {
+          if ((0 != m_p_cache->m_totals[m_type]) && (0 != amount()))
+          {
+            return;
+          }
+          next_pile();
+        }
+        m_type = RESOURCE_TYPES;
+        m_pile = NEUTRAL;
+      }
+
+      const Cache *m_p_cache = nullptr;
+      size_t m_type = RESOURCE_TYPES;
+      size_t m_pile = NEUTRAL;
+      uint16_t m_index = 0;
+      bool m_stale = false;
+    };
+
+    View(const Cache &cache) : m_p_cache(&cache) {}
+
+    iterator begin() const { return iterator(m_p_cache, 0); }
+    iterator end() const { return iterator(m_p_cache, RESOURCE_TYPES); }
+    bool empty() const { return 0 == m_p_cache->size(); }
+
+  private:
+    const Cache *m_p_cache;
+  };
+
   Cache();
-  Cache(const Cache &other);
-  ~Cache();
+  Cache(const Cache &other) = default;
+  ~Cache() = default;
 
-  bool operator==(Cache &other);
   bool operator==(Cache const &other) const;
-  bool operator!=(Cache &other);
   bool operator!=(Cache const &other) const;
-  Cache operator=(const Cache &other);
-  Cache operator+(const Cache &other);
+  Cache &operator=(const Cache &other) = default;
   Cache operator+(const Cache &other) const;
-  Cache operator+(const std::vector<Resource *> &res_list);
-  Cache operator+(const std::vector<Resource *> &res_list) const;
+  Cache operator+(const std::vector<Resource> &res_list) const;
   void operator+=(const Cache &other);
-  void operator+=(const std::vector<Resource *> &res_list);
+  void operator+=(const std::vector<Resource> &res_list);
 
   /// Removes all resources from the cache
   void clear();
@@ -56,14 +207,31 @@ public:
   /// Resets all resources for a new round. Maintains resource amounts.
   void reset();
 
-  /// Clears out any empty pointers or empty lists from cache.
-  void clean();
+  /// Attaches the cache to its game's phase clock. Carriers counted so far
+  /// count for the clock's current phase. Copies share the clock, which isn't
+  /// owned, so it has to outlive them or be detached first.
+  /// @param[in] clock  The game's clock. Null detaches the cache.
+  void set_clock(const Phase_clock *clock);
+
+  /// Returns the movement phase the cache's game is in. Without a clock, this
+  /// is the phase the carriers were counted in.
+  inline uint32_t phase() const
+  {
+    return (m_p_clock ? m_p_clock->now() : m_phase);
+  }
+
+  /// Kept for callers of the old resource lists. Counts have nothing to clean
+  /// up, so this does nothing.
+  void clean() {}
 
   /// Returns the total resource amount
   /// @param[in] res Resource to check
   /// @return A read of the total amount of the input resource in the cache
   uint16_t count(const Resource::Type res) const;
 
+  /// Returns the total amount of every resource type at once
+  inline const Counts &counts() const { return m_totals; }
+
   /// Returns the resource amount the player can move
   /// @param[in] res Resource to check
   /// @param[in] player Requesting player
@@ -72,22 +240,23 @@ public:
                           const player::Color player) const;
 
   /// Returns a list of all the resources in the cache
-  // TODO: does it make more sense to use a vector or a map for viewing all
-  // resources in a cache? std::map<Resource::Type, std::vector<Resource *>>
-  // all() const;
-  std::vector<Resource *> all() const;
+  std::vector<Resource> all() const;
+
+  /// Returns a view of all the resources in the cache, without copying them
+  /// into a list.
+  inline View view() const { return View(*this); }
 
   /// Returns a list of all moveable resources in the cache
   /// @param[in] p  Player color requesting list of resources
   /// @return  A list of all resources that can be moved by the input player
-  std::vector<Resource *> all_moveable(const player::Color p) const;
+  std::vector<Resource> all_moveable(const player::Color p) const;
 
   /// Adds resource to the cache
   /// @param[in] res  Resource to add
   /// @return
   ///   - common::ERR_NONE on success
   ///   - common::ERR_INVALID on invalid resource
-  common::Error add(Resource *&res);
+  common::Error add(const Resource &res);
 
   /// Adds resource to the cache
   /// @param[in] res  Resource to add
@@ -101,14 +270,26 @@ public:
   /// @return
   ///   - common::ERR_NONE on success
   ///   - common::ERR_INVALID on invalid resource
-  common::Error add(std::vector<Resource *> &res_list);
+  common::Error add(const std::vector<Resource> &res_list);
 
-  /// Adds resources to the cache
-  /// @param[in] res_list  Resources to add
+  /// Moves every resource from the other cache into this one, carriers and
+  /// all. The other cache is left empty.
+  /// @param[in] other  Cache to empty into this one
+  void merge_from(Cache &&other);
+
+  /// Moves some of a resource from the other cache into this one, keeping
+  /// their carriers. Like get(), resources moved by the most players go
+  /// first.
+  /// @param[in] res  The type of resource to move
+  /// @param[in] amount  The amount to move
+  /// @param[in] other  Cache to move the resources out of
   /// @return
   ///   - common::ERR_NONE on success
-  ///   - common::ERR_FAIL on failure to add anything
-  common::Error add(std::vector<Portable *> &res_list);
+  ///   - common::ERR_FAIL on insufficient resources in the other cache
+  ///   - common::ERR_INVALID on invalid resource type, or if the other cache
+  ///   is this one
+  common::Error splice(const Resource::Type res, const uint16_t amount,
+                       Cache &other);
 
   /// Removes resource from the cache
   /// @param[in] res  Resource to remove
@@ -120,6 +301,14 @@ public:
   ///   - common::ERR_UNKNOWN on any other error
   common::Error remove(const Resource::Type res, const uint16_t amount = 1);
 
+  /// Removes the input amount of every resource type. Nothing is removed
+  /// unless the cache holds all of it.
+  /// @param[in] amounts  Amount of each type to remove
+  /// @return
+  ///   - common::ERR_NONE on success
+  ///   - common::ERR_FAIL if insufficient resource amount to remove
+  common::Error remove(const Counts &amounts);
+
   /// Retrieves the specified amount of the input resource from the cache.
   /// Retrieved resources are removed from the cache.
   /// @param[in] res  The type of resource to remove
@@ -129,8 +318,7 @@ public:
   ///   - common::ERR_NONE on success
   ///   - common::ERR_FAIL on insufficient resources in cache
   ///   - common::ERR_INVALID on invalid resource type requested
-  common::Error get(const Resource::Type res,
-                    std::vector<std::unique_ptr<Resource>> &result,
+  common::Error get(const Resource::Type res, std::vector<Resource> &result,
                     const uint16_t amount);
 
   /// Retrieves the specified amount of the input resource from the cache.
@@ -144,8 +332,7 @@ public:
   ///   - common::ERR_FAIL on insufficient resources in cache
   ///   - common::ERR_INVALID on invalid resource type requested
   common::Error get(const Resource::Type res, const player::Color clr,
-                    std::vector<std::unique_ptr<Resource>> &result,
-                    const uint16_t amount);
+                    std::vector<Resource> &result, const uint16_t amount);
 
   /// Returns a total count of all resources in the cache
   uint32_t size() const;
@@ -156,8 +343,85 @@ public:
 
 protected:
 private:
-  std::map<Resource::Type, std::vector<std::unique_ptr<Resource>>> m_resources;
+  /// Resources of one type carried by the same set of players this phase.
+  /// Carrier masks have bit c set when player::Color c has moved them.
+  struct Pile
+  {
+    uint8_t type;
+    uint8_t carriers;
+    uint16_t amount;
+  };
+
+  /// Returns whether the carriers were counted in an earlier phase
+  inline bool stale() const { return m_phase != phase(); }
+
+  /// Folds the carriers of an earlier phase into the neutral pile, so they
+  /// can be counted for this one. Called before anything changes.
+  inline void refresh()
+  {
+    if (stale())
+    {
+      reset();
+    }
+  }
+
+  /// Takes up to the input amount of a resource from the cache, starting with
+  /// the piles moved by the most players.
+  /// @param[in] t
+  /// @param[in] amount
+  /// @param[in] skip  Carrier bits of piles to leave alone
+  /// @param[out] taken  Resources taken are added here. May be null.
+  /// @param[out] into  Cache the resources taken are put in. May be null.
+  /// @return The amount taken
+  uint16_t take(const Resource::Type t, const uint16_t amount,
+                const uint8_t skip, std::vector<Resource> *taken,
+                Cache *into = nullptr);
+
+  /// Adds to the amount of a resource with the input carriers.
+  /// @param[in] t
+  /// @param[in] carriers  Carrier mask
+  /// @param[in] amount
+  void put(const Resource::Type t, const uint8_t carriers,
+           const uint16_t amount = 1);
+
+  /// Adds to the carried pile with the input type and carriers, without
+  /// touching the type's total. If there's no room for a new pile, the pile
+  /// moved by the fewest players rejoins the neutral pile.
+  /// @param[in] t
+  /// @param[in] carriers  Carrier mask. Must not be 0.
+  /// @param[in] amount
+  void add_pile(const size_t t, const uint8_t carriers, const uint16_t amount);
+
+  /// Returns the index of the first carried pile of the input type, or of
+  /// the first pile after where it would go.
+  size_t first_pile(const size_t t) const;
+
+  /// Returns the amount of a resource type nobody has moved this phase
+  /// @param[in] t
+  /// @param[in] stale  Whether the carriers are from an earlier phase
+  uint16_t neutral(const size_t t, const bool stale) const;
+
+  /// Drops the carried pile at the input index, leaving its resources in the
+  /// neutral pile
+  void erase_pile(const size_t i);
+
+  // Each resource type's total, and the piles of it carried by any players,
+  // sorted by type and then carrier mask. The piled mask has a bit for each
+  // type with a pile, so lookups of the others skip the scan; it shares a
+  // word with the pile count to keep the cache at its size.
+  Counts m_totals;
+  std::array<Pile, MAX_PILES> m_piles;
+  uint32_t m_pile_count : 4;
+  uint32_t m_piled : RESOURCE_TYPES;
+  // Phase the carried piles above were counted in, and the clock of the game
+  // the cache is in.
+  uint32_t m_phase;
+  const Phase_clock *m_p_clock;
 };
+
+static_assert(Cache::MAX_PILES < (1 << 4));
+static_assert(4 + RESOURCE_TYPES <= 32);
+static_assert(std::is_trivially_copyable_v<Cache>);
 }; // namespace portable
 
 #endif
\ No newline at end of file
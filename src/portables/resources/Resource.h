@@ -1,8 +1,11 @@
 #ifndef RESOURCE_H
 #define RESOURCE_H
 
+#include <cstdint>
+#include <set>
 #include <sstream>
 #include <string>
+#include <type_traits>
 
 #include <nlohmann/json.hpp>
 
@@ -19,10 +22,12 @@ static const size_t RESOURCE_NAMES_SIZE =
     sizeof RESOURCE_NAMES / sizeof RESOURCE_NAMES[0];
 static const size_t RESOURCE_TYPES = RESOURCE_NAMES_SIZE;
 
+/// A single good. Just its type and its carriers, so it's a two byte value
+/// that's copied around freely rather than allocated.
 class Resource : public Portable
 {
 public:
-  enum Type
+  enum Type : int8_t
   {
     invalid = -1,
     trunks = 0,
@@ -79,39 +84,39 @@ public:
     return ((0 <= t) && (RESOURCE_NAMES_SIZE > static_cast<size_t>(t)));
   }
 
-  Resource() : Portable(Portable::Object::resource), m_type(Type::invalid) {}
-
-  Resource(const Type res_type)
-      : Portable(Portable::Object::resource), m_type(res_type)
+  constexpr Resource() = default;
+  constexpr Resource(const Type res_type) : m_type(res_type) {}
+  Resource(const Type res_type, const std::set<player::Color> &carriers)
+      : Portable(carriers), m_type(res_type)
   {
   }
-  Resource(const Type res_type, const std::set<player::Color> carriers)
-      : Portable(carriers, Portable::Object::resource), m_type(res_type)
+
+  /// Makes a resource carried by the players in the input carrier mask.
+  /// @param[in] res_type
+  /// @param[in] carriers  Carrier mask; see Portable::get_carrier_bits
+  /// @return The resource
+  static constexpr Resource from_bits(const Type res_type,
+                                      const uint8_t carriers)
   {
+    Resource retval(res_type);
+    retval.m_carriers =
+        static_cast<uint8_t>(carriers & ((1 << player::MAX_PLAYER_COLORS) - 1));
+    return retval;
   }
-  ~Resource(){};
 
-  bool operator==(Resource &other) { return m_type == other.m_type; }
   bool operator==(Resource const &other) const
   {
     return m_type == other.m_type;
   }
-  bool operator!=(Resource &other) { return !(*this == other); }
   bool operator!=(Resource const &other) const { return !(*this == other); }
-  Resource operator=(const Resource &other)
-  {
-    m_type = other.m_type;
-    m_object = other.m_object;
-    m_carriers = other.m_carriers;
-    return (*this);
-  }
 
-  inline Type get_type() { return m_type; }
+  inline Type get_type() const { return m_type; }
+  inline Object get_object() const { return Object::resource; }
 
   friend void to_json(nlohmann::json &j, const Resource &res)
   {
     std::vector<std::string> carriers;
-    for (auto clr : res.m_carriers)
+    for (auto clr : res.get_carriers())
     {
       carriers.push_back(player::to_string(clr));
     }
@@ -146,10 +151,13 @@ public:
 
 protected:
 private:
-  Type m_type;
+  Type m_type = Type::invalid;
 
 }; // namespace portable
 
+static_assert(std::is_trivially_copyable_v<Resource>);
+static_assert(2 == sizeof(Resource));
+
 static std::ostream &operator<<(std::ostream &output,
                                 const portable::Resource::Type &r)
 {
@@ -0,0 +1,171 @@
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <common/Errors.h>
+#include <tiles/Map_generator.h>
+#include <tiles/Tile.h>
+#include <tiles/Tile_map.h>
+#include <tiles/components/Hex.h>
+#include <tiles/components/Hex_range.h>
+#include <utils/parallel_utils.h>
+
+namespace tile
+{
+namespace
+{
+// Salts keeping each kind of decision independent of the others.
+enum Roll : uint64_t
+{
+  patch_terrain = 1,
+  tile_terrain,
+  scatter,
+  lake,
+  river
+};
+
+// Land terrain is picked from this table, so plains and forests are the most
+// common.
+static constexpr Terrain LAND_TERRAIN[] = {
+    Terrain::plains, Terrain::plains,   Terrain::forest,   Terrain::forest,
+    Terrain::desert, Terrain::mountain, Terrain::mountain, Terrain::rock};
+static constexpr uint64_t LAND_TERRAIN_SIZE =
+    sizeof(LAND_TERRAIN) / sizeof(LAND_TERRAIN[0]);
+
+// Terrain comes in patches of PATCH_SIZE x PATCH_SIZE tiles (in axial
+// coordinates), with 1 in SCATTER_CHANCE tiles picking their own terrain
+// instead. 1 in LAKE_CHANCE patches is a lake.
+static constexpr int PATCH_SHIFT = 2;
+static constexpr uint64_t SCATTER_CHANCE = 4;
+static constexpr uint64_t LAKE_CHANCE = 16;
+
+// A river crosses 1 in RIVER_CHANCE sides between two land tiles, and 1 in
+// MOUTH_CHANCE sides between land and sea.
+static constexpr uint64_t RIVER_CHANCE = 5;
+static constexpr uint64_t MOUTH_CHANCE = 3;
+} // namespace
+
+Map_generator::Map_generator(const uint64_t seed) : m_seed(seed) {}
+
+uint64_t Map_generator::roll(const uint64_t key, const uint64_t salt) const
+{
+  return mix_hash(mix_hash(m_seed + salt) ^ key);
+}
+
+Terrain Map_generator::terrain_at(const Hex coord, const Board &board) const
+{
+  for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
+  {
+    if (!board.contains(coord.neighbor(static_cast<Direction>(i))))
+    {
+      return Terrain::sea;
+    }
+  }
+
+  Hex patch(coord.q() >> PATCH_SHIFT, coord.r() >> PATCH_SHIFT);
+  if (0 == roll(patch.key(), Roll::lake) % LAKE_CHANCE)
+  {
+    return Terrain::sea;
+  }
+  if (0 == roll(coord.key(), Roll::scatter) % SCATTER_CHANCE)
+  {
+    return LAND_TERRAIN[roll(coord.key(), Roll::tile_terrain) %
+                        LAND_TERRAIN_SIZE];
+  }
+  return LAND_TERRAIN[roll(patch.key(), Roll::patch_terrain) %
+                      LAND_TERRAIN_SIZE];
+}
+
+bool Map_generator::has_river(const Hex coord, const Direction d,
+                              const Board &board) const
+{
+  Hex other = coord.neighbor(d);
+  if ((!board.contains(other)) ||
+      (Terrain::sea == terrain_at(coord, board)))
+  {
+    return false;
+  }
+
+  // Each side is rolled for by the tile it's east or south of, so both tiles
+  // sharing it roll the same number.
+  Hex owner = coord;
+  Direction side = d;
+  if ((east != d) && (south_east != d) && (south_west != d))
+  {
+    owner = other;
+    side = !d;
+  }
+  uint64_t chance = (Terrain::sea == terrain_at(other, board)) ? MOUTH_CHANCE
+                                                                : RIVER_CHANCE;
+  const uint64_t salt =
+      static_cast<uint64_t>(Roll::river) + static_cast<uint64_t>(side);
+  return (0 == roll(owner.key(), salt) % chance);
+}
+
+common::Error Map_generator::generate(const size_t tile_count,
+                                      Tile_map &map) const
+{
+  if ((0 == tile_count) || (map.is_locked()))
+  {
+    return common::ERR_INVALID;
+  }
+  map.reset();
+
+  // Lay out the board: whole rings around the origin, then as much of the
+  // next ring as it takes to reach the tile count.
+  int radius = 0;
+  while (hex_spiral(Hex(), radius).size() < tile_count)
+  {
+    radius++;
+  }
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> tiles;
+  tiles.reserve(tile_count);
+  Board board;
+  for (const Hex coord : hex_spiral(Hex(), radius))
+  {
+    if (tiles.size() == tile_count)
+    {
+      break;
+    }
+    board.insert(coord, static_cast<uint32_t>(tiles.size()));
+    tiles.push_back({coord, nullptr});
+  }
+
+  // Every tile only depends on the seed and the board's shape, so they can be
+  // built in any order.
+  utils::parallel_for(
+      tiles.size(), PARALLEL_THRESHOLD,
+      [this, &tiles, &board](const size_t begin, const size_t end)
+      {
+        for (size_t i = begin; i < end; i++)
+        {
+          const Hex coord = tiles[i].first;
+          Terrain terrain = terrain_at(coord, board);
+          Direction_mask river_points;
+          for (uint8_t d = 0; d < MAX_DIRECTIONS; d++)
+          {
+            if (has_river(coord, static_cast<Direction>(d), board))
+            {
+              river_points.insert(static_cast<Direction>(d));
+            }
+          }
+          if (river_points.empty())
+          {
+            tiles[i].second = std::make_shared<Tile>(coord, terrain);
+          }
+          else
+          {
+            tiles[i].second =
+                std::make_shared<Tile>(coord, river_points, terrain);
+          }
+        }
+      });
+
+  if (common::ERR_NONE != map.insert_many(tiles))
+  {
+    map.reset();
+    return common::ERR_FAIL;
+  }
+  return common::ERR_NONE;
+}
+} // namespace tile
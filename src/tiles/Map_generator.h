@@ -0,0 +1,73 @@
+#ifndef MAP_GENERATOR_H
+#define MAP_GENERATOR_H
+
+#include <cstdint>
+
+#include <common/Errors.h>
+#include <tiles/Tile.h>
+#include <tiles/Tile_map.h>
+#include <tiles/Tile_store.h>
+#include <tiles/components/Hex.h>
+
+namespace tile
+{
+/// Builds large, valid maps from a seed; mostly for load testing. Every
+/// random choice is a hash of the seed and the coordinates it's made for, so
+/// the same seed always gives the same map, no matter how the work is split
+/// up between threads.
+///
+/// The board grows outward from (0, 0) ring by ring. Tiles on its edge are
+/// sea, so no river can run off the map, and sea lakes are scattered inland.
+/// Land terrain comes in patches a few tiles across. Rivers are decided one
+/// tile edge at a time, so both tiles sharing an edge always agree on whether
+/// a river crosses it; a river may also run into the sea.
+class Map_generator
+{
+public:
+  /// @param[in] seed  Maps from the same seed are identical
+  Map_generator(const uint64_t seed = 0);
+
+  inline uint64_t get_seed() const { return m_seed; }
+
+  /// Generates a map of `tile_count` tiles, building the tiles across a pool
+  /// of threads for large maps.
+  /// @param[in] tile_count  Number of tiles to generate
+  /// @param[out] map  Generated map. Reset first, and left empty on error.
+  /// @return
+  ///   - ERR_NONE on success
+  ///   - ERR_INVALID if tile_count is 0 or the map is locked
+  ///   - ERR_FAIL if the tiles couldn't be placed on the map
+  common::Error generate(const size_t tile_count, Tile_map &map) const;
+
+private:
+  /// Coordinates on the board, mapped to their index in the generated batch.
+  using Board = Chunked_store<uint32_t>;
+
+  /// Rolls a number for one decision about one spot on the board.
+  /// @param[in] key  Packed coordinates the decision is about
+  /// @param[in] salt  Which decision is being made
+  /// @return A well-mixed 64-bit value
+  uint64_t roll(const uint64_t key, const uint64_t salt) const;
+
+  /// Picks the terrain at the input coordinates.
+  /// @param[in] coord
+  /// @param[in] board
+  /// @return The terrain. Always sea on the board's edge.
+  Terrain terrain_at(const Hex coord, const Board &board) const;
+
+  /// Decides whether a river crosses the side of the tile at `coord` facing
+  /// `d`. Both tiles sharing the side get the same answer.
+  /// @param[in] coord
+  /// @param[in] d
+  /// @param[in] board
+  /// @return true if a river point belongs on that side
+  bool has_river(const Hex coord, const Direction d, const Board &board) const;
+
+  /// Boards with at least this many tiles are built across a pool of threads.
+  static constexpr size_t PARALLEL_THRESHOLD = 4096;
+
+  uint64_t m_seed;
+};
+} // namespace tile
+
+#endif
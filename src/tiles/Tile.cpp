@@ -2,6 +2,7 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include <nlohmann/json.hpp>
@@ -9,6 +10,7 @@
 
 #include <buildings/Building.h>
 #include <players/Player.h>
+#include <portables/resources/Cache.h>
 #include <portables/resources/Resource.h>
 #include <portables/transporters/Transporter.h>
 #include <tiles/Tile.h>
@@ -22,78 +24,101 @@ namespace tile
 {
 
 Tile::Tile(const Terrain t)
-    : m_terrain(t), m_rot_locked(false), m_hex_set(false),
-      m_neighbors_are_current(true)
+    : m_p_prototype(Tile_prototype::fresh(t)), m_rot_locked(false),
+      m_hex_set(false), m_neighbors_are_current(true)
 {
   init();
 }
 
 Tile::Tile(const Hex hex, const Terrain t)
-    : m_hex(hex), m_terrain(t), m_rot_locked(false), m_hex_set(true),
-      m_neighbors_are_current(true)
+    : m_hex(hex), m_p_prototype(Tile_prototype::fresh(t)), m_rot_locked(false),
+      m_hex_set(true), m_neighbors_are_current(true)
 {
   init();
 }
 
-Tile::Tile(const std::set<Direction> river_points, const Terrain t)
-    : m_terrain(t), m_rot_locked(false), m_hex_set(false),
-      m_neighbors_are_current(true)
+Tile::Tile(const Direction_mask river_points, const Terrain t)
+    : m_p_prototype(Tile_prototype::fresh(t, river_points)),
+      m_rot_locked(false), m_hex_set(false), m_neighbors_are_current(true)
 {
-  m_rivers.push_back(std::make_shared<River>(river_points));
   init();
 }
 
-Tile::Tile(const Hex hex, std::set<Direction> river_points, const Terrain t)
-    : m_hex(hex), m_terrain(t), m_rot_locked(false), m_hex_set(true),
-      m_neighbors_are_current(true)
+Tile::Tile(const Hex hex, const Direction_mask river_points, const Terrain t)
+    : m_hex(hex), m_p_prototype(Tile_prototype::fresh(t, river_points)),
+      m_rot_locked(false), m_hex_set(true), m_neighbors_are_current(true)
 {
-  m_rivers.push_back(std::make_shared<River>(river_points));
   init();
 }
 
-Tile::Tile(const std::vector<std::set<Direction>> river_points, const Terrain t)
-    : m_terrain(t), m_rot_locked(false), m_hex_set(false),
-      m_neighbors_are_current(true)
+Tile::Tile(const std::vector<Direction_mask> river_points, const Terrain t)
+    : m_p_prototype(Tile_prototype::fresh(t, river_points)),
+      m_rot_locked(false), m_hex_set(false), m_neighbors_are_current(true)
 {
-  for (auto rp : river_points)
-  {
-    m_rivers.push_back(std::make_shared<River>(rp));
-  }
   init();
 }
 
-Tile::Tile(const Hex hex, const std::vector<std::set<Direction>> river_points,
+Tile::Tile(const Hex hex, const std::vector<Direction_mask> river_points,
            const Terrain t)
-    : m_hex(hex), m_terrain(t), m_rot_locked(false), m_hex_set(true),
-      m_neighbors_are_current(true)
+    : m_hex(hex), m_p_prototype(Tile_prototype::fresh(t, river_points)),
+      m_rot_locked(false), m_hex_set(true), m_neighbors_are_current(true)
 {
-  for (auto rp : river_points)
-  {
-    m_rivers.push_back(std::make_shared<River>(rp));
-  }
   init();
 }
 
 Tile::Tile(const Tile &other)
-    : m_hex(other.m_hex), m_terrain(other.m_terrain), m_rivers(other.m_rivers),
-      m_areas(other.m_areas), m_rot_locked(other.m_rot_locked),
+    : std::enable_shared_from_this<Tile>(), m_hex(other.m_hex),
+      m_p_prototype(other.m_p_prototype), m_fingerprint(other.m_fingerprint),
+      m_sea_sides(other.m_sea_sides), m_areas(other.m_areas),
+      m_bridges(other.m_bridges), m_rot_locked(other.m_rot_locked),
       m_hex_set(other.m_hex_set),
       m_neighbors_are_current(other.m_neighbors_are_current)
 {
+  // The copy is a tile of its own, without a slot, but it sees the same
+  // neighbors.
+  m_self.share_table(other.m_self);
   for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
   {
     m_walls[i] = other.m_walls[i];
     m_neighbors[i] = other.m_neighbors[i];
   }
+  m_placeholders = other.m_placeholders;
+  adopt_areas();
 }
 
-Tile::~Tile()
+void Tile::join(const std::shared_ptr<Tile_slots> &slots)
 {
-  reset();
-  m_rivers.clear();
-  m_areas.clear();
+  if (m_self.slots() == slots)
+  {
+    m_self.join(this, slots);
+    return;
+  }
+  // A copy's links are its original's; only a tile with a slot of its own
+  // is linked back to.
+  if (m_self.handle().empty())
+  {
+    leave_slots();
+  }
+  else
+  {
+    clear_neighbors();
+  }
+  m_self.join(this, slots);
+  set_phase_clock(slots->clock());
 }
 
+void Tile::leave_slots()
+{
+  for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
+  {
+    set_neighbor(static_cast<Direction>(i), nullptr);
+  }
+  m_self.leave();
+  set_phase_clock(nullptr);
+}
+
+Tile::~Tile() { clear_neighbors(); }
+
 void Tile::init()
 {
   for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
@@ -101,29 +126,43 @@ void Tile::init()
     m_walls[i] = building::Wall(player::Color::neutral, 0);
   }
 
-  if (Terrain::sea == m_terrain)
+  // Sea tiles' prototypes never have rivers, and always have just one area,
+  // which covers the entire tile.
+  const Tile_shape &shape = m_p_prototype->shape();
+  m_areas.clear();
+  m_areas.reserve(shape.areas.size());
+  for (Border_mask borders : shape.areas)
+  {
+    m_areas.emplace_back(borders, this);
+  }
+  m_bridges.clear();
+  refresh_fingerprint();
+}
+
+void Tile::adopt_areas()
+{
+  for (auto &area : m_areas)
   {
-    // Don't allow sea tiles to have rivers. Sea tiles always have just one
-    // area, which covers the entire tile.
-    m_rivers.clear();
-    m_areas.push_back(std::make_shared<Area>(ALL_BORDERS, this));
-    return;
+    area.set_parent(this);
   }
+}
 
-  split_by_rivers();
+void Tile::set_phase_clock(const portable::Phase_clock *clock)
+{
+  for (auto &area : m_areas)
+  {
+    area.set_phase_clock(clock);
+  }
 }
 
 void Tile::reset()
 {
   m_hex = Hex();
-  for (auto area : m_areas)
-  {
-    area->reset();
-  }
-  for (auto river : m_rivers)
+  for (auto &area : m_areas)
   {
-    river->reset();
+    area.reset();
   }
+  m_bridges.clear();
   clear_neighbors();
   for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
   {
@@ -134,18 +173,30 @@ void Tile::reset()
   m_neighbors_are_current = true;
 }
 
+void Tile::abort_load()
+{
+  reset();
+  // A failed load can leave areas half loaded.
+  reshape();
+}
+
 Tile Tile::operator=(const Tile &other)
 {
   m_hex = other.m_hex;
-  m_terrain = other.m_terrain;
+  m_p_prototype = other.m_p_prototype;
+  m_fingerprint = other.m_fingerprint;
+  m_sea_sides = other.m_sea_sides;
+  m_self.share_table(other.m_self);
   for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
   {
     m_neighbors[i] = other.m_neighbors[i];
     m_walls[i] = other.m_walls[i];
   }
+  m_placeholders = other.m_placeholders;
 
-  m_rivers = other.m_rivers;
   m_areas = other.m_areas;
+  m_bridges = other.m_bridges;
+  adopt_areas();
 
   m_rot_locked = other.m_rot_locked;
   m_hex_set = other.m_hex_set;
@@ -153,60 +204,28 @@ Tile Tile::operator=(const Tile &other)
   return (*this);
 }
 
-bool Tile::operator==(Tile &other) const
+bool Tile::operator==(Tile const &other) const
 {
-  if ((m_terrain != other.m_terrain) || (m_rivers != other.m_rivers) ||
-      (m_areas != other.m_areas) || (m_rot_locked != other.m_rot_locked))
+  if (fingerprint() != other.fingerprint())
   {
     return false;
   }
-
-  // If both tiles have set their hex points, they should agree.
-  if ((m_hex_set) && (other.m_hex_set) && (m_hex != other.m_hex))
+  if ((m_p_prototype != other.m_p_prototype) ||
+      (m_bridges != other.m_bridges) || (m_rot_locked != other.m_rot_locked))
   {
     return false;
   }
-
-  if ((!m_neighbors_are_current) || (!other.m_neighbors_are_current))
-  {
-    // A little more lax on checking neighbors; just check that both tiles say
-    // they should have neighbors in the same direction
-    for (Direction d : ALL_DIRECTIONS)
-    {
-      if (((nullptr == m_neighbors[d]) && (nullptr != other.m_neighbors[d])) ||
-          ((nullptr == other.m_neighbors[d]) && (nullptr != m_neighbors[d])))
-      {
-        return false;
-      }
-      if (m_walls[d] != other.m_walls[d])
-      {
-        return false;
-      }
-    }
-  }
-  else
+  // Sharing a prototype, both tiles list matching areas in the same order.
+  // Areas point back at their own tile, so compare what they hold instead.
+  for (size_t i = 0; i < m_areas.size(); i++)
   {
-    for (Direction d : ALL_DIRECTIONS)
+    if ((m_areas[i].fingerprint() != other.m_areas[i].fingerprint()) ||
+        (m_areas[i].get_resource_cache() !=
+         other.m_areas[i].get_resource_cache()))
     {
-      if (m_neighbors[d] != other.m_neighbors[d])
-      {
-        return false;
-      }
-      if (m_walls[d] != other.m_walls[d])
-      {
-        return false;
-      }
+      return false;
     }
   }
-  return true;
-}
-bool Tile::operator==(Tile const &other) const
-{
-  if ((m_terrain != other.m_terrain) || (m_rivers != other.m_rivers) ||
-      (m_areas != other.m_areas) || (m_rot_locked != other.m_rot_locked))
-  {
-    return false;
-  }
 
   // If both tiles have set their hex points, they should agree.
   if ((m_hex_set) && (other.m_hex_set) && (m_hex != other.m_hex))
@@ -220,8 +239,7 @@ bool Tile::operator==(Tile const &other) const
     // they should have neighbors in the same direction
     for (Direction d : ALL_DIRECTIONS)
     {
-      if (((nullptr == m_neighbors[d]) && (nullptr != other.m_neighbors[d])) ||
-          ((nullptr == other.m_neighbors[d]) && (nullptr != m_neighbors[d])))
+      if ((nullptr == neighbor_at(d)) != (nullptr == other.neighbor_at(d)))
       {
         return false;
       }
@@ -235,7 +253,7 @@ bool Tile::operator==(Tile const &other) const
   {
     for (Direction d : ALL_DIRECTIONS)
     {
-      if (m_neighbors[d] != other.m_neighbors[d])
+      if (neighbor_at(d) != other.neighbor_at(d))
       {
         return false;
       }
@@ -247,77 +265,76 @@ bool Tile::operator==(Tile const &other) const
   }
   return true;
 }
-bool Tile::operator!=(Tile &other) const { return !(*this == other); }
 bool Tile::operator!=(Tile const &other) const { return !(*this == other); }
 
-std::shared_ptr<River> Tile::get_river(const Direction d)
+uint64_t Tile::fingerprint() const
 {
-  std::shared_ptr<River> retval;
-  for (size_t i = 0; i < m_rivers.size(); i++)
+  uint64_t retval = m_fingerprint;
+  for (const auto &area : m_areas)
   {
-    if (m_rivers.at(i)->has_point(d))
-    {
-      retval = m_rivers.at(i);
-      break;
-    }
+    retval += area.fingerprint();
   }
-  return retval;
+  return mix_hash(retval);
 }
 
-std::set<Direction> Tile::get_river_points() const
+std::optional<River> Tile::get_river(const Direction d) const
 {
-  std::set<Direction> retval;
-  for (auto river : m_rivers)
+  const uint8_t slot = m_p_prototype->river_slot(d);
+  if (Tile_prototype::NO_SLOT == slot)
   {
-    std::set<Direction> pts = river->get_points();
-    retval.insert(pts.begin(), pts.end());
+    return std::nullopt;
   }
-
-  return retval;
+  const Direction_mask points = m_p_prototype->shape().rivers[slot];
+  return River(points, points & m_bridges);
 }
 
-std::set<Direction> Tile::get_bridges() const
+std::vector<River> Tile::get_rivers() const
 {
-  std::set<Direction> retval;
-  for (auto river : m_rivers)
+  const Tile_shape &shape = m_p_prototype->shape();
+  std::vector<River> retval;
+  retval.reserve(shape.river_count);
+  for (uint8_t i = 0; i < shape.river_count; i++)
   {
-    std::set<Direction> bridges = river->get_bridges();
-    retval.insert(bridges.begin(), bridges.end());
+    retval.emplace_back(shape.rivers[i], shape.rivers[i] & m_bridges);
   }
-
   return retval;
 }
 
-std::set<Direction> Tile::get_river_points(const Direction d)
+Direction_mask Tile::get_river_points() const
 {
-  std::shared_ptr<River> river = get_river(d);
-  if (river)
-  {
-    return river->get_points();
-  }
-  return std::set<Direction>();
+  return m_p_prototype->river_points();
 }
 
-std::shared_ptr<Area> Tile::get_area(const Border b)
+Direction_mask Tile::get_river_points(const Direction d) const
 {
-  std::shared_ptr<Area> retval;
-  for (size_t i = 0; i < m_areas.size(); i++)
-  {
-    if (m_areas.at(i)->has_border(b))
-    {
-      retval = m_areas.at(i);
-      break;
-    }
-  }
-  return retval;
+  const uint8_t slot = m_p_prototype->river_slot(d);
+  return (Tile_prototype::NO_SLOT != slot) ? m_p_prototype->shape().rivers[slot]
+                                           : Direction_mask();
+}
+
+Area *Tile::get_area(const Border b)
+{
+  const uint8_t slot = m_p_prototype->area_slot(b);
+  return (Tile_prototype::NO_SLOT != slot) ? &m_areas[slot] : nullptr;
+}
+
+const Area *Tile::get_area(const Border b) const
+{
+  const uint8_t slot = m_p_prototype->area_slot(b);
+  return (Tile_prototype::NO_SLOT != slot) ? &m_areas[slot] : nullptr;
 }
 
 std::shared_ptr<Tile> Tile::get_neighbor(Direction direction)
 {
-  return m_neighbors[direction];
+  Tile *neighbor = neighbor_at(direction);
+  return (nullptr != neighbor) ? neighbor->shared_from_this() : nullptr;
 }
 
-std::shared_ptr<Tile> *Tile::get_neighbors() { return m_neighbors; }
+std::shared_ptr<const Tile> Tile::get_neighbor(Direction direction) const
+{
+  const Tile *neighbor = neighbor_at(direction);
+  return (nullptr != neighbor) ? neighbor->shared_from_this() : nullptr;
+}
 
 std::map<Direction, building::Wall> Tile::get_built_walls() const
 {
@@ -332,33 +349,25 @@ std::map<Direction, building::Wall> Tile::get_built_walls() const
   return retval;
 }
 
-bool Tile::is_neighboring_sea() const
-{
-  for (auto neighbor : m_neighbors)
-  {
-    if ((neighbor) && (Terrain::sea == neighbor->m_terrain))
-    {
-      return true;
-    }
-  }
-  return false;
-}
-
-bool Tile::is_shore() const
-{
-  return ((!m_rivers.empty() || is_neighboring_sea()) &&
-          (Terrain::sea != m_terrain));
-}
-
 common::Error Tile::add_neighbor(std::shared_ptr<Tile> neighbor,
                                  Direction direction)
 {
   common::Error err = can_add_neighbor(neighbor, direction);
   if (common::ERR_NONE == err)
   {
-    m_neighbors[direction] = neighbor;
+    // Linked tiles share a table. A tile that's in none yet joins its
+    // neighbor's; a lone pair starts a table of their own.
+    std::shared_ptr<Tile_slots> slots =
+        get_slots() ? get_slots() : neighbor->get_slots();
+    if (!slots)
+    {
+      slots = std::make_shared<Tile_slots>();
+    }
+    join(slots);
+    neighbor->join(slots);
+    set_neighbor(direction, neighbor.get());
     // Set the new neighbor's hex coordinates to match what we expect
-    m_neighbors[direction]->set_hex(m_hex.neighbor(direction));
+    neighbor->set_hex(m_hex.neighbor(direction));
     m_rot_locked = true;
   }
   return err;
@@ -370,52 +379,47 @@ common::Error Tile::remove_neighbor(Direction direction)
   {
     return common::ERR_INVALID;
   }
-  if (!m_neighbors[direction])
+  if (!neighbor_at(direction))
   {
     return common::ERR_FAIL;
   }
 
-  m_neighbors[direction].reset();
+  set_neighbor(direction, nullptr);
 
   return common::ERR_NONE;
 }
 
 building::Building *Tile::get_building() const
 {
-  building::Building *retval;
-  for (auto area : m_areas)
+  for (const auto &area : m_areas)
   {
-    if (area->get_building())
+    if (area.get_building())
     {
-      return area->get_building();
+      return area.get_building();
     }
   }
-  return retval;
+  return nullptr;
 }
 
-std::map<portable::Resource::Type, std::vector<portable::Resource *>>
+std::map<portable::Resource::Type, std::vector<portable::Resource>>
 Tile::get_all_resources() const
 {
-  std::map<portable::Resource::Type, std::vector<portable::Resource *>> result;
+  // Add the areas up in place first, so each list is allocated just once.
+  portable::Cache total;
   for (const auto &area : m_areas)
   {
-    auto area_res = area->get_resources();
-    for (auto res : area_res)
-    {
-      if (nullptr == res)
-      {
-        continue;
-      }
+    total += area.get_resource_cache();
+  }
 
-      portable::Resource::Type key = res->get_type();
-      if (!result.contains(key))
-      {
-        std::vector<portable::Resource *> list;
-        result.insert({key, list});
-      }
-      portable::Resource *copy = res;
-      result.at(key).push_back(copy);
+  std::map<portable::Resource::Type, std::vector<portable::Resource>> result;
+  for (const portable::Resource res : total.view())
+  {
+    std::vector<portable::Resource> &list = result[res.get_type()];
+    if (list.empty())
+    {
+      list.reserve(total.count(res.get_type()));
     }
+    list.push_back(res);
   }
   return result;
 }
@@ -425,10 +429,9 @@ bool Tile::has_road(const Border border)
   return get_area(border)->has_road(border);
 }
 
-bool Tile::has_river_point(const Direction direction)
+bool Tile::has_river_point(const Direction direction) const
 {
-  std::shared_ptr<River> r = get_river(direction);
-  return ((r) && (r->has_point(direction)));
+  return Tile_prototype::NO_SLOT != m_p_prototype->river_slot(direction);
 }
 
 bool Tile::has_wall() const
@@ -453,13 +456,29 @@ common::Error Tile::can_add_neighbor(std::shared_ptr<Tile> neighbor,
   {
     return common::ERR_INVALID;
   }
-  if ((!m_hex_set) || (m_neighbors[direction]) || (*this == *neighbor))
+  if ((!m_hex_set) || (neighbor_at(direction)))
   {
     return common::ERR_FAIL;
   }
-  for (uint8_t d = 0; d < MAX_DIRECTIONS; d++)
+  // Neither this tile nor one of its neighbors can be added, and neither can
+  // a copy of one. Copies keep the original's hex and links, so only a tile
+  // at the same hex needs its fingerprint checked before a full comparison.
+  auto is_copy_of = [&neighbor](const Tile &tile)
+  {
+    return (&tile == neighbor.get()) ||
+           ((neighbor->has_hex()) && (tile.has_hex()) &&
+            (tile.get_hex() == neighbor->get_hex()) &&
+            (tile.fingerprint() == neighbor->fingerprint()) &&
+            (tile == *neighbor));
+  };
+  if (is_copy_of(*this))
   {
-    if ((m_neighbors[d]) && (*(m_neighbors[d]) == *neighbor))
+    return common::ERR_FAIL;
+  }
+  for (Direction d : ALL_DIRECTIONS)
+  {
+    const Tile *other = neighbor_at(d);
+    if ((other) && (is_copy_of(*other)))
     {
       return common::ERR_FAIL;
     }
@@ -474,7 +493,8 @@ common::Error Tile::can_add_neighbor(std::shared_ptr<Tile> neighbor,
 
   // Check for river points on the borders. Each tile's border should match
   // (Sea tiles should skip this step).
-  if ((Terrain::sea == neighbor->m_terrain) || (Terrain::sea == m_terrain) ||
+  if ((Terrain::sea == neighbor->get_terrain()) ||
+      (Terrain::sea == get_terrain()) ||
       (has_river_point(direction) == neighbor->has_river_point(!direction)))
   {
     // From the neighbor's perspective, the matching side is the opposite
@@ -490,24 +510,22 @@ common::Error Tile::clear_neighbors()
 {
   for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
   {
-    if (m_neighbors[i])
+    Direction d = static_cast<Direction>(i);
+    Tile *neighbor = neighbor_at(d);
+    // Copies share their original's links without being linked back.
+    if ((neighbor) && (!get_handle().empty()) &&
+        (neighbor->m_neighbors[!d] == get_handle()))
     {
-      Direction d = static_cast<Direction>(i);
-      common::Error err = m_neighbors[i]->remove_neighbor(!d);
+      common::Error err = neighbor->remove_neighbor(!d);
       if (err)
       {
         // TODO: log out error from neighbor removing us.
         return common::ERR_FAIL;
       }
-      m_neighbors[i].reset();
-    }
-
-    // If we somehow fail to remove the neighbor, report error.
-    if (m_neighbors[i])
-    {
-      return common::ERR_FAIL;
     }
+    set_neighbor(d, nullptr);
   }
+  m_placeholders.clear();
   m_neighbors_are_current = true;
   return common::ERR_NONE;
 }
@@ -518,28 +536,21 @@ bool Tile::can_rotate() const
   {
     return false;
   }
-  for (auto neighbor : m_neighbors)
+  for (Direction d : ALL_DIRECTIONS)
   {
-    if (neighbor)
+    if (neighbor_at(d))
     {
       return false;
     }
   }
-  for (auto area : m_areas)
-  {
-    if (!area->can_rotate())
-    {
-      return false;
-    }
-  }
-  for (auto river : m_rivers)
+  for (const auto &area : m_areas)
   {
-    if (!river->can_rotate())
+    if (!area.can_rotate())
     {
       return false;
     }
   }
-  return true;
+  return m_bridges.empty();
 }
 
 common::Error Tile::rotate(int rotations)
@@ -550,30 +561,22 @@ common::Error Tile::rotate(int rotations)
   {
     // Making 0 rotations doesn't do anything...
     err = common::ERR_NONE;
-    if (0 != rotations)
+    const uint8_t steps = clockwise_steps(rotations);
+    if (0 != steps)
     {
-      bool is_clockwise = (0 < rotations);
-      rotations = abs(rotations) % MAX_DIRECTIONS;
-      rotations = (is_clockwise ? rotations : (MAX_DIRECTIONS - rotations));
-
-      for (auto river : m_rivers)
+      for (auto &area : m_areas)
       {
-        if (common::ERR_NONE != river->rotate(rotations))
-        {
-          // TODO: Log out error. This should never happen; we checked the
-          // rivers before rotating!
-          err = common::ERR_UNKNOWN;
-        }
-      }
-      for (auto area : m_areas)
-      {
-        if (common::ERR_NONE != area->rotate(rotations))
+        if (common::ERR_NONE != area.rotate(steps))
         {
           // TODO: Log out error. This should never happen; we checked the areas
           // before rotating!
           err = common::ERR_UNKNOWN;
         }
       }
+      // Areas keep their order, so the rotated shape's prototype already has
+      // their slots worked out, and carries the rotated rivers.
+      m_p_prototype = m_p_prototype->rotated(steps);
+      refresh_fingerprint();
     }
   }
   else
@@ -587,14 +590,15 @@ common::Error Tile::build_road(const Border border)
 {
   common::Error err = common::ERR_FAIL;
   Direction d = direction_from_border(border);
+  Tile *neighbor = neighbor_at(d);
   if ((m_neighbors_are_current) &&
-      ((nullptr != m_neighbors[d]) && (Terrain::sea != m_terrain) &&
-       (Terrain::sea != m_neighbors[d]->m_terrain)))
+      ((nullptr != neighbor) && (Terrain::sea != get_terrain()) &&
+       (Terrain::sea != neighbor->get_terrain())))
   {
     err = get_area(border)->build(border);
-    if ((!err) && (!m_neighbors[d]->has_road(!border)))
+    if ((!err) && (!neighbor->has_road(!border)))
     {
-      err = m_neighbors[d]->build_road(!border);
+      err = neighbor->build_road(!border);
     }
   }
   if (!err)
@@ -612,13 +616,16 @@ common::Error Tile::build_bridge(const Direction point)
   {
     return err;
   }
-  if (has_river_point(point))
+  std::optional<River> river = get_river(point);
+  if (river)
   {
-    err = get_river(point)->build(point);
+    err = river->build(point);
   }
   if (!err)
   {
+    m_bridges |= river->get_bridges();
     m_rot_locked = true;
+    refresh_fingerprint();
   }
   return err;
 }
@@ -628,7 +635,7 @@ bool Tile::can_build_wall(const Direction side, const player::Color color,
 {
   // If we don't have a neighbor to that side, the color of the wall is neutral,
   // or the thickness is 0, return false
-  if ((!m_neighbors[side]) || (player::Color::neutral == color))
+  if ((!neighbor_at(side)) || (player::Color::neutral == color))
   {
     return false;
   }
@@ -660,47 +667,45 @@ common::Error Tile::build_wall(const Direction side, const player::Color color,
   }
   m_walls[side].color = color;
   m_walls[side].thickness += thickness;
+  refresh_fingerprint();
   return common::ERR_NONE;
 }
 
-void Tile::split_by_rivers()
+void Tile::reshape()
 {
-  std::set<std::set<Border>> remaining_borders;
-  remaining_borders.insert(ALL_BORDERS);
-  for (auto r : m_rivers)
+  Tile_shape shape;
+  shape.terrain = get_terrain();
+  shape.river_count = m_p_prototype->shape().river_count;
+  for (uint8_t i = 0; i < shape.river_count; i++)
   {
-    std::vector<std::set<Border>> add;
-    std::vector<std::set<Border>> remove;
-
-    for (auto b : remaining_borders)
-    {
-      // Check to see if this river affects this set of borders.
-      if (r->splits_borders(b))
-      {
-        // It does, so we'll replace the old value with the new sets
-        remove.push_back(b);
-        std::vector<std::set<Border>> new_borders = r->get_area_borders(b);
-        add.insert(add.end(), new_borders.begin(), new_borders.end());
-      }
-    }
-
-    // Remove all border sets to be updated
-    for (auto rem : remove)
-    {
-      remaining_borders.erase(rem);
-    }
-    // Add updated border sets
-    for (auto a : add)
-    {
-      remaining_borders.insert(a);
-    }
+    shape.rivers[i] = m_p_prototype->shape().rivers[i];
   }
+  for (size_t i = 0; (i < m_areas.size()) && (i < MAX_BORDERS); i++)
+  {
+    shape.areas.push_back(m_areas[i].get_borders());
+  }
+  m_p_prototype = Tile_prototype::intern(shape);
+  refresh_fingerprint();
+}
 
-  // We've now defined each area's borders; make 'em.
-  for (auto borders : remaining_borders)
+void Tile::refresh_fingerprint()
+{
+  uint64_t retval = m_p_prototype->fingerprint();
+  for (uint8_t d = 0; d < MAX_DIRECTIONS; d++)
   {
-    m_areas.push_back(std::make_shared<Area>(borders, this));
+    // Tagged apart from rivers' and areas' fingerprints, like theirs are.
+    const uint64_t color = static_cast<uint8_t>(m_walls[d].color);
+    retval += mix_hash((uint64_t{3} << 56) | (uint64_t{d} << 16) |
+                       (color << 8) | m_walls[d].thickness);
   }
+  // Rivers are put together from the prototype in place, rather than through
+  // get_rivers(), which would allocate.
+  const Tile_shape &shape = m_p_prototype->shape();
+  for (uint8_t i = 0; i < shape.river_count; i++)
+  {
+    retval += River(shape.rivers[i], shape.rivers[i] & m_bridges).fingerprint();
+  }
+  m_fingerprint = retval;
 }
 
 std::ostream &operator<<(std::ostream &os, const tile::Tile &tile)
@@ -709,7 +714,7 @@ std::ostream &operator<<(std::ostream &os, const tile::Tile &tile)
      << ", hex_set=" << (tile.m_hex_set ? "true" : "false")
      << ", terrain=" << tile::to_string(tile.get_terrain())
      << ", rot_locked=" << (tile.is_rot_locked() ? "true" : "false")
-     << ", rivers=" << (tile.get_rivers().size())
+     << ", rivers=" << unsigned{tile.get_prototype()->shape().river_count}
      << ", areas=" << (tile.get_areas().size()) << ", neighbors_are_current="
      << (tile.m_neighbors_are_current ? "true" : "false");
   if (tile.has_wall())
@@ -729,27 +734,42 @@ std::ostream &operator<<(std::ostream &os, const tile::Tile &tile)
 
 void Tile::load_rivers_json(const nlohmann::json &j)
 {
-  m_rivers.clear();
-  if ((Terrain::sea == m_terrain) && (j.get<std::vector<River>>().size() != 0))
+  if ((Terrain::sea == get_terrain()) &&
+      (j.get<std::vector<River>>().size() != 0))
   {
-    reset();
+    abort_load();
     throw nlohmann::json::type_error::create(501, "Rivers listed for sea tile!",
                                              j);
   }
+  Direction_mask loaded;
+  std::vector<Direction_mask> rivers;
+  Direction_mask bridges;
   for (auto river : j.get<std::vector<River>>())
   {
+    if (river.get_points().empty())
+    {
+      abort_load();
+      throw nlohmann::json::type_error::create(
+          501, "River without any points in tile JSON!", j);
+    }
     for (auto point : river.get_points())
     {
-      if (has_river_point(point))
+      if (loaded.contains(point))
       {
-        reset();
+        abort_load();
         std::stringstream msg;
         msg << "Duplicate river point in tile JSON! point=" << point;
         throw nlohmann::json::type_error::create(501, msg.str(), j);
       }
     }
-    m_rivers.push_back(std::make_shared<River>(river));
+    loaded |= river.get_points();
+    rivers.push_back(river.get_points());
+    bridges |= river.get_bridges();
   }
+  m_p_prototype = Tile_prototype::fresh(get_terrain(), rivers);
+  m_bridges = bridges;
+  refresh_fingerprint();
+  // The tile's shape is only settled once its areas are loaded too.
 }
 
 void Tile::load_neighbors_json(const nlohmann::json &j)
@@ -766,58 +786,59 @@ void Tile::load_neighbors_json(const nlohmann::json &j)
     std::shared_ptr<Tile> neighbor = std::make_shared<Tile>(h);
     if (has_river_point(d))
     {
-      std::set<Direction> rp;
-      rp.insert(!d);
-      neighbor = std::make_shared<Tile>(h, rp);
+      neighbor = std::make_shared<Tile>(h, Direction_mask{!d});
     }
     common::Error err = add_neighbor(neighbor, d);
     if (common::ERR_NONE != err)
     {
-      reset();
+      abort_load();
       std::stringstream msg;
       msg << "Invalid neighbor value!";
       throw nlohmann::json::type_error::create(501, msg.str(), j);
     }
+    m_placeholders.push_back(neighbor);
   }
 }
 
 void Tile::load_areas_json(const nlohmann::json &j)
 {
   m_areas.clear();
-  split_by_rivers();
+  std::vector<Area> areas = j.get<std::vector<Area>>();
   // Validate that all areas are as expected based on the rivers/neighbors
-  for (auto area : j.get<std::vector<Area>>())
+  const Area_partition &partition = m_p_prototype->shape().areas;
+  Border_mask claimed;
+  for (const auto &area : areas)
   {
-    std::set<Border> borders = area.get_borders();
-    auto first_border = borders.begin();
-    std::shared_ptr<Area> matching_area = get_area(*first_border);
-    if ((*matching_area) != borders)
+    Border_mask borders = area.get_borders();
+    if ((partition.end() ==
+         std::find(partition.begin(), partition.end(), borders)) ||
+        (!(claimed & borders).empty()))
     {
-      reset();
+      abort_load();
       throw nlohmann::json::type_error::create(
           501, "Invalid area borders specified in tile JSON!", j);
     }
+    claimed |= borders;
+    // Roads can go on any of a freshly split area's borders.
     for (auto road : area.get_roads())
     {
-      if (!matching_area->can_build_road(road))
+      if (!borders.contains(road))
       {
-        reset();
+        abort_load();
         std::stringstream msg;
         msg << "Invalid area road specified in tile JSON! Road border=" << road;
         throw nlohmann::json::type_error::create(501, msg.str(), j);
       }
     }
   }
-  m_areas.clear();
-  for (auto area : j.get<std::vector<Area>>())
-  {
-    m_areas.push_back(std::make_shared<Area>(area));
-  }
+  m_areas = std::move(areas);
+  adopt_areas();
+  reshape();
 }
 
 void Tile::load_walls_json(const nlohmann::json &j)
 {
-  std::set<Direction> loaded_walls;
+  Direction_mask loaded_walls;
   for (auto wall : j.get<std::vector<nlohmann::json>>())
   {
     Direction d = wall.at("side").get<Direction>();
@@ -825,13 +846,13 @@ void Tile::load_walls_json(const nlohmann::json &j)
     uint8_t thickness = wall.at("thickness").get<uint8_t>();
     if ((Direction::invalid_direction == d) || loaded_walls.contains(d))
     {
-      reset();
+      abort_load();
       throw nlohmann::json::type_error::create(
           501, "Invalid side given for wall!", j);
     }
     if (player::Color::invalid == color)
     {
-      reset();
+      abort_load();
       throw nlohmann::json::type_error::create(
           501, "Invalid player color given as wall color!", j);
     }
@@ -841,7 +862,7 @@ void Tile::load_walls_json(const nlohmann::json &j)
       common::Error err = build_wall(d, color, thickness);
       if (common::ERR_NONE != err)
       {
-        reset();
+        abort_load();
         std::stringstream msg;
         msg << "Invalid wall specified! side=" << d << ", color=" << color
             << ", thickness=" << thickness;
@@ -852,6 +873,7 @@ void Tile::load_walls_json(const nlohmann::json &j)
     {
       m_walls[d].color = color;
       m_walls[d].thickness = thickness;
+      refresh_fingerprint();
     }
   }
 }
@@ -861,28 +883,30 @@ void to_json(nlohmann::json &j, const Tile &tile)
   nlohmann::json hex_json;
   to_json(hex_json, tile.m_hex);
   j["hex"] = hex_json;
-  j["terrain"] = to_string(tile.m_terrain);
+  j["terrain"] = to_string(tile.get_terrain());
   // Add immediate neighbor coordinates
+  j["neighbors"] = nlohmann::json::array();
   for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
   {
-    std::shared_ptr<Tile> neighbor = tile.m_neighbors[i];
-    if (neighbor)
+    if (tile.neighbor_at(static_cast<Direction>(i)))
     {
       j["neighbors"].push_back(to_string(static_cast<Direction>(i)));
     }
   }
 
-  for (auto river : tile.m_rivers)
+  j["rivers"] = nlohmann::json::array();
+  for (const auto &river : tile.get_rivers())
   {
     nlohmann::json river_json;
-    to_json(river_json, (*river));
+    to_json(river_json, river);
     j["rivers"].push_back(river_json);
   }
 
-  for (auto area : tile.m_areas)
+  j["areas"] = nlohmann::json::array();
+  for (const auto &area : tile.m_areas)
   {
     nlohmann::json area_json;
-    to_json(area_json, (*area));
+    to_json(area_json, area);
     j["areas"].push_back(area_json);
   }
 
@@ -904,16 +928,22 @@ void to_json(nlohmann::json &j, const Tile &tile)
   // loaded.
 }
 
+void Tile::load_fields_json(const nlohmann::json &j)
+{
+  m_hex = j.at("hex").get<Hex>();
+  m_p_prototype = Tile_prototype::fresh(j.at("terrain").get<Terrain>());
+  refresh_fingerprint();
+  m_hex_set = j.at("hex_set").get<bool>();
+  m_rot_locked = j.at("rot_locked").get<bool>();
+  load_rivers_json(j.at("rivers"));
+  load_areas_json(j.at("areas"));
+}
+
 void from_json(const nlohmann::json &j, Tile &tile)
 {
   tile = Tile();
-  tile.m_hex = j.at("hex").get<Hex>();
-  tile.m_terrain = j.at("terrain").get<Terrain>();
-  tile.m_hex_set = j.at("hex_set").get<bool>();
-  tile.m_rot_locked = j.at("rot_locked").get<bool>();
-  tile.load_rivers_json(j.at("rivers"));
+  tile.load_fields_json(j);
   tile.load_neighbors_json(j.at("neighbors"));
-  tile.load_areas_json(j.at("areas"));
   tile.load_walls_json(j.at("walls"));
 }
 } // namespace tile
\ No newline at end of file
@@ -5,7 +5,9 @@
 #include <fstream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <set>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -16,69 +18,43 @@
 #include <players/Player.h>
 #include <portables/resources/Resource.h>
 #include <portables/transporters/Transporter.h>
+#include <tiles/Tile_handle.h>
+#include <tiles/Tile_prototype.h>
 #include <tiles/components/Area.h>
 #include <tiles/components/Border.h>
 #include <tiles/components/Hex.h>
 #include <tiles/components/River.h>
+#include <tiles/components/Rotation.h>
+#include <tiles/components/Terrain.h>
+#include <tiles/components/Topology.h>
 
 namespace tile
 {
-enum Terrain
-{
-  invalid = -1,
-  desert = 0,
-  forest,
-  mountain,
-  plains,
-  rock,
-  sea
-};
-static const uint8_t MAX_TERRAIN_TYPES = 6;
-static const std::string TERRAIN_NAMES[MAX_TERRAIN_TYPES]{
-    "desert", "forest", "mountain", "plains", "rock", "sea"};
-NLOHMANN_JSON_SERIALIZE_ENUM(Terrain, {{invalid, nullptr},
-                                       {desert, TERRAIN_NAMES[desert]},
-                                       {forest, TERRAIN_NAMES[forest]},
-                                       {mountain, TERRAIN_NAMES[mountain]},
-                                       {plains, TERRAIN_NAMES[plains]},
-                                       {rock, TERRAIN_NAMES[rock]},
-                                       {sea, TERRAIN_NAMES[sea]}});
-static bool is_valid(const Terrain t)
-{
-  return ((0 <= t) && (MAX_TERRAIN_TYPES > t));
-}
-static const std::string to_string(const Terrain t)
-{
-  if (is_valid(t))
-  {
-    return TERRAIN_NAMES[t];
-  }
-  return "unknown";
-}
+class Tile_map;
+class Rotated_tile;
 
-class Tile
+class Tile : public std::enable_shared_from_this<Tile>
 {
 public:
   Tile(const Terrain t = Terrain::desert);
   Tile(const Hex hex, const Terrain t = Terrain::desert);
-  Tile(const std::set<Direction> river_points,
+  Tile(const Direction_mask river_points, const Terrain t = Terrain::desert);
+  Tile(const Hex hex, const Direction_mask river_points,
        const Terrain t = Terrain::desert);
-  Tile(const Hex hex, std::set<Direction> river_points,
+  Tile(const std::vector<Direction_mask> river_points,
        const Terrain t = Terrain::desert);
-  Tile(const std::vector<std::set<Direction>> river_points,
-       const Terrain t = Terrain::desert);
-  Tile(const Hex hex, const std::vector<std::set<Direction>> river_points,
+  Tile(const Hex hex, const std::vector<Direction_mask> river_points,
        const Terrain t = Terrain::desert);
   Tile(const Tile &other);
   ~Tile();
 
-  /// Initializes the Tile using the contructor's parameters, e.g.
-  /// dividing the tile into areas using the input rivers.
+  /// Initializes the Tile using the contructor's parameters, e.g. making the
+  /// rivers and areas its prototype lists.
   void init();
   /// Clears tile of all buildings/resources/neighbors.
   void reset();
 
-  inline Terrain get_terrain() const { return m_terrain; }
+  inline Terrain get_terrain() const { return m_p_prototype->terrain(); }
   inline Hex get_hex() const { return m_hex; }
   inline bool has_hex() const { return m_hex_set; }
   inline void set_hex(const Hex hp)
@@ -87,6 +63,7 @@ public:
     m_hex_set = true;
   }
   inline void clear_hex() { m_hex_set = false; }
+
   inline bool is_rot_locked() const { return m_rot_locked; }
   inline bool neighbors_are_current() const { return m_neighbors_are_current; }
   inline void set_neighbors_are_current(const bool status)
@@ -94,36 +71,29 @@ public:
     m_neighbors_are_current = status;
   }
 
-  /// Returns the river with a point at the input direction.
+  /// Returns the river with a point at the input direction. Rivers' points
+  /// come from the tile's prototype, and their bridges from the tile, so the
+  /// river is put together on the spot; build bridges with build_bridge.
   /// @param[in] d Direction to check for a river point.
-  /// @return A pointer to the river at the input direction. Null if no river
-  /// found with that point.
-  std::shared_ptr<River> get_river(const Direction d);
-  inline std::vector<std::shared_ptr<River>> get_rivers() { return m_rivers; }
-  inline std::vector<std::shared_ptr<River>> get_rivers() const
-  {
-    return m_rivers;
-  }
-  std::set<Direction> get_river_points() const;
-  std::set<Direction> get_bridges() const;
-  std::set<Direction> get_river_points(const Direction d);
+  /// @return The river at the input direction. Empty if no river found with
+  /// that point.
+  std::optional<River> get_river(const Direction d) const;
+  /// Returns every river of the tile, put together the same way.
+  std::vector<River> get_rivers() const;
+  Direction_mask get_river_points() const;
+  inline Direction_mask get_bridges() const { return m_bridges; }
+  Direction_mask get_river_points(const Direction d) const;
 
   /// Returns the area that uses the input border.
   /// @param[in] b Border that area is a part of.
   /// @return A pointer to the area with the input border. Null on invalid
   /// border input.
-  std::shared_ptr<Area> get_area(const Border b);
-  /// Returns all areas of the tile.
+  Area *get_area(const Border b);
+  const Area *get_area(const Border b) const;
+  /// Returns all areas of the tile, in the order its prototype lists them.
   /// @return all of the tile's areas.
-  inline std::vector<std::shared_ptr<Area>> get_areas() { return m_areas; }
-  inline std::vector<std::shared_ptr<Area>> get_areas() const
-  {
-    return m_areas;
-  }
-  /// Returns the areas associated with the input tile side.
-  /// @param[in] d side of the tile that areas are associated with.
-  /// @return areas associated with the input side.
-  std::vector<std::shared_ptr<Area>> get_areas(const Direction d);
+  inline std::span<Area> get_areas() { return m_areas; }
+  inline std::span<const Area> get_areas() const { return m_areas; }
 
   /// Gets the first adjacent tile in the input direction
   /// @param direction Side of the tile to check for a neighbor
@@ -131,7 +101,33 @@ public:
   ///   - pointer to the first adjacent tile
   ///   - nullptr if no tile is in the given direction
   std::shared_ptr<Tile> get_neighbor(const Direction direction);
-  std::shared_ptr<Tile> *get_neighbors();
+  std::shared_ptr<const Tile> get_neighbor(const Direction direction) const;
+
+  /// Same as get_neighbor, without taking a reference to the neighbor. Only
+  /// good for as long as the neighbor is alive.
+  /// @param direction Side of the tile to check for a neighbor
+  /// @return The neighbor. Null if no tile is in the given direction.
+  inline Tile *neighbor_at(const Direction direction)
+  {
+    return m_self.resolve(m_neighbors[direction]);
+  }
+  inline const Tile *neighbor_at(const Direction direction) const
+  {
+    return m_self.resolve(m_neighbors[direction]);
+  }
+
+  /// Returns the tile's own handle, for others to refer to it by. Empty until
+  /// the tile is first linked to a neighbor or placed on a map.
+  inline Tile_handle get_handle() const { return m_self.handle(); }
+
+  /// Returns the table the tile's links are resolved through
+  inline const std::shared_ptr<Tile_slots> &get_slots() const
+  {
+    return m_self.slots();
+  }
+
+  /// Returns the shape the tile shares with every other tile like it
+  inline const Tile_prototype *get_prototype() const { return m_p_prototype; }
 
   inline building::Wall get_wall(const Direction d) const
   {
@@ -149,13 +145,27 @@ public:
   ///   - pointer to the structure built on this tile
   ///   - nullptr if no structure has been built here
   building::Building *get_building() const;
-  std::map<portable::Resource::Type, std::vector<portable::Resource *>>
+  std::map<portable::Resource::Type, std::vector<portable::Resource>>
   get_all_resources() const;
 
-  bool has_river_point(const Direction direction);
+  bool has_river_point(const Direction direction) const;
   bool has_road(const Border border);
   bool has_wall() const;
-  bool is_shore() const;
+
+  /// Returns the sides of the tile that border a sea tile. Kept up to date as
+  /// neighbors are linked and unlinked, so no neighbor is looked at.
+  inline Direction_mask get_sea_sides() const { return m_sea_sides; }
+  /// Returns the river points that run out into a neighboring sea tile.
+  inline Direction_mask get_river_mouths() const
+  {
+    return m_sea_sides & m_p_prototype->river_points();
+  }
+  /// Checks whether the tile is a land tile with a river or a sea neighbor.
+  inline bool is_shore() const
+  {
+    return (Terrain::sea != get_terrain()) &&
+           ((!m_p_prototype->river_points().empty()) || (is_neighboring_sea()));
+  }
 
   /// Checks whether neighbor can be placed at the direction relative to the
   /// tile.
@@ -217,6 +227,13 @@ public:
   ///   - common::ERR_UNKNOWN otherwise
   common::Error rotate(int rotations);
 
+  /// Looks at the tile as if it were rotated, without changing or copying it.
+  /// Lets callers try out orientations before committing to one with rotate.
+  /// @param[in] rotations The number of clockwise rotations. A negative value
+  /// rotates counter-clockwise.
+  /// @return View of the rotated tile, good for as long as the tile is
+  inline Rotated_tile rotated_view(const int rotations) const;
+
   /// Builds a road on the input border if possible.
   /// @param[in] border border to build a road on.
   /// @return
@@ -227,8 +244,7 @@ public:
 
   /// Template of a check to see if the building can be built on this tile.
   /// @param[in] area  Area to construct the building in
-  template <class B>
-  bool can_build_building(const std::shared_ptr<Area> &area) const
+  template <class B> bool can_build_building(Area *area) const
   {
     return ((nullptr == get_building()) && (nullptr != area) &&
             (area->can_build<B>()));
@@ -241,8 +257,7 @@ public:
   ///   - commmon::ERR_INVALID if area is invalid value, or bldg type is
   ///   invalid.
   ///   - common::ERR_FAIL otherwise
-  template <class Bldg>
-  common::Error build_building(const std::shared_ptr<Area> &area)
+  template <class Bldg> common::Error build_building(Area *area)
   {
     common::Error err = common::ERR_FAIL;
     // Don't allow buildings before having a hex point, all the neighbors'
@@ -295,32 +310,122 @@ public:
 
   // Helpers
   Tile operator=(const Tile &other);
-  bool operator==(Tile &other) const;
   bool operator==(Tile const &other) const;
-  bool operator!=(Tile &other) const;
   bool operator!=(Tile const &other) const;
 
+  /// Returns a 64-bit fingerprint of the tile's structure: its shape, roads,
+  /// bridges, buildings and walls. Equal tiles always have equal fingerprints,
+  /// so differing fingerprints rule out equality without a full comparison.
+  /// Neither the tile's position nor its neighbors are part of it.
+  uint64_t fingerprint() const;
+
   friend std::ostream &operator<<(std::ostream &os, const tile::Tile &tile);
   friend void to_json(nlohmann::json &j, const Tile &tile);
   friend void from_json(const nlohmann::json &j, Tile &tile);
+  friend class Tile_map;
+  friend class Rotated_tile;
+  friend void from_json(const nlohmann::json &j, Tile_map &map);
 
 protected:
 private:
-  /// Divides areas based on where all river points are.
-  void split_by_rivers();
+  /// Links the neighbor in the input direction without any placement checks.
+  /// Only for callers that have already validated the placement themselves
+  /// (Tile_map's batch insert).
+  /// @param[in] neighbor
+  /// @param[in] direction
+  inline void link_neighbor(const Tile &neighbor, const Direction direction)
+  {
+    set_neighbor(direction, &neighbor);
+    m_rot_locked = true;
+  }
 
-  bool is_neighboring_sea() const;
+  /// Points the input side at the neighbor, and updates the sea sides to
+  /// match. Every change to the tile's neighbors goes through here. The
+  /// neighbor must already have a slot in the tile's table.
+  /// @param[in] direction
+  /// @param[in] neighbor Tile to link. Null to unlink the side.
+  inline void set_neighbor(const Direction direction, const Tile *neighbor)
+  {
+    m_neighbors[direction] = neighbor ? neighbor->get_handle() : Tile_handle();
+    if ((neighbor) && (Terrain::sea == neighbor->get_terrain()))
+    {
+      m_sea_sides.insert(direction);
+    }
+    else
+    {
+      m_sea_sides.erase(direction);
+    }
+  }
+
+  /// Gives the tile a slot in the input table. A tile only links to tiles in
+  /// its own table, so moving to another table drops its links first. The
+  /// tile's resources follow the phase clock of the table's game.
+  /// @param[in] slots
+  void join(const std::shared_ptr<Tile_slots> &slots);
+
+  /// Drops the tile's own links and gives back its slot, once it's been taken
+  /// off a map. Neighbors are left for the map to unlink, and the tile's
+  /// resources are detached from the map's phase clock.
+  void leave_slots();
+
+  /// Attaches the resources in each of the tile's areas to a phase clock. The
+  /// clock isn't owned; the tile's table keeps it alive.
+  /// @param[in] clock
+  void set_phase_clock(const portable::Phase_clock *clock);
+
+  /// Points the tile at the prototype matching its terrain, its prototype's
+  /// rivers and its areas. Must be called whenever the areas are swapped out.
+  void reshape();
+
+  /// Resets the tile after a failed load, and reshapes it from what's left.
+  void abort_load();
+
+  /// Points each area back at the tile, after the areas were copied over.
+  void adopt_areas();
 
+  /// Recomputes the tile's own part of its fingerprint. Must be called
+  /// whenever the tile's prototype, bridges or walls change.
+  void refresh_fingerprint();
+
+  inline bool is_neighboring_sea() const { return !m_sea_sides.empty(); }
+
+  /// Loads the tile's own fields from JSON: everything but its neighbors and
+  /// walls, which depend on the neighbors being linked first.
+  /// @param[in] j Tile JSON
+  void load_fields_json(const nlohmann::json &j);
   void load_rivers_json(const nlohmann::json &j);
   void load_neighbors_json(const nlohmann::json &j);
   void load_areas_json(const nlohmann::json &j);
   void load_walls_json(const nlohmann::json &j);
 
+  // The tile's slot in its Tile_slots table; neighbors link to it by handle,
+  // and its own links are resolved through the same table.
+  Tile_slot m_self;
   Hex m_hex;
-  Terrain m_terrain;
-  std::shared_ptr<Tile> m_neighbors[MAX_DIRECTIONS];
-  std::vector<std::shared_ptr<River>> m_rivers;
-  std::vector<std::shared_ptr<Area>> m_areas;
+  // Terrain, river and area layout, and the lookups into both. Shared with
+  // every other tile of the same shape.
+  const Tile_prototype *m_p_prototype;
+  // Fingerprint of the prototype, rivers and walls. Areas fold in their own,
+  // since they can be changed without going through the tile.
+  uint64_t m_fingerprint;
+  // Neighbors don't own each other; whoever placed them (usually the map)
+  // does. Links to a destroyed neighbor read as null.
+  Tile_handle m_neighbors[MAX_DIRECTIONS];
+  // Sides whose neighbor is a sea tile.
+  Direction_mask m_sea_sides;
+  // Stamp of the Tile_map that has the tile to itself, rather than sharing it
+  // with a fork. Zero for tiles of no map, and for copies.
+  uint32_t m_owner = 0;
+  // Blank stand-ins for the neighbors listed in a lone tile's JSON, owned
+  // here since nothing else holds them.
+  std::vector<std::shared_ptr<Tile>> m_placeholders;
+  // What's built and left in each of the prototype's areas. The layout itself
+  // (each area's borders and which area holds each border) is the
+  // prototype's; areas keep a copy of their borders only so they can stand
+  // on their own.
+  std::vector<Area> m_areas;
+  // Bridges over the prototype's rivers.
+  Direction_mask m_bridges;
   building::Wall m_walls[MAX_DIRECTIONS];
   // Flag to prevent tile from rotating after placed in a map.
   bool m_rot_locked;
@@ -334,6 +439,72 @@ private:
   // fields.
   bool m_neighbors_are_current;
 };
+
+/// Read-only look at a tile turned some clockwise steps. Every lookup maps
+/// back onto the tile through the rotation tables, so nothing is copied.
+class Rotated_tile
+{
+public:
+  Rotated_tile(const Tile &tile, const uint8_t steps)
+      : m_tile(tile), m_steps(steps), m_undo(clockwise_steps(-steps))
+  {
+  }
+
+  inline const Tile &get_tile() const { return m_tile; }
+  inline uint8_t get_steps() const { return m_steps; }
+  inline Terrain get_terrain() const { return m_tile.get_terrain(); }
+
+  inline Direction_mask get_river_points() const
+  {
+    return rotated(m_tile.get_river_points(), m_steps);
+  }
+  inline bool has_river_point(const Direction d) const
+  {
+    return m_tile.has_river_point(rotated(d, m_undo));
+  }
+
+  /// Returns the area that would use the input border.
+  /// @param[in] b Border of the rotated tile
+  /// @return The tile's area, unrotated. Null on invalid border input.
+  inline const Area *get_area(const Border b) const
+  {
+    const uint8_t slot = m_tile.m_p_prototype->area_slot(rotated(b, m_undo));
+    return (Tile_prototype::NO_SLOT != slot) ? &m_tile.m_areas[slot] : nullptr;
+  }
+  /// Returns the borders the area at the input border would have.
+  /// @param[in] b Border of the rotated tile
+  /// @return The rotated area's borders. Empty on invalid border input.
+  inline Border_mask get_area_borders(const Border b) const
+  {
+    const Area *area = get_area(b);
+    return area ? rotated(area->get_borders(), m_steps) : Border_mask();
+  }
+
+  /// Checks whether the rotated tile's river points line up with the input
+  /// neighbor, using the same rule as Tile::can_add_neighbor.
+  /// @param[in] neighbor Tile that would sit next to the rotated tile
+  /// @param[in] direction Side of the rotated tile the neighbor would be on
+  /// @return true if the river points agree, or either tile is sea.
+  inline bool fits(const Tile &neighbor, const Direction direction) const
+  {
+    return (is_valid(direction)) &&
+           ((Terrain::sea == neighbor.get_terrain()) ||
+            (Terrain::sea == get_terrain()) ||
+            (has_river_point(direction) ==
+             neighbor.has_river_point(!direction)));
+  }
+
+private:
+  const Tile &m_tile;
+  uint8_t m_steps;
+  // Steps that turn the view back into the tile's own orientation.
+  uint8_t m_undo;
+};
+
+inline Rotated_tile Tile::rotated_view(const int rotations) const
+{
+  return Rotated_tile(*this, clockwise_steps(rotations));
+}
 } // namespace tile
 
 #endif // end Tile_H
\ No newline at end of file
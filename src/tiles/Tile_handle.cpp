@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include <tiles/Tile_handle.h>
+
+namespace tile
+{
+Tile_handle Tile_slots::acquire(Tile *tile)
+{
+  std::lock_guard<std::mutex> guard(m_lock);
+  uint32_t index = 0;
+  if (!m_free.empty())
+  {
+    index = m_free.front();
+    m_free.pop_front();
+  }
+  else
+  {
+    if (m_next > Tile_handle::INDEX_MASK)
+    {
+      throw std::length_error("Too many tiles in one table!");
+    }
+    index = m_next;
+    // Segments are only ever added, and never move once they're made.
+    if ((index >> SEGMENT_BITS) == m_segments.size())
+    {
+      add_segment();
+    }
+    m_next++;
+  }
+
+  Slot &slot = m_segments[index >> SEGMENT_BITS][index & SEGMENT_MASK];
+  slot.tile.store(tile, std::memory_order_release);
+  return Tile_handle(index, slot.generation.load(std::memory_order_relaxed));
+}
+
+void Tile_slots::add_segment()
+{
+  const uint32_t segment = static_cast<uint32_t>(m_segments.size());
+  m_segments.push_back(std::make_unique<Slot[]>(SEGMENT_SIZE));
+  if (segment == m_directory_size)
+  {
+    const uint32_t size = std::max<uint32_t>(4, 2 * m_directory_size);
+    std::unique_ptr<Slot *[]> directory = std::make_unique<Slot *[]>(size);
+    if (!m_directories.empty())
+    {
+      std::copy_n(m_directories.back().get(), segment, directory.get());
+    }
+    m_directories.push_back(std::move(directory));
+    m_directory_size = size;
+  }
+  // Readers only go as far as the segment count, so the new entry is set
+  // before the count is raised.
+  m_directories.back()[segment] = m_segments.back().get();
+  m_directory.store(m_directories.back().get(), std::memory_order_release);
+  m_segment_count.store(segment + 1, std::memory_order_release);
+}
+
+void Tile_slots::release(const Tile_handle handle)
+{
+  if (handle.empty())
+  {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(m_lock);
+  Slot &slot =
+      m_segments[handle.index() >> SEGMENT_BITS][handle.index() & SEGMENT_MASK];
+  slot.tile.store(nullptr, std::memory_order_release);
+  // Once the generation runs out, reusing the slot could bring old handles
+  // back to life; the slot is retired instead.
+  const uint32_t generation = slot.generation.load(std::memory_order_relaxed);
+  if (Tile_handle::GENERATION_MASK != generation)
+  {
+    slot.generation.store(generation + 1, std::memory_order_release);
+    m_free.push_back(handle.index());
+  }
+}
+} // namespace tile
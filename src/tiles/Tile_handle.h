@@ -0,0 +1,216 @@
+#ifndef TILE_HANDLE_H
+#define TILE_HANDLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace portable
+{
+class Phase_clock;
+}
+
+namespace tile
+{
+class Tile;
+
+/// 4-byte, non-owning reference to a tile: the index of the tile's slot in a
+/// Tile_slots table, plus the slot's generation when the handle was made.
+/// Slots are reused under a new generation once their tile is gone, so a
+/// handle outliving its tile resolves to null instead of dangling.
+class Tile_handle
+{
+public:
+  static constexpr uint32_t INDEX_BITS = 20;
+  static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+  static constexpr uint32_t GENERATION_MASK = (1u << (32 - INDEX_BITS)) - 1;
+
+  constexpr Tile_handle() : m_value(0) {}
+  constexpr Tile_handle(const uint32_t index, const uint32_t generation)
+      : m_value(((generation & GENERATION_MASK) << INDEX_BITS) |
+                (index & INDEX_MASK))
+  {
+  }
+
+  constexpr uint32_t index() const { return m_value & INDEX_MASK; }
+  constexpr uint32_t generation() const { return m_value >> INDEX_BITS; }
+
+  /// Returns whether the handle was never pointed at a tile
+  constexpr bool empty() const { return 0 == m_value; }
+
+  constexpr bool operator==(const Tile_handle &other) const = default;
+
+private:
+  uint32_t m_value;
+};
+
+static_assert(4 == sizeof(Tile_handle));
+
+/// Table of the tiles linked to each other. A Tile_map and its forks share
+/// one, and tiles placed on them resolve their neighbors' handles through it
+/// (a fork's copy of a tile takes a slot of its own); tiles linked outside of
+/// any map share a table of their own. Slots live in
+/// fixed-size segments that never move, so handles are resolved without
+/// locking. Only taking and giving back slots locks, and only this table.
+///
+/// A map's table also keeps its game's phase clock alive, as the caches of
+/// the tiles in it point at the clock without owning it.
+class Tile_slots
+{
+public:
+  Tile_slots() = default;
+  /// @param[in] clock  Phase clock of the game the table's tiles are in
+  explicit Tile_slots(std::shared_ptr<const portable::Phase_clock> clock)
+      : m_p_clock(std::move(clock))
+  {
+  }
+  Tile_slots(const Tile_slots &other) = delete;
+  Tile_slots &operator=(const Tile_slots &other) = delete;
+
+  /// Returns the phase clock of the game the table's tiles are in. Null for
+  /// tiles linked outside of any map.
+  inline const portable::Phase_clock *clock() const { return m_p_clock.get(); }
+
+  /// Takes a slot for the input tile. Slots given back the longest ago are
+  /// reused first.
+  /// @param[in] tile
+  /// @return Handle to the tile
+  /// @throw std::length_error if every slot a handle can index is taken
+  Tile_handle acquire(Tile *tile);
+
+  /// Gives back the slot of the input handle, leaving any copies of the handle
+  /// stale. A slot whose generation has run out is retired rather than reused.
+  /// @param[in] handle
+  void release(const Tile_handle handle);
+
+  /// Returns the tile the input handle refers to
+  /// @param[in] handle
+  /// @return The tile. Null if the handle is empty or the tile is gone.
+  inline Tile *resolve(const Tile_handle handle) const
+  {
+    const uint32_t index = handle.index();
+    const uint32_t segment = index >> SEGMENT_BITS;
+    if ((0 == index) ||
+        (segment >= m_segment_count.load(std::memory_order_acquire)))
+    {
+      return nullptr;
+    }
+    const Slot &slot = m_directory.load(
+        std::memory_order_acquire)[segment][index & SEGMENT_MASK];
+    // A slot given back and taken again while it's read shows up as a change
+    // of generation.
+    const uint32_t generation = handle.generation();
+    if (slot.generation.load(std::memory_order_acquire) != generation)
+    {
+      return nullptr;
+    }
+    Tile *tile = slot.tile.load(std::memory_order_acquire);
+    return (slot.generation.load(std::memory_order_acquire) == generation)
+               ? tile
+               : nullptr;
+  }
+
+private:
+  struct Slot
+  {
+    std::atomic<Tile *> tile = nullptr;
+    std::atomic<uint32_t> generation = 0;
+  };
+
+  static constexpr uint32_t SEGMENT_BITS = 8;
+  static constexpr uint32_t SEGMENT_SIZE = 1u << SEGMENT_BITS;
+  static constexpr uint32_t SEGMENT_MASK = SEGMENT_SIZE - 1;
+
+  /// Adds a segment of slots, and makes it visible to readers. Only called
+  /// with the table locked.
+  void add_segment();
+
+  // Segments are found through a directory, which is copied to a bigger one
+  // as segments are added. Old directories are kept until the table goes, as
+  // handles may still be resolved through them.
+  std::vector<std::unique_ptr<Slot[]>> m_segments;
+  std::vector<std::unique_ptr<Slot *[]>> m_directories;
+  std::atomic<Slot *const *> m_directory = nullptr;
+  std::atomic<uint32_t> m_segment_count = 0;
+  uint32_t m_directory_size = 0;
+  std::deque<uint32_t> m_free;
+  // Slot 0 is never handed out, so no live tile has an empty handle.
+  uint32_t m_next = 1;
+  std::mutex m_lock;
+  std::shared_ptr<const portable::Phase_clock> m_p_clock;
+};
+
+/// A tile's slot in a Tile_slots table. Tiles start out without one, and
+/// take one when they're first linked to a neighbor or placed on a map. The
+/// slot is given back when the tile is destroyed or joins another table.
+class Tile_slot
+{
+public:
+  Tile_slot() = default;
+  Tile_slot(const Tile_slot &other) = delete;
+  Tile_slot &operator=(const Tile_slot &other) = delete;
+  ~Tile_slot() { leave(); }
+
+  inline Tile_handle handle() const { return m_handle; }
+  inline const std::shared_ptr<Tile_slots> &slots() const { return m_p_slots; }
+
+  /// Returns whether the tile has a slot in the input table
+  inline bool is_in(const std::shared_ptr<Tile_slots> &slots) const
+  {
+    return (!m_handle.empty()) && (m_p_slots == slots);
+  }
+
+  /// Takes a slot in the input table for the tile, giving back any slot it
+  /// had in another table.
+  /// @param[in] tile Tile the slot belongs to
+  /// @param[in] slots
+  void join(Tile *tile, std::shared_ptr<Tile_slots> slots)
+  {
+    if (is_in(slots))
+    {
+      return;
+    }
+    leave();
+    m_p_slots = std::move(slots);
+    m_handle = m_p_slots->acquire(tile);
+  }
+
+  /// Resolves handles through the other slot's table, without a slot of its
+  /// own there; for copies of a tile, which keep its links.
+  /// @param[in] other
+  void share_table(const Tile_slot &other)
+  {
+    leave();
+    m_p_slots = other.m_p_slots;
+  }
+
+  /// Gives back the tile's slot, if it has one
+  void leave()
+  {
+    if (!m_handle.empty())
+    {
+      m_p_slots->release(m_handle);
+    }
+    m_p_slots.reset();
+    m_handle = Tile_handle();
+  }
+
+  /// Returns the tile the input handle refers to in the tile's table
+  /// @param[in] handle
+  /// @return The tile. Null if the tile has no table, or the handle is stale.
+  inline Tile *resolve(const Tile_handle handle) const
+  {
+    return m_p_slots ? m_p_slots->resolve(handle) : nullptr;
+  }
+
+private:
+  std::shared_ptr<Tile_slots> m_p_slots;
+  Tile_handle m_handle;
+};
+} // namespace tile
+
+#endif
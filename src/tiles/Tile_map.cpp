@@ -1,35 +1,209 @@
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <sstream>
+#include <unordered_set>
+#include <utility>
+
 #include <nlohmann/json.hpp>
 #include <stduuid/include/uuid.h>
 
 #include <common/Errors.h>
 #include <tiles/Tile.h>
 #include <tiles/Tile_map.h>
+#include <utils/parallel_utils.h>
 
 namespace tile
 {
-Tile_map::Tile_map() : m_p_locked(false) {}
+Tile_map::Tile_map()
+    : m_p_map(std::make_shared<Storage>()),
+      m_p_clock(std::make_shared<portable::Phase_clock>()),
+      m_p_slots(std::make_shared<Tile_slots>(m_p_clock)),
+      m_p_owner(next_owner()), m_p_forked(false), m_p_fork_pending(false),
+      m_p_locked(false), m_p_dangling_count(0)
+{
+}
 
 Tile_map::Tile_map(const Tile_map &other)
-    : m_p_map(m_p_map), m_p_locked(other.m_p_locked)
+    : m_p_map(other.m_p_map), m_p_clock(other.m_p_clock),
+      m_p_slots(other.m_p_slots), m_p_owner(next_owner()), m_p_forked(true),
+      m_p_fork_pending(false), m_p_locked(other.m_p_locked),
+      m_p_compiled(other.m_p_compiled), m_p_dangling(other.m_p_dangling),
+      m_p_dangling_count(other.m_p_dangling_count)
 {
+  // The other map's tiles are ours too now, so it may no longer change them
+  // in place either. It takes a new stamp itself before its next change.
+  other.m_p_fork_pending.store(true, std::memory_order_relaxed);
 }
 
-Tile_map::~Tile_map() { reset(); }
+Tile_map::~Tile_map() {}
 
-Tile_map Tile_map::operator=(const Tile_map &other)
+Tile_map &Tile_map::operator=(const Tile_map &other)
 {
-  m_p_locked = other.m_p_locked;
-  m_p_map.clear();
   m_p_map = other.m_p_map;
+  m_p_clock = other.m_p_clock;
+  m_p_slots = other.m_p_slots;
+  m_p_owner = next_owner();
+  m_p_forked = true;
+  m_p_fork_pending.store(false, std::memory_order_relaxed);
+  other.m_p_fork_pending.store(true, std::memory_order_relaxed);
+  m_p_locked = other.m_p_locked;
+  m_p_compiled = other.m_p_compiled;
+  m_p_dangling = other.m_p_dangling;
+  m_p_dangling_count = other.m_p_dangling_count;
   return (*this);
 }
 
+uint32_t Tile_map::next_owner()
+{
+  static std::atomic<uint32_t> stamps(0);
+  return ++stamps;
+}
+
+void Tile_map::detach()
+{
+  if ((m_p_fork_pending.load(std::memory_order_relaxed)) &&
+      (m_p_fork_pending.exchange(false, std::memory_order_relaxed)))
+  {
+    m_p_owner = next_owner();
+    m_p_forked = true;
+  }
+  if (is_shared())
+  {
+    m_p_map = std::make_shared<Storage>(*m_p_map);
+  }
+}
+
+void Tile_map::own(const Hex coord)
+{
+  if (!m_p_forked)
+  {
+    return;
+  }
+  const Storage &stored = *m_p_map;
+  const std::shared_ptr<Tile> *found = stored.find(coord);
+  if ((nullptr == found) || (m_p_owner == (*found)->m_owner))
+  {
+    return;
+  }
+
+  // The copy keeps the shared tile's links, which lead to the tiles as they
+  // were at the fork; the map's own tiles among them are relinked both ways.
+  std::shared_ptr<Tile> copy = std::make_shared<Tile>(**found);
+  copy->join(m_p_slots);
+  copy->m_owner = m_p_owner;
+  for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
+  {
+    Direction d = static_cast<Direction>(i);
+    const std::shared_ptr<Tile> *other = stored.find(coord.neighbor(d));
+    if ((nullptr != other) && (m_p_owner == (*other)->m_owner))
+    {
+      copy->link_neighbor(**other, d);
+      (*other)->link_neighbor(*copy, !d);
+    }
+  }
+
+  if (m_p_compiled)
+  {
+    if (m_p_compiled.use_count() > 1)
+    {
+      m_p_compiled = std::make_shared<Compiled_map>(*m_p_compiled);
+    }
+    m_p_compiled->tiles[m_p_compiled->index_of(coord)] = copy.get();
+  }
+  *m_p_map->find(coord) = std::move(copy);
+}
+
+void Tile_map::own_around(const Hex coord)
+{
+  if (((!m_p_forked) && (!m_p_fork_pending.load(std::memory_order_relaxed))) ||
+      (!m_p_map->contains(coord)))
+  {
+    return;
+  }
+  detach();
+  own(coord);
+  for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
+  {
+    own(coord.neighbor(static_cast<Direction>(i)));
+  }
+}
+
+void Tile_map::set_lock(const bool lock_status)
+{
+  m_p_locked = lock_status;
+  if (m_p_locked)
+  {
+    compile();
+  }
+  else
+  {
+    m_p_compiled.reset();
+  }
+}
+
+void Tile_map::compile()
+{
+  std::unique_ptr<Compiled_map> compiled = std::make_unique<Compiled_map>();
+  size_t count = m_p_map->size();
+  compiled->hexes.reserve(count);
+  compiled->tiles.reserve(count);
+  compiled->terrain.reserve(count);
+  compiled->river_mask.reserve(count);
+  compiled->sea_sides.reserve(count);
+  compiled->shore.reserve(count);
+
+  // First pass hands out dense indices and gathers per-tile data.
+  std::as_const(*m_p_map).for_each(
+      [&compiled](const Hex &coord, const std::shared_ptr<Tile> &tile)
+      {
+        int32_t idx = static_cast<int32_t>(compiled->hexes.size());
+        compiled->indices.insert(coord, idx);
+        compiled->hexes.push_back(coord);
+        compiled->tiles.push_back(tile.get());
+        compiled->terrain.push_back(tile->get_terrain());
+        compiled->river_mask.push_back(tile->get_river_points().bits());
+        compiled->sea_sides.push_back(tile->get_sea_sides().bits());
+        compiled->shore.push_back(tile->is_shore());
+      });
+
+  // Second pass resolves each tile's neighbors to their dense indices.
+  compiled->neighbors.resize(count);
+  for (size_t i = 0; i < count; i++)
+  {
+    for (uint8_t d = 0; d < MAX_DIRECTIONS; d++)
+    {
+      compiled->neighbors[i][d] = compiled->index_of(
+          compiled->hexes[i].neighbor(static_cast<Direction>(d)));
+    }
+  }
+
+  m_p_compiled = std::move(compiled);
+}
+
 common::Error Tile_map::get_tile(const Hex coord, std::shared_ptr<Tile> &tile)
 {
   tile.reset();
-  if (m_p_map.contains(coord))
+  // Changes to the tile can reach its neighbors, like roads do.
+  own_around(coord);
+  std::shared_ptr<Tile> *found = m_p_map->find(coord);
+  if (nullptr != found)
+  {
+    tile = *found;
+    return common::ERR_NONE;
+  }
+
+  return common::ERR_FAIL;
+}
+
+common::Error Tile_map::get_tile(const Hex coord,
+                                 std::shared_ptr<const Tile> &tile) const
+{
+  tile.reset();
+  const std::shared_ptr<Tile> *found = std::as_const(*m_p_map).find(coord);
+  if (nullptr != found)
   {
-    tile = m_p_map.at(coord);
+    tile = *found;
     return common::ERR_NONE;
   }
 
@@ -44,37 +218,59 @@ common::Error Tile_map::insert(const Hex coord,
     return common::ERR_INVALID;
   }
 
-  if ((m_p_locked) || (m_p_map.contains(coord)))
+  if ((m_p_locked) || (m_p_map->contains(coord)))
   {
     return common::ERR_FAIL;
   }
 
+  const Storage &stored = *m_p_map;
   for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
   {
     Direction d = static_cast<Direction>(i);
-    Hex other_coord = coord.neighbor(d);
-    if (!m_p_map.contains(other_coord))
+    const std::shared_ptr<Tile> *other = stored.find(coord.neighbor(d));
+    if (nullptr == other)
     {
       continue;
     }
 
-    common::Error add_err = m_p_map.at(other_coord)->can_add_neighbor(tile, !d);
+    common::Error add_err = (*other)->can_add_neighbor(tile, !d);
     if (add_err)
     {
       return common::ERR_FAIL;
     }
+    // The tile's side of the link has to be free too, as nothing is undone
+    // once the neighbors are owned.
+    if (tile->neighbor_at(d))
+    {
+      return common::ERR_FAIL;
+    }
+    for (Direction side : ALL_DIRECTIONS)
+    {
+      if (tile->neighbor_at(side) == other->get())
+      {
+        return common::ERR_FAIL;
+      }
+    }
   }
 
-  m_p_map.insert({coord, tile});
-  m_p_map.at(coord)->set_hex(coord);
+  // The neighbors are linked to the new tile, so they have to be our own.
+  detach();
+  for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
+  {
+    own(coord.neighbor(static_cast<Direction>(i)));
+  }
+  m_p_map->insert(coord, tile);
+  tile->set_hex(coord);
+  tile->join(m_p_slots);
+  tile->m_owner = m_p_owner;
 
   for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
   {
     Direction d = static_cast<Direction>(i);
-    Hex other_coord = coord.neighbor(d);
-    if (m_p_map.contains(other_coord))
+    std::shared_ptr<Tile> *found = m_p_map->find(coord.neighbor(d));
+    if (nullptr != found)
     {
-      std::shared_ptr<Tile> other = m_p_map.at(other_coord);
+      std::shared_ptr<Tile> other = *found;
       common::Error self_err = tile->add_neighbor(other, d);
       common::Error other_err = other->add_neighbor(tile, !d);
       if ((self_err) || (other_err))
@@ -85,23 +281,160 @@ common::Error Tile_map::insert(const Hex coord,
       }
     }
   }
+  track_river_points(coord, tile, true);
+  return common::ERR_NONE;
+}
+
+common::Error Tile_map::insert_many(
+    std::span<const std::pair<Hex, std::shared_ptr<Tile>>> tiles)
+{
+  if (m_p_locked)
+  {
+    return common::ERR_FAIL;
+  }
+
+  // Index the batch by coordinates so the tiles can find each other, and make
+  // sure no spot or tile is used twice.
+  Chunked_store<uint32_t> batch;
+  std::unordered_set<const Tile *> seen;
+  seen.reserve(tiles.size());
+  for (uint32_t i = 0; i < tiles.size(); i++)
+  {
+    const Hex &coord = tiles[i].first;
+    const std::shared_ptr<Tile> &tile = tiles[i].second;
+    if (!tile)
+    {
+      return common::ERR_INVALID;
+    }
+    if ((m_p_map->contains(coord)) || (!batch.insert(coord, i)) ||
+        (!seen.insert(tile.get()).second))
+    {
+      return common::ERR_FAIL;
+    }
+    // The tile may not already be placed on this map.
+    if (tile->has_hex())
+    {
+      const std::shared_ptr<Tile> *placed =
+          std::as_const(*m_p_map).find(tile->get_hex());
+      if ((nullptr != placed) && (*placed == tile))
+      {
+        return common::ERR_FAIL;
+      }
+    }
+  }
+
+  // Validate every shared edge, whether it's with another tile in the batch
+  // or one already on the map.
+  for (const auto &[coord, tile] : tiles)
+  {
+    for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
+    {
+      Direction d = static_cast<Direction>(i);
+      Hex other_coord = coord.neighbor(d);
+      Tile *other = nullptr;
+      const uint32_t *idx = batch.find(other_coord);
+      if (nullptr != idx)
+      {
+        other = tiles[*idx].second.get();
+      }
+      else
+      {
+        const std::shared_ptr<Tile> *found =
+            std::as_const(*m_p_map).find(other_coord);
+        if (nullptr == found)
+        {
+          continue;
+        }
+        other = found->get();
+      }
+
+      if ((tile->neighbor_at(d)) ||
+          ((tile->has_hex()) && (tile->get_hex() != coord)))
+      {
+        return common::ERR_FAIL;
+      }
+      if ((Terrain::sea != tile->get_terrain()) &&
+          (Terrain::sea != other->get_terrain()) &&
+          (tile->has_river_point(d) != other->has_river_point(!d)))
+      {
+        return common::ERR_FAIL;
+      }
+    }
+  }
+
+  // Everything checks out; place the tiles, then link them up. Tiles already
+  // on the map that get linked to the batch have to be our own.
+  detach();
+  if (m_p_forked)
+  {
+    for (const auto &[coord, tile] : tiles)
+    {
+      for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
+      {
+        Hex other_coord = coord.neighbor(static_cast<Direction>(i));
+        if (!batch.contains(other_coord))
+        {
+          own(other_coord);
+        }
+      }
+    }
+  }
+  for (const auto &[coord, tile] : tiles)
+  {
+    m_p_map->insert(coord, tile);
+    tile->set_hex(coord);
+    tile->join(m_p_slots);
+    tile->m_owner = m_p_owner;
+  }
+  for (const auto &[coord, tile] : tiles)
+  {
+    for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
+    {
+      Direction d = static_cast<Direction>(i);
+      Hex other_coord = coord.neighbor(d);
+      std::shared_ptr<Tile> *other = m_p_map->find(other_coord);
+      if (nullptr == other)
+      {
+        continue;
+      }
+      tile->link_neighbor(**other, d);
+      // Tiles in the batch link back to us on their own turn.
+      if (!batch.contains(other_coord))
+      {
+        (*other)->link_neighbor(*tile, !d);
+      }
+    }
+  }
+  for (const auto &[coord, tile] : tiles)
+  {
+    track_river_points(coord, tile, true);
+  }
   return common::ERR_NONE;
 }
 
 common::Error Tile_map::remove(const Hex coord)
 {
-  if ((m_p_locked) || (!m_p_map.contains(coord)))
+  if ((m_p_locked) || (!m_p_map->contains(coord)))
   {
     return common::ERR_FAIL;
   }
+  // The neighbors are unlinked from the removed tile, so they have to be our
+  // own. The removed tile is left alone if a fork still has it.
+  detach();
+  for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
+  {
+    own(coord.neighbor(static_cast<Direction>(i)));
+  }
+  const std::shared_ptr<Tile> removed = *std::as_const(*m_p_map).find(coord);
+  track_river_points(coord, removed, false);
 
   for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
   {
     Direction d = static_cast<Direction>(i);
-    Hex other_coord = coord.neighbor(d);
-    if (m_p_map.contains(other_coord))
+    std::shared_ptr<Tile> *found = m_p_map->find(coord.neighbor(d));
+    if (nullptr != found)
     {
-      std::shared_ptr<Tile> neighbor = m_p_map.at(other_coord);
+      std::shared_ptr<Tile> neighbor = *found;
       common::Error remove_err = neighbor->remove_neighbor(!d);
       if (remove_err)
       {
@@ -111,31 +444,273 @@ common::Error Tile_map::remove(const Hex coord)
       }
     }
   }
-  m_p_map.erase(coord);
+  // Nothing on the map links to the tile anymore; it shouldn't link to the
+  // map either.
+  if (m_p_owner == removed->m_owner)
+  {
+    removed->leave_slots();
+    removed->m_owner = 0;
+  }
+  m_p_map->erase(coord);
   return common::ERR_NONE;
 }
 
 bool Tile_map::is_valid() const
 {
-  if (m_p_map.size() == 0)
-  {
-    return false;
-  }
   // All rivers must either feed into an adjacent tile's river, or into a sea
   // tile.
-  for (auto &item : m_p_map)
+  return ((!m_p_map->empty()) && (0 == m_p_dangling_count));
+}
+
+std::vector<Hex> Tile_map::invalid_hexes() const
+{
+  std::vector<Hex> retval;
+  retval.reserve(m_p_dangling.size());
+  for (const auto &item : m_p_dangling)
+  {
+    retval.push_back(item.first);
+  }
+  return retval;
+}
+
+void Tile_map::track_river_points(const Hex coord,
+                                  const std::shared_ptr<Tile> &tile,
+                                  const bool inserting)
+{
+  uint8_t own_mask = 0;
+  for (Direction d : tile->get_river_points())
+  {
+    Hex other_coord = coord.neighbor(d);
+    if (!m_p_map->contains(other_coord))
+    {
+      own_mask |= static_cast<uint8_t>(1 << d);
+    }
+  }
+
+  // The tile's own dangling points come and go with the tile.
+  if (0 != own_mask)
+  {
+    size_t points = std::popcount(own_mask);
+    if (inserting)
+    {
+      m_p_dangling[coord] = own_mask;
+      m_p_dangling_count += points;
+    }
+    else
+    {
+      m_p_dangling.erase(coord);
+      m_p_dangling_count -= points;
+    }
+  }
+
+  // Neighbors with river points facing this tile are resolved by inserting
+  // it, and left dangling again by removing it.
+  for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
   {
-    std::shared_ptr<Tile> tile = item.second;
-    std::set<Direction> river_points = tile->get_river_points();
-    for (auto rp : river_points)
+    Direction d = static_cast<Direction>(i);
+    Hex other_coord = coord.neighbor(d);
+    const std::shared_ptr<Tile> *other =
+        std::as_const(*m_p_map).find(other_coord);
+    if ((nullptr == other) || (!(*other)->has_river_point(!d)))
     {
-      if (nullptr == tile->get_neighbor(rp))
+      continue;
+    }
+    uint8_t bit = static_cast<uint8_t>(1 << (!d));
+    if (inserting)
+    {
+      auto it = m_p_dangling.find(other_coord);
+      if ((it != m_p_dangling.end()) && (it->second & bit))
       {
-        return false;
+        it->second &= static_cast<uint8_t>(~bit);
+        m_p_dangling_count--;
+        if (0 == it->second)
+        {
+          m_p_dangling.erase(it);
+        }
       }
     }
+    else
+    {
+      uint8_t &mask = m_p_dangling[other_coord];
+      if (0 == (mask & bit))
+      {
+        mask |= bit;
+        m_p_dangling_count++;
+      }
+    }
+  }
+}
+
+std::vector<std::shared_ptr<const Tile>>
+Tile_map::tiles_in_box(const Hex corner_a, const Hex corner_b) const
+{
+  std::vector<std::shared_ptr<const Tile>> retval;
+  Hex lo(std::min(corner_a.q(), corner_b.q()),
+         std::min(corner_a.r(), corner_b.r()));
+  Hex hi(std::max(corner_a.q(), corner_b.q()),
+         std::max(corner_a.r(), corner_b.r()));
+  m_p_map->for_each_in_box(
+      lo, hi, [&retval](const Hex &, const std::shared_ptr<Tile> &tile)
+      { retval.push_back(tile); });
+  return retval;
+}
+
+std::vector<std::shared_ptr<const Tile>>
+Tile_map::tiles_in_view(const int col_min, const int row_min,
+                        const int col_max, const int row_max) const
+{
+  std::vector<std::shared_ptr<const Tile>> retval;
+  if ((col_min > col_max) || (row_min > row_max))
+  {
+    return retval;
+  }
+  // Search the axial box around the rectangle, then trim its slanted edges.
+  Hex lo(col_min - (row_max >> 1), row_min);
+  Hex hi(col_max - (row_min >> 1), row_max);
+  m_p_map->for_each_in_box(
+      lo, hi,
+      [&](const Hex &coord, const std::shared_ptr<Tile> &tile)
+      {
+        int col = coord.q() + (coord.r() >> 1);
+        if ((col_min <= col) && (col <= col_max))
+        {
+          retval.push_back(tile);
+        }
+      });
+  return retval;
+}
+
+std::vector<std::shared_ptr<const Tile>>
+Tile_map::tiles_within(const Hex center, const int radius) const
+{
+  std::vector<std::shared_ptr<const Tile>> retval;
+  if (radius < 0)
+  {
+    return retval;
+  }
+  Hex lo(center.q() - radius, center.r() - radius);
+  Hex hi(center.q() + radius, center.r() + radius);
+  m_p_map->for_each_in_box(
+      lo, hi,
+      [&](const Hex &coord, const std::shared_ptr<Tile> &tile)
+      {
+        if (center.distance(coord) <= radius)
+        {
+          retval.push_back(tile);
+        }
+      });
+  return retval;
+}
+
+common::Error Tile_map::nearest(const Hex from, const Terrain terrain,
+                                std::shared_ptr<const Tile> &tile) const
+{
+  tile.reset();
+  if (!tile::is_valid(terrain))
+  {
+    return common::ERR_INVALID;
+  }
+  Hex at;
+  const std::shared_ptr<Tile> *found = m_p_map->nearest(
+      from,
+      [terrain](const Hex &, const std::shared_ptr<Tile> &candidate)
+      { return terrain == candidate->get_terrain(); },
+      at, static_cast<uint32_t>(1) << terrain);
+  if (nullptr == found)
+  {
+    return common::ERR_NOT_FOUND;
+  }
+  tile = *found;
+  return common::ERR_NONE;
+}
+
+void to_json(nlohmann::json &j, const Tile_map &map)
+{
+  j["locked"] = map.m_p_locked;
+  j["tiles"] = nlohmann::json::array();
+  std::as_const(*map.m_p_map).for_each(
+      [&j](const Hex &, const std::shared_ptr<Tile> &tile)
+      {
+        nlohmann::json tile_json;
+        to_json(tile_json, *tile);
+        j["tiles"].push_back(tile_json);
+      });
+}
+
+void from_json(const nlohmann::json &j, Tile_map &map)
+{
+  map.reset();
+  const nlohmann::json &tiles_json = j.at("tiles");
+  const size_t count = tiles_json.size();
+
+  // First pass parses each tile on its own. Tiles don't reference each other
+  // yet, so large maps are split up across a pool of threads.
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> tiles(count);
+  auto parse = [&tiles_json, &tiles](const size_t begin, const size_t end)
+  {
+    for (size_t i = begin; i < end; i++)
+    {
+      std::shared_ptr<Tile> tile = std::make_shared<Tile>();
+      tile->load_fields_json(tiles_json[i]);
+      if (!tile->has_hex())
+      {
+        throw nlohmann::json::type_error::create(
+            501, "Map tile is missing its hex coordinates!", tiles_json[i]);
+      }
+      tiles[i] = {tile->get_hex(), tile};
+    }
+  };
+
+  utils::parallel_for(count, Tile_map::PARALLEL_LOAD_THRESHOLD, parse);
+
+  // Second pass places every tile and links neighbors straight from the
+  // coordinate index. Each tile's listed neighbors must match what it was
+  // actually linked to. Walls can only be loaded once neighbors are in place.
+  if (common::ERR_NONE != map.insert_many(tiles))
+  {
+    throw nlohmann::json::type_error::create(
+        501, "Invalid tile layout in map JSON!", j);
+  }
+  try
+  {
+    for (size_t i = 0; i < count; i++)
+    {
+      const nlohmann::json &tile_json = tiles_json[i];
+      std::shared_ptr<Tile> &tile = tiles[i].second;
+      uint8_t listed = 0;
+      for (Direction d :
+           tile_json.at("neighbors").get<std::vector<Direction>>())
+      {
+        if (!is_valid(d))
+        {
+          throw nlohmann::json::type_error::create(
+              501, "Invalid neighbor value!", tile_json);
+        }
+        listed |= static_cast<uint8_t>(1 << d);
+      }
+      uint8_t linked = 0;
+      for (uint8_t d = 0; d < MAX_DIRECTIONS; d++)
+      {
+        if (tile->neighbor_at(static_cast<Direction>(d)))
+        {
+          linked |= static_cast<uint8_t>(1 << d);
+        }
+      }
+      if (listed != linked)
+      {
+        std::stringstream msg;
+        msg << "Tile neighbors don't match the map! hex=" << tiles[i].first;
+        throw nlohmann::json::type_error::create(501, msg.str(), tile_json);
+      }
+      tile->load_walls_json(tile_json.at("walls"));
+    }
+  }
+  catch (...)
+  {
+    map.reset();
+    throw;
   }
-  return true;
+  map.set_lock(j.at("locked").get<bool>());
 }
 
 } // namespace tile
\ No newline at end of file
@@ -1,15 +1,23 @@
 #ifndef TILE_MAP_H
 #define TILE_MAP_H
 
+#include <array>
+#include <atomic>
+#include <map>
 #include <memory>
+#include <span>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 #include <stduuid/include/uuid.h>
 
 #include <common/Errors.h>
 #include <tiles/Tile.h>
+#include <tiles/Tile_store.h>
 #include <tiles/components/Hex.h>
+#include <tiles/components/Hex_range.h>
 
 /// This map relies heavily on the q, r, s (cube/axial) coordinate system for
 /// hexagons. Each tile will have a coordinate tuple associated with its
@@ -18,20 +26,128 @@
 
 namespace tile
 {
+/// Flat, index-based view of a locked map's layout. Once a map is locked its
+/// tiles can no longer move, so every tile is given a dense index and the
+/// neighbor graph is flattened into plain arrays. Passes that walk the whole
+/// board (movement, production, validation) can iterate these arrays instead
+/// of chasing Tile pointers.
+struct Compiled_map
+{
+  static constexpr int32_t NO_NEIGHBOR = -1;
+
+  /// Returns the number of tiles in the compiled view
+  inline size_t size() const { return hexes.size(); }
+
+  /// Returns the dense index of the tile at the input coordinates
+  /// @param[in] coord
+  /// @return The tile's index. NO_NEIGHBOR if no tile is at coord.
+  inline int32_t index_of(const Hex &coord) const
+  {
+    const int32_t *found = indices.find(coord);
+    return (nullptr != found ? *found : NO_NEIGHBOR);
+  }
+
+  // Per-tile data, all indexed by the tile's dense index.
+  std::vector<Hex> hexes;
+  std::vector<const Tile *> tiles;
+  std::vector<std::array<int32_t, MAX_DIRECTIONS>> neighbors;
+  std::vector<Terrain> terrain;
+  // Bit d is set when the tile has a river point in Direction d.
+  std::vector<uint8_t> river_mask;
+  // Bit d is set when the tile's neighbor in Direction d is a sea tile.
+  std::vector<uint8_t> sea_sides;
+  std::vector<bool> shore;
+
+  Chunked_store<int32_t> indices;
+};
+
+/// Tags each stored tile with its terrain's bit, so nearest-terrain searches
+/// can skip chunks holding no tile of that terrain.
+struct Terrain_tag
+{
+  inline uint32_t operator()(const std::shared_ptr<Tile> &tile) const
+  {
+    return (tile && is_valid(tile->get_terrain())
+                ? static_cast<uint32_t>(1) << tile->get_terrain()
+                : 0);
+  }
+};
+
+/// Hands out stored tiles as read-only, for the map's const queries.
+struct Read_only
+{
+  inline const Tile *operator()(const std::shared_ptr<Tile> &tile) const
+  {
+    return tile.get();
+  }
+};
+
 class Tile_map
 {
 public:
+  /// Storage backend holding the map's tiles, chosen at compile time. Chunked
+  /// storage is the default; define TILE_MAP_TREE_STORE, TILE_MAP_HASHED_STORE
+  /// or TILE_MAP_FLAT_STORE to build with another backend from Tile_store.h.
+#if defined(TILE_MAP_TREE_STORE)
+  using Storage = Tree_store<std::shared_ptr<Tile>>;
+#elif defined(TILE_MAP_HASHED_STORE)
+  using Storage = Hashed_store<std::shared_ptr<Tile>>;
+#elif defined(TILE_MAP_FLAT_STORE)
+  using Storage = Flat_store<std::shared_ptr<Tile>>;
+#else
+  using Storage = Chunked_store<std::shared_ptr<Tile>, 3, Terrain_tag>;
+#endif
+
   Tile_map();
+  /// Copies are forks of the other map; see fork().
   Tile_map(const Tile_map &other);
   ~Tile_map();
 
   inline void reset()
   {
-    m_p_map.clear();
+    // Start on fresh storage rather than clearing tiles a fork may share.
+    m_p_map = std::make_shared<Storage>();
+    m_p_clock = std::make_shared<portable::Phase_clock>();
+    m_p_slots = std::make_shared<Tile_slots>(m_p_clock);
+    m_p_forked = false;
+    m_p_fork_pending.store(false, std::memory_order_relaxed);
     m_p_locked = false;
+    m_p_compiled.reset();
+    m_p_dangling.clear();
+    m_p_dangling_count = 0;
   }
 
-  Tile_map operator=(const Tile_map &other);
+  Tile_map &operator=(const Tile_map &other);
+
+  /// Makes a snapshot of the map in O(1). The fork shares this map's tiles,
+  /// and each map copies just the tiles it changes: a non-const get_tile
+  /// copies the tile and its neighbors, and insert and remove copy the
+  /// neighbors they relink. A map's own copies link to each other, while
+  /// tiles still shared keep linking to the tiles as they were at the fork.
+  /// Tiles taken from either map before the fork, or from a const query, may
+  /// be shared; get them from the map again to change them.
+  /// @return The fork
+  inline Tile_map fork() const { return Tile_map(*this); }
+
+  /// Returns the movement phase the map's game is in
+  inline uint32_t phase() const { return m_p_clock->now(); }
+
+  /// Starts a new movement phase for the resources of every area on the map
+  /// at once, as if each area had been reset. Forks play out the same game,
+  /// so a map and its forks share one clock.
+  inline void next_phase() { m_p_clock->next(); }
+
+  /// Returns whether the map's storage is shared with a fork, as it is until
+  /// either map first changes
+  inline bool is_shared() const { return m_p_map.use_count() > 1; }
+
+  /// Returns the tile on the map the input handle refers to
+  /// @param[in] handle
+  /// @return The tile. Null if the handle is stale or from another map.
+  inline const Tile *resolve(const Tile_handle handle) const
+  {
+    return m_p_slots->resolve(handle);
+  }
 
   /// Retrieves the Tile at the given coordinates on the map
   /// @param[in] q
@@ -66,7 +182,9 @@ public:
     return get_tile(coord, tile);
   }
 
-  /// Retrieves the Tile at the given coordinates on the map
+  /// Retrieves the Tile at the given coordinates on the map, for changing. If
+  /// the tile or its neighbors are shared with a fork, the map gets its own
+  /// copies of them first.
   /// @param[in] point Map coordinates
   /// @param[out] tile Tile found at given coordinates. Null on error.
   /// @return
@@ -75,6 +193,16 @@ public:
   ///   - ERR_UNKNOWN on any other errors
   common::Error get_tile(const Hex coord, std::shared_ptr<Tile> &tile);
 
+  /// Retrieves the Tile at the given coordinates for reading only. Unlike the
+  /// non-const lookup, this never copies tiles shared with a fork.
+  /// @param[in] point Map coordinates
+  /// @param[out] tile Tile found at given coordinates. Null on error.
+  /// @return
+  ///   - ERR_NONE on success
+  ///   - ERR_FAIL if no tile is at the coordinates
+  common::Error get_tile(const Hex coord,
+                         std::shared_ptr<const Tile> &tile) const;
+
   /// Adds the tile to the map at the input coordinates.
   /// @param[in] q
   /// @param[in] r
@@ -120,6 +248,18 @@ public:
   ///   - ERR_UNKNOWN on any other errors
   common::Error insert(const Hex coord, const std::shared_ptr<Tile> &tile);
 
+  /// Adds a batch of tiles to the map. The whole batch is validated against
+  /// itself and the tiles already on the map before anything is placed, and
+  /// neighbors are then linked in a single pass. Either every tile is added,
+  /// or the map is left untouched.
+  /// @param[in] tiles Coordinates and the tile to be added there
+  /// @return
+  ///   - ERR_NONE on success
+  ///   - ERR_INVALID on invalid input parameters
+  ///   - ERR_FAIL on failure to add based on tile layout
+  common::Error
+  insert_many(std::span<const std::pair<Hex, std::shared_ptr<Tile>>> tiles);
+
   /// Removes the tile from the map at the input coordinates.
   /// @param[in] q
   /// @param[in] r
@@ -158,23 +298,190 @@ public:
   ///   - ERR_FAIL on failure to remove
   common::Error remove(const Hex coord);
 
-  inline bool empty() const { return m_p_map.empty(); }
+  inline bool empty() const { return m_p_map->empty(); }
   inline bool is_locked() const { return m_p_locked; }
-  inline void set_lock(const bool lock_status) { m_p_locked = lock_status; }
-  inline size_t size() const { return m_p_map.size(); }
+  inline size_t size() const { return m_p_map->size(); }
+
+  /// Locks or unlocks the map's layout. Locking compiles the map into a
+  /// Compiled_map view; unlocking discards it.
+  /// @param[in] lock_status
+  void set_lock(const bool lock_status);
+
+  /// Returns the compiled view of the map's layout
+  /// @return The compiled view. Null if the map isn't locked.
+  inline const Compiled_map *compiled() const { return m_p_compiled.get(); }
 
   // Checks that the current map is a valid map, as in no rivers run to a
-  // nonexistent tile.
+  // nonexistent tile. Validity is tracked as tiles are inserted/removed, so
+  // this check is O(1).
   bool is_valid() const;
 
-  nlohmann::json to_json() const;
+  /// Returns the coordinates of every tile with a river running off to a
+  /// nonexistent tile.
+  /// @return The offending tiles' coordinates, in coordinate order.
+  std::vector<Hex> invalid_hexes() const;
+
+  /// Retrieves every tile inside the axial bounding box between two corners.
+  /// Runs in time proportional to the chunks overlapping the box plus the
+  /// tiles found, rather than the size of the map.
+  /// @param[in] corner_a
+  /// @param[in] corner_b
+  /// @return Tiles found inside the box
+  std::vector<std::shared_ptr<const Tile>>
+  tiles_in_box(const Hex corner_a, const Hex corner_b) const;
+
+  /// Retrieves every tile inside a rectangle of the board as drawn. Tiles are
+  /// laid out in rows of equal r, with each odd row shifted half a tile to the
+  /// east; a tile's column is q + floor(r / 2).
+  /// @param[in] col_min
+  /// @param[in] row_min
+  /// @param[in] col_max
+  /// @param[in] row_max
+  /// @return Tiles found inside the rectangle
+  std::vector<std::shared_ptr<const Tile>>
+  tiles_in_view(const int col_min, const int row_min, const int col_max,
+                const int row_max) const;
+
+  /// Retrieves every tile within `radius` of the center.
+  /// @param[in] center
+  /// @param[in] radius
+  /// @return Tiles found within the radius
+  std::vector<std::shared_ptr<const Tile>>
+  tiles_within(const Hex center, const int radius) const;
+
+  /// Finds the closest tile of the input terrain.
+  /// @param[in] from Coordinates to measure from
+  /// @param[in] terrain Terrain of the tile to find
+  /// @param[out] tile One of the closest matching tiles. Null on error.
+  /// @return
+  ///   - ERR_NONE on success
+  ///   - ERR_INVALID on invalid terrain
+  ///   - ERR_NOT_FOUND if no tile on the map has the terrain
+  common::Error nearest(const Hex from, const Terrain terrain,
+                        std::shared_ptr<const Tile> &tile) const;
+
+  /// Lazily yields the tiles placed at any of the input coordinates, skipping
+  /// empty spots. Nothing is allocated; see Hex_range.h for regions to use.
+  /// @param[in] region Range of coordinates to check
+  /// @return Range of the placed tiles, in the region's order
+  template <class Region>
+  inline Occupied_view<const Storage, Region, Read_only>
+  tiles_in(const Region &region) const
+  {
+    return Occupied_view<const Storage, Region, Read_only>(*m_p_map, region);
+  }
+
+  /// Tiles exactly `radius` away from the center.
+  /// @param[in] center
+  /// @param[in] radius
+  /// @return Range of the placed tiles
+  inline auto tiles_in_ring(const Hex center, const int radius) const
+  {
+    return tiles_in(hex_ring(center, radius));
+  }
+
+  /// Tiles within `radius` of the center, from the center outward.
+  /// @param[in] center
+  /// @param[in] radius
+  /// @return Range of the placed tiles
+  inline auto tiles_in_spiral(const Hex center, const int radius) const
+  {
+    return tiles_in(hex_spiral(center, radius));
+  }
+
+  /// Tiles within `radius` of the center, in column order.
+  /// @param[in] center
+  /// @param[in] radius
+  /// @return Range of the placed tiles
+  inline auto tiles_in_range(const Hex center, const int radius) const
+  {
+    return tiles_in(hex_range(center, radius));
+  }
+
+  /// Tiles along the line between two hexes, both ends included.
+  /// @param[in] from
+  /// @param[in] to
+  /// @return Range of the placed tiles
+  inline auto tiles_on_line(const Hex from, const Hex to) const
+  {
+    return tiles_in(hex_line(from, to));
+  }
+
+  friend void to_json(nlohmann::json &j, const Tile_map &map);
+  friend void from_json(const nlohmann::json &j, Tile_map &map);
 
 protected:
 private:
-  std::map<Hex, std::shared_ptr<Tile>> m_p_map;
+  // Tiles are kept in coordinate-keyed storage for O(1) lookups. Forks share
+  // the storage until one of them changes, and then its chunks until those
+  // change.
+  std::shared_ptr<Storage> m_p_map;
+  // Movement phase clock of the map's game. Caches of every tile placed on
+  // the map are attached to it, and the slot table keeps it alive for them.
+  std::shared_ptr<portable::Phase_clock> m_p_clock;
+  // Table the map's tiles take their slots in, and resolve their links
+  // through. Shared with every fork.
+  std::shared_ptr<Tile_slots> m_p_slots;
+  // Stamp of the tiles the map has to itself; see own(). Both sides of a
+  // fork take a new stamp, so every tile from before the fork reads as
+  // shared.
+  uint32_t m_p_owner;
+  // Whether the map has been forked since it was last reset, so its tiles
+  // may be shared. Maps that never were skip the ownership checks.
+  bool m_p_forked;
+  // Set by forks of the map, which may be taken from several threads at once
+  // and so never touch the map's stamp. The map takes its new stamp in
+  // detach(), before its next change. Relaxed ordering is enough, as a fork
+  // and a later change of the map must be ordered by the caller anyway, like
+  // any other read and write of the map.
+  mutable std::atomic<bool> m_p_fork_pending;
+
+  /// Builds the compiled view of the current layout.
+  void compile();
+
+  /// Gives the map storage of its own if it's shared with a fork. The new
+  /// storage shares the old one's chunks, and so its tiles. Takes a new stamp
+  /// first if the map was forked since its last change.
+  void detach();
+
+  /// Gives the map its own copy of the tile at the input coordinates if it's
+  /// shared with a fork. The copy keeps the tile's links, and is relinked
+  /// both ways with the map's own neighbors. The storage must be detached.
+  /// @param[in] coord
+  void own(const Hex coord);
+
+  /// Same as own(), for the tile at the input coordinates and its neighbors.
+  /// Detaches the storage first, if there's a tile at the coordinates.
+  /// @param[in] coord
+  void own_around(const Hex coord);
+
+  /// Takes a stamp no map has used yet.
+  static uint32_t next_owner();
+
+  /// Updates the dangling river point tracking for the tile just inserted at
+  /// (or about to be removed from) the input coordinates. Only the tile and
+  /// its six neighbors are checked.
+  /// @param[in] coord
+  /// @param[in] tile
+  /// @param[in] inserting true when adding the tile; false when removing it
+  void track_river_points(const Hex coord, const std::shared_ptr<Tile> &tile,
+                          const bool inserting);
+
+  /// Maps with at least this many tiles are parsed from JSON across a pool of
+  /// threads.
+  static constexpr size_t PARALLEL_LOAD_THRESHOLD = 512;
 
   // Flag denoting whether tiles can still be added/removed from the map.
   bool m_p_locked;
+
+  // Index-based view of the layout; only present while the map is locked.
+  // Forks share it until one of them copies a tile it points to.
+  std::shared_ptr<Compiled_map> m_p_compiled;
+
+  // Tiles with river points that don't meet another tile, mapped to a mask of
+  // the offending directions; along with the total count of those points.
+  std::map<Hex, uint8_t> m_p_dangling;
+  size_t m_p_dangling_count;
 };
 } // namespace tile
 
@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#include <tiles/Tile_prototype.h>
+#include <tiles/components/Hex.h>
+#include <tiles/components/Rotation.h>
+
+namespace tile
+{
+std::shared_mutex Tile_prototype::s_lock;
+std::map<Tile_prototype::Key, std::unique_ptr<Tile_prototype>>
+    Tile_prototype::s_prototypes;
+std::atomic<const Tile_prototype *>
+    Tile_prototype::s_fresh[MAX_TERRAIN_TYPES][1 + (1 << MAX_DIRECTIONS)];
+
+Tile_prototype::Tile_prototype(const Tile_shape &shape)
+    : m_shape(shape), m_fingerprint(0)
+{
+  for (uint16_t part : key_of(shape))
+  {
+    m_fingerprint = mix_hash(m_fingerprint ^ part);
+  }
+  std::fill(std::begin(m_area_slots), std::end(m_area_slots), NO_SLOT);
+  std::fill(std::begin(m_river_slots), std::end(m_river_slots), NO_SLOT);
+  // Walk backwards so the first area or river listed wins any overlap.
+  for (size_t i = m_shape.areas.size(); i-- > 0;)
+  {
+    for (Border b : m_shape.areas.areas[i])
+    {
+      m_area_slots[b] = static_cast<uint8_t>(i);
+    }
+  }
+  for (size_t i = m_shape.river_count; i-- > 0;)
+  {
+    m_river_points |= m_shape.rivers[i];
+    for (Direction d : m_shape.rivers[i])
+    {
+      m_river_slots[d] = static_cast<uint8_t>(i);
+    }
+  }
+  for (auto &rotation : m_rotations)
+  {
+    rotation.store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+Tile_prototype::Key Tile_prototype::key_of(const Tile_shape &shape)
+{
+  Key key{};
+  key[0] = static_cast<uint16_t>(shape.terrain);
+  key[1] = shape.river_count;
+  key[2] = shape.areas.count;
+  for (uint8_t i = 0; i < shape.river_count; i++)
+  {
+    key[3 + i] = shape.rivers[i].bits();
+  }
+  for (uint8_t i = 0; i < shape.areas.count; i++)
+  {
+    key[3 + MAX_DIRECTIONS + i] = shape.areas.areas[i].bits();
+  }
+  return key;
+}
+
+const Tile_prototype *Tile_prototype::intern(const Tile_shape &shape)
+{
+  const Key key = key_of(shape);
+  {
+    std::shared_lock<std::shared_mutex> guard(s_lock);
+    auto found = s_prototypes.find(key);
+    if (s_prototypes.end() != found)
+    {
+      return found->second.get();
+    }
+  }
+  std::unique_lock<std::shared_mutex> guard(s_lock);
+  std::unique_ptr<Tile_prototype> &slot = s_prototypes[key];
+  if (!slot)
+  {
+    slot = std::make_unique<Tile_prototype>(shape);
+  }
+  return slot.get();
+}
+
+const Tile_prototype *
+Tile_prototype::fresh(const Terrain terrain,
+                      const std::vector<Direction_mask> &rivers)
+{
+  Tile_shape shape;
+  shape.terrain = terrain;
+  if (Terrain::sea != terrain)
+  {
+    shape.river_count = static_cast<uint8_t>(
+        std::min<size_t>(rivers.size(), MAX_DIRECTIONS));
+    std::copy(rivers.begin(), rivers.begin() + shape.river_count,
+              shape.rivers.begin());
+  }
+  shape.areas = partition_rivers(shape.rivers.data(), shape.river_count);
+  return intern(shape);
+}
+
+const Tile_prototype *Tile_prototype::fresh(const Terrain terrain)
+{
+  if (!is_valid(terrain))
+  {
+    return fresh(terrain, std::vector<Direction_mask>());
+  }
+  std::atomic<const Tile_prototype *> &cached = s_fresh[terrain][0];
+  const Tile_prototype *retval = cached.load(std::memory_order_acquire);
+  if (nullptr == retval)
+  {
+    retval = fresh(terrain, std::vector<Direction_mask>());
+    cached.store(retval, std::memory_order_release);
+  }
+  return retval;
+}
+
+const Tile_prototype *Tile_prototype::fresh(const Terrain terrain,
+                                            const Direction_mask river)
+{
+  if ((!is_valid(terrain)) || (Terrain::sea == terrain))
+  {
+    return fresh(terrain);
+  }
+  std::atomic<const Tile_prototype *> &cached =
+      s_fresh[terrain][1 + river.bits()];
+  const Tile_prototype *retval = cached.load(std::memory_order_acquire);
+  if (nullptr == retval)
+  {
+    retval = fresh(terrain, std::vector<Direction_mask>{river});
+    cached.store(retval, std::memory_order_release);
+  }
+  return retval;
+}
+
+const Tile_prototype *Tile_prototype::rotated(const uint8_t steps) const
+{
+  if (0 == steps)
+  {
+    return this;
+  }
+  const Tile_prototype *retval =
+      m_rotations[steps].load(std::memory_order_acquire);
+  if (nullptr == retval)
+  {
+    // Rivers and areas keep their order; only their points and borders turn.
+    Tile_shape shape = m_shape;
+    for (uint8_t i = 0; i < shape.river_count; i++)
+    {
+      shape.rivers[i] = tile::rotated(shape.rivers[i], steps);
+    }
+    for (uint8_t i = 0; i < shape.areas.count; i++)
+    {
+      shape.areas.areas[i] = tile::rotated(shape.areas.areas[i], steps);
+    }
+    retval = intern(shape);
+    m_rotations[steps].store(retval, std::memory_order_release);
+  }
+  return retval;
+}
+
+size_t Tile_prototype::count()
+{
+  std::shared_lock<std::shared_mutex> guard(s_lock);
+  return s_prototypes.size();
+}
+} // namespace tile
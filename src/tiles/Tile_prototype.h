@@ -0,0 +1,114 @@
+#ifndef TILE_PROTOTYPE_H
+#define TILE_PROTOTYPE_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <vector>
+
+#include <tiles/components/Border.h>
+#include <tiles/components/Terrain.h>
+#include <tiles/components/Topology.h>
+
+namespace tile
+{
+/// What a tile looks like before anything's built on it: its terrain, and the
+/// points and borders of its rivers and areas, in the order the tile keeps
+/// them.
+struct Tile_shape
+{
+  Terrain terrain = Terrain::desert;
+  uint8_t river_count = 0;
+  std::array<Direction_mask, MAX_DIRECTIONS> rivers{};
+  Area_partition areas;
+};
+
+/// Interned, immutable shape shared by every tile that has it, across every
+/// map in the process. Besides the shape itself, it keeps the lookups tiles
+/// derive from it: which area holds each border, and which river has a point
+/// at each side. Prototypes are never freed or changed once made, so tiles
+/// hold on to them by plain pointer.
+class Tile_prototype
+{
+public:
+  static constexpr uint8_t NO_SLOT = 0xff;
+
+  /// Returns the prototype for the input shape, making it on first use.
+  /// @param[in] shape
+  /// @return The shape's prototype
+  static const Tile_prototype *intern(const Tile_shape &shape);
+
+  /// Returns the prototype of a fresh tile, with its areas split along its
+  /// rivers. Sea tiles never have rivers, so any input rivers are dropped.
+  /// Tiles can't have more rivers than sides; any past that are dropped too.
+  /// @param[in] terrain
+  /// @param[in] rivers  Points of each river
+  /// @return The fresh tile's prototype
+  static const Tile_prototype *
+  fresh(const Terrain terrain, const std::vector<Direction_mask> &rivers);
+  /// Same as above for tiles with no rivers, or just the one. These are
+  /// looked up without locking once they've been made.
+  static const Tile_prototype *fresh(const Terrain terrain);
+  static const Tile_prototype *fresh(const Terrain terrain,
+                                     const Direction_mask river);
+
+  /// Returns the prototype of this shape, rotated clockwise.
+  /// @param[in] steps  Clockwise steps, in [0, MAX_DIRECTIONS)
+  /// @return The rotated prototype
+  const Tile_prototype *rotated(const uint8_t steps) const;
+
+  /// Returns the number of prototypes made so far
+  static size_t count();
+
+  inline const Tile_shape &shape() const { return m_shape; }
+  inline Terrain terrain() const { return m_shape.terrain; }
+  inline Direction_mask river_points() const { return m_river_points; }
+  /// Returns a 64-bit fingerprint of the shape. Unlike the prototype's
+  /// address, it's the same from one run to the next.
+  inline uint64_t fingerprint() const { return m_fingerprint; }
+
+  /// Returns the index of the area holding the input border
+  /// @param[in] b
+  /// @return The area's index. NO_SLOT on invalid input.
+  inline uint8_t area_slot(const Border b) const
+  {
+    return is_valid(b) ? m_area_slots[b] : NO_SLOT;
+  }
+  /// Returns the index of the river with a point at the input side
+  /// @param[in] d
+  /// @return The river's index. NO_SLOT if there's no river there, or on
+  /// invalid input.
+  inline uint8_t river_slot(const Direction d) const
+  {
+    return is_valid(d) ? m_river_slots[d] : NO_SLOT;
+  }
+
+  explicit Tile_prototype(const Tile_shape &shape);
+  Tile_prototype(const Tile_prototype &other) = delete;
+  Tile_prototype &operator=(const Tile_prototype &other) = delete;
+
+private:
+  // Shapes are keyed by their terrain, counts and masks' bits.
+  using Key = std::array<uint16_t, 3 + MAX_DIRECTIONS + MAX_BORDERS>;
+  static Key key_of(const Tile_shape &shape);
+
+  Tile_shape m_shape;
+  uint64_t m_fingerprint;
+  Direction_mask m_river_points;
+  uint8_t m_area_slots[MAX_BORDERS];
+  uint8_t m_river_slots[MAX_DIRECTIONS];
+  // Rotated prototypes, filled in the first time each is asked for.
+  mutable std::atomic<const Tile_prototype *> m_rotations[MAX_DIRECTIONS];
+
+  static std::shared_mutex s_lock;
+  static std::map<Key, std::unique_ptr<Tile_prototype>> s_prototypes;
+  // Fresh prototypes by terrain: no rivers first, then one per river layout.
+  static std::atomic<const Tile_prototype *>
+      s_fresh[MAX_TERRAIN_TYPES][1 + (1 << MAX_DIRECTIONS)];
+};
+} // namespace tile
+
+#endif
@@ -0,0 +1,941 @@
+#ifndef TILE_STORE_H
+#define TILE_STORE_H
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <ranges>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <tiles/components/Hex.h>
+
+/// Coordinate-keyed storage backends for the tile map. Every backend exposes
+/// the same small interface (find/contains/insert/erase/for_each), so the map
+/// doesn't care how its tiles are laid out in memory.
+
+namespace tile
+{
+/// Tag bits that may be searched for with nearest(). Values are tagged by the
+/// store's Tag policy; the default tags every value with every bit.
+static constexpr uint32_t ALL_TAGS = ~static_cast<uint32_t>(0);
+
+/// Default Tag policy for Chunked_store.
+struct All_tags
+{
+  template <class T> constexpr uint32_t operator()(const T &) const
+  {
+    return ALL_TAGS;
+  }
+};
+
+/// Dense, chunked axial-coordinate storage.
+///
+/// The board is cut into square chunks of (2^K x 2^K) axial coordinates. A
+/// chunk is found by its (q >> K, r >> K) key, and a coordinate's slot within
+/// the chunk is (q & mask, r & mask). Each chunk keeps an occupancy bitmap, so
+/// lookups are a single hash probe on the chunk key followed by an array
+/// index. Neighboring coordinates almost always land in the same chunk, which
+/// keeps neighbor probes within the same few cache lines.
+///
+/// Each chunk also keeps the union of its values' Tag(value) bits, so
+/// nearest() can skip whole chunks that can't hold a match. A value's tag
+/// bits must not change while it is stored.
+///
+/// Copies of the store share their chunks. A chunk is copied the first time
+/// either store changes it or hands out a non-const pointer into it, so a
+/// copy costs one reference per chunk rather than one per value.
+template <class T, uint8_t K = 3, class Tag = All_tags> class Chunked_store
+{
+public:
+  static constexpr int32_t CHUNK_SIDE = 1 << K;
+  static constexpr int32_t CHUNK_MASK = CHUNK_SIDE - 1;
+  static constexpr size_t CHUNK_SLOTS = CHUNK_SIDE * CHUNK_SIDE;
+  using value_type = T;
+
+  struct Chunk
+  {
+    int64_t key;
+    int32_t q;
+    int32_t r;
+    uint16_t count;
+    // Tight bounds of the occupied slots, in chunk-local coordinates.
+    uint8_t min_q;
+    uint8_t max_q;
+    uint8_t min_r;
+    uint8_t max_r;
+    // Union of the stored values' tag bits.
+    uint32_t tags;
+    std::bitset<CHUNK_SLOTS> occupied;
+    std::array<T, CHUNK_SLOTS> slots;
+  };
+
+  Chunked_store() : m_size(0) {}
+
+  inline size_t size() const { return m_size; }
+  inline bool empty() const { return 0 == m_size; }
+  inline void clear()
+  {
+    m_chunks.clear();
+    m_index.clear();
+    m_size = 0;
+  }
+
+  inline bool contains(const Hex &coord) const
+  {
+    return nullptr != find(coord);
+  }
+
+  /// Retrieves the value stored at the input coordinates
+  /// @param[in] coord
+  /// @return Pointer to the stored value. Null if nothing is stored there.
+  T *find(const Hex &coord)
+  {
+    auto it = m_index.find(chunk_key(coord));
+    if (it == m_index.end())
+    {
+      return nullptr;
+    }
+    size_t slot = slot_index(coord);
+    return (m_chunks[it->second]->occupied.test(slot)
+                ? &own(it->second).slots[slot]
+                : nullptr);
+  }
+
+  const T *find(const Hex &coord) const
+  {
+    auto it = m_index.find(chunk_key(coord));
+    if (it == m_index.end())
+    {
+      return nullptr;
+    }
+    const Chunk &chunk = *m_chunks[it->second];
+    size_t slot = slot_index(coord);
+    return (chunk.occupied.test(slot) ? &chunk.slots[slot] : nullptr);
+  }
+
+  /// Stores the value at the input coordinates
+  /// @param[in] coord
+  /// @param[in] value
+  /// @return false if the coordinates are already occupied; true otherwise
+  bool insert(const Hex &coord, T value)
+  {
+    int64_t key = chunk_key(coord);
+    auto it = m_index.find(key);
+    size_t idx;
+    if (it == m_index.end())
+    {
+      idx = m_chunks.size();
+      std::shared_ptr<Chunk> added = std::make_shared<Chunk>();
+      added->key = key;
+      added->q = coord.q() >> K;
+      added->r = coord.r() >> K;
+      added->count = 0;
+      added->tags = 0;
+      m_chunks.push_back(std::move(added));
+      m_index.insert({key, static_cast<uint32_t>(idx)});
+    }
+    else
+    {
+      idx = it->second;
+    }
+
+    size_t slot = slot_index(coord);
+    if (m_chunks[idx]->occupied.test(slot))
+    {
+      return false;
+    }
+    Chunk &chunk = own(idx);
+    chunk.occupied.set(slot);
+    chunk.tags |= Tag()(value);
+    chunk.slots[slot] = std::move(value);
+    uint8_t local_q = static_cast<uint8_t>(coord.q() & CHUNK_MASK);
+    uint8_t local_r = static_cast<uint8_t>(coord.r() & CHUNK_MASK);
+    if (0 == chunk.count)
+    {
+      chunk.min_q = chunk.max_q = local_q;
+      chunk.min_r = chunk.max_r = local_r;
+    }
+    else
+    {
+      chunk.min_q = std::min(chunk.min_q, local_q);
+      chunk.max_q = std::max(chunk.max_q, local_q);
+      chunk.min_r = std::min(chunk.min_r, local_r);
+      chunk.max_r = std::max(chunk.max_r, local_r);
+    }
+    chunk.count++;
+    m_size++;
+    return true;
+  }
+
+  /// Removes the value stored at the input coordinates
+  /// @param[in] coord
+  /// @return false if nothing was stored at the coordinates; true otherwise
+  bool erase(const Hex &coord)
+  {
+    auto it = m_index.find(chunk_key(coord));
+    if (it == m_index.end())
+    {
+      return false;
+    }
+    size_t idx = it->second;
+    size_t slot = slot_index(coord);
+    if (!m_chunks[idx]->occupied.test(slot))
+    {
+      return false;
+    }
+    Chunk &chunk = own(idx);
+    chunk.occupied.reset(slot);
+    chunk.slots[slot] = T();
+    chunk.count--;
+    m_size--;
+
+    // Release empty chunks by moving the last chunk into their place.
+    if (0 == chunk.count)
+    {
+      m_index.erase(it);
+      if (idx != m_chunks.size() - 1)
+      {
+        m_chunks[idx] = std::move(m_chunks.back());
+        m_index.at(m_chunks[idx]->key) = static_cast<uint32_t>(idx);
+      }
+      m_chunks.pop_back();
+    }
+    else
+    {
+      update_bounds(chunk);
+    }
+    return true;
+  }
+
+  /// Calls f(coord, value) for every stored value, chunk by chunk.
+  template <class F> void for_each(F f) const
+  {
+    for (const std::shared_ptr<Chunk> &stored : m_chunks)
+    {
+      const Chunk &chunk = *stored;
+      for (size_t slot = 0; slot < CHUNK_SLOTS; slot++)
+      {
+        if (chunk.occupied.test(slot))
+        {
+          f(slot_hex(chunk, slot), chunk.slots[slot]);
+        }
+      }
+    }
+  }
+
+  template <class F> void for_each(F f)
+  {
+    for (size_t idx = 0; idx < m_chunks.size(); idx++)
+    {
+      Chunk &chunk = own(idx);
+      for (size_t slot = 0; slot < CHUNK_SLOTS; slot++)
+      {
+        if (chunk.occupied.test(slot))
+        {
+          f(slot_hex(chunk, slot), chunk.slots[slot]);
+        }
+      }
+    }
+  }
+
+  /// Calls f(coord, value) for every stored value inside the axial box between
+  /// the input corners (inclusive). Only chunks whose occupied bounds overlap
+  /// the box are visited.
+  /// @param[in] lo Corner with the smallest q and r
+  /// @param[in] hi Corner with the largest q and r
+  /// @param[in] f
+  template <class F>
+  void for_each_in_box(const Hex &lo, const Hex &hi, F f) const
+  {
+    if ((lo.q() > hi.q()) || (lo.r() > hi.r()))
+    {
+      return;
+    }
+    int64_t chunk_cols = (hi.q() >> K) - (lo.q() >> K) + 1;
+    int64_t chunk_rows = (hi.r() >> K) - (lo.r() >> K) + 1;
+    if (chunk_cols * chunk_rows <= static_cast<int64_t>(m_chunks.size()))
+    {
+      // Small boxes look up each chunk they cover.
+      for (int32_t cq = lo.q() >> K; cq <= (hi.q() >> K); cq++)
+      {
+        for (int32_t cr = lo.r() >> K; cr <= (hi.r() >> K); cr++)
+        {
+          auto it = m_index.find(chunk_key(Hex(cq << K, cr << K)));
+          if (it != m_index.end())
+          {
+            visit_in_box(*m_chunks[it->second], lo, hi, f);
+          }
+        }
+      }
+    }
+    else
+    {
+      // Boxes covering more chunk cells than the map has chunks check every
+      // chunk's bounds instead.
+      for (const std::shared_ptr<Chunk> &chunk : m_chunks)
+      {
+        visit_in_box(*chunk, lo, hi, f);
+      }
+    }
+  }
+
+  /// Finds the closest stored value matching the predicate. Chunks are
+  /// searched ring by ring outward from the chunk holding the input
+  /// coordinates, and the search stops once no further ring could hold
+  /// anything closer. Chunks holding no value with any of the input tag bits
+  /// are skipped without being scanned.
+  /// @param[in] from Coordinates to measure from
+  /// @param[in] pred pred(coord, value) is true for values to consider
+  /// @param[out] at Coordinates of the value found
+  /// @param[in] tags Only chunks holding a value with one of these tag bits
+  ///                 are searched
+  /// @return Pointer to one of the closest matching values. Null if none match.
+  template <class P>
+  const T *nearest(const Hex &from, P pred, Hex &at,
+                   const uint32_t tags = ALL_TAGS) const
+  {
+    const T *best = nullptr;
+    int32_t best_distance = 0;
+    auto search = [&](const Chunk &chunk)
+    {
+      if ((0 == (chunk.tags & tags)) ||
+          ((nullptr != best) && (min_distance(chunk, from) >= best_distance)))
+      {
+        return;
+      }
+      for (size_t slot = 0; slot < CHUNK_SLOTS; slot++)
+      {
+        if (!chunk.occupied.test(slot))
+        {
+          continue;
+        }
+        Hex coord = slot_hex(chunk, slot);
+        int32_t distance = from.distance(coord);
+        if (((nullptr == best) || (distance < best_distance)) &&
+            (pred(coord, chunk.slots[slot])))
+        {
+          best = &chunk.slots[slot];
+          best_distance = distance;
+          at = coord;
+        }
+      }
+    };
+
+    const int32_t from_q = from.q() >> K;
+    const int32_t from_r = from.r() >> K;
+    size_t visited = 0;
+    for (int32_t ring = 0; visited < m_chunks.size(); ring++)
+    {
+      // Every coordinate in ring n is at least (n - 1) chunk sides plus one
+      // away along q or r.
+      int32_t bound = (0 == ring ? 0 : ((ring - 1) << K) + 1);
+      if ((nullptr != best) && (bound >= best_distance))
+      {
+        break;
+      }
+      size_t cells = (0 == ring ? 1 : 8 * static_cast<size_t>(ring));
+      if (cells > m_chunks.size() - visited)
+      {
+        // Rings with more cells than the map has unvisited chunks check the
+        // remaining chunks directly instead.
+        for (const std::shared_ptr<Chunk> &chunk : m_chunks)
+        {
+          if (std::max(std::abs(chunk->q - from_q),
+                       std::abs(chunk->r - from_r)) >= ring)
+          {
+            search(*chunk);
+          }
+        }
+        break;
+      }
+      auto probe = [&](const int32_t q, const int32_t r)
+      {
+        auto it = m_index.find(chunk_key(Hex(q << K, r << K)));
+        if (it != m_index.end())
+        {
+          visited++;
+          search(*m_chunks[it->second]);
+        }
+      };
+      if (0 == ring)
+      {
+        probe(from_q, from_r);
+        continue;
+      }
+      for (int32_t q = from_q - ring; q <= from_q + ring; q++)
+      {
+        probe(q, from_r - ring);
+        probe(q, from_r + ring);
+      }
+      for (int32_t r = from_r - ring + 1; r < from_r + ring; r++)
+      {
+        probe(from_q - ring, r);
+        probe(from_q + ring, r);
+      }
+    }
+    return best;
+  }
+
+protected:
+private:
+  static inline int64_t chunk_key(const Hex &coord)
+  {
+    // Arithmetic shifts floor negative coordinates into the right chunk.
+    return (static_cast<int64_t>(coord.q() >> K) << 32) ^
+           static_cast<uint32_t>(coord.r() >> K);
+  }
+  static inline size_t slot_index(const Hex &coord)
+  {
+    return static_cast<size_t>(((coord.r() & CHUNK_MASK) << K) |
+                               (coord.q() & CHUNK_MASK));
+  }
+  static inline Hex slot_hex(const Chunk &chunk, const size_t slot)
+  {
+    return Hex((chunk.q << K) + static_cast<int32_t>(slot & CHUNK_MASK),
+               (chunk.r << K) + static_cast<int32_t>(slot >> K));
+  }
+
+  /// Returns the chunk at the input index for changing, copying it first if
+  /// another store shares it.
+  inline Chunk &own(const size_t idx)
+  {
+    if (m_chunks[idx].use_count() > 1)
+    {
+      m_chunks[idx] = std::make_shared<Chunk>(*m_chunks[idx]);
+    }
+    return *m_chunks[idx];
+  }
+
+  /// Recomputes the chunk's occupied bounds and tags after a slot is cleared.
+  static void update_bounds(Chunk &chunk)
+  {
+    chunk.min_q = chunk.min_r = CHUNK_MASK;
+    chunk.max_q = chunk.max_r = 0;
+    chunk.tags = 0;
+    for (size_t slot = 0; slot < CHUNK_SLOTS; slot++)
+    {
+      if (chunk.occupied.test(slot))
+      {
+        uint8_t local_q = static_cast<uint8_t>(slot & CHUNK_MASK);
+        uint8_t local_r = static_cast<uint8_t>(slot >> K);
+        chunk.min_q = std::min(chunk.min_q, local_q);
+        chunk.max_q = std::max(chunk.max_q, local_q);
+        chunk.min_r = std::min(chunk.min_r, local_r);
+        chunk.max_r = std::max(chunk.max_r, local_r);
+        chunk.tags |= Tag()(chunk.slots[slot]);
+      }
+    }
+  }
+
+  /// Calls f(coord, value) for the chunk's values inside the input box.
+  template <class F>
+  static void visit_in_box(const Chunk &chunk, const Hex &lo, const Hex &hi,
+                           F &f)
+  {
+    int32_t q_min = std::max(lo.q(), (chunk.q << K) + chunk.min_q);
+    int32_t q_max = std::min(hi.q(), (chunk.q << K) + chunk.max_q);
+    int32_t r_min = std::max(lo.r(), (chunk.r << K) + chunk.min_r);
+    int32_t r_max = std::min(hi.r(), (chunk.r << K) + chunk.max_r);
+    for (int32_t r = r_min; r <= r_max; r++)
+    {
+      for (int32_t q = q_min; q <= q_max; q++)
+      {
+        Hex coord(q, r);
+        size_t slot = slot_index(coord);
+        if (chunk.occupied.test(slot))
+        {
+          f(coord, chunk.slots[slot]);
+        }
+      }
+    }
+  }
+
+  /// Lower bound on the distance from the input coordinates to any value in
+  /// the chunk. Hex distance is never less than the q or r difference alone.
+  static int32_t min_distance(const Chunk &chunk, const Hex &from)
+  {
+    int32_t q_min = (chunk.q << K) + chunk.min_q;
+    int32_t q_max = (chunk.q << K) + chunk.max_q;
+    int32_t r_min = (chunk.r << K) + chunk.min_r;
+    int32_t r_max = (chunk.r << K) + chunk.max_r;
+    int32_t dq = std::max({q_min - from.q(), from.q() - q_max, 0});
+    int32_t dr = std::max({r_min - from.r(), from.r() - r_max, 0});
+    return std::max(dq, dr);
+  }
+
+  struct Key_hash
+  {
+    size_t operator()(const int64_t key) const noexcept
+    {
+      return static_cast<size_t>(mix_hash(static_cast<uint64_t>(key)));
+    }
+  };
+
+  std::vector<std::shared_ptr<Chunk>> m_chunks;
+  std::unordered_map<int64_t, uint32_t, Key_hash> m_index;
+  size_t m_size;
+};
+
+/// Box query for stores without any spatial layout: probes each coordinate in
+/// small boxes, and filters a full scan for large ones.
+template <class Store, class F>
+void box_query(const Store &store, const Hex &lo, const Hex &hi, F &f)
+{
+  if ((lo.q() > hi.q()) || (lo.r() > hi.r()))
+  {
+    return;
+  }
+  int64_t area = (static_cast<int64_t>(hi.q()) - lo.q() + 1) *
+                 (static_cast<int64_t>(hi.r()) - lo.r() + 1);
+  if (area <= static_cast<int64_t>(store.size()))
+  {
+    for (int32_t r = lo.r(); r <= hi.r(); r++)
+    {
+      for (int32_t q = lo.q(); q <= hi.q(); q++)
+      {
+        Hex coord(q, r);
+        auto *value = store.find(coord);
+        if (nullptr != value)
+        {
+          f(coord, *value);
+        }
+      }
+    }
+  }
+  else
+  {
+    store.for_each(
+        [&](const Hex &coord, const auto &value)
+        {
+          if ((lo.q() <= coord.q()) && (coord.q() <= hi.q()) &&
+              (lo.r() <= coord.r()) && (coord.r() <= hi.r()))
+          {
+            f(coord, value);
+          }
+        });
+  }
+}
+
+/// Nearest query for stores without any spatial layout: a full scan. These
+/// stores keep no tags, so nearest()'s tag bits are ignored.
+template <class Store, class P>
+const typename Store::value_type *scan_nearest(const Store &store,
+                                               const Hex &from, P &pred,
+                                               Hex &at)
+{
+  const typename Store::value_type *best = nullptr;
+  int32_t best_distance = 0;
+  store.for_each(
+      [&](const Hex &coord, const auto &value)
+      {
+        int32_t distance = from.distance(coord);
+        if (((nullptr == best) || (distance < best_distance)) &&
+            (pred(coord, value)))
+        {
+          best = &value;
+          best_distance = distance;
+          at = coord;
+        }
+      });
+  return best;
+}
+
+/// Ordered-tree storage. This was the map's original layout and is kept as
+/// the reference backend.
+template <class T> class Tree_store
+{
+public:
+  using value_type = T;
+
+  inline size_t size() const { return m_map.size(); }
+  inline bool empty() const { return m_map.empty(); }
+  inline void clear() { m_map.clear(); }
+  inline bool contains(const Hex &coord) const
+  {
+    return m_map.contains(coord);
+  }
+
+  T *find(const Hex &coord)
+  {
+    auto it = m_map.find(coord);
+    return (it == m_map.end() ? nullptr : &it->second);
+  }
+  const T *find(const Hex &coord) const
+  {
+    auto it = m_map.find(coord);
+    return (it == m_map.end() ? nullptr : &it->second);
+  }
+
+  bool insert(const Hex &coord, T value)
+  {
+    return m_map.insert({coord, std::move(value)}).second;
+  }
+  bool erase(const Hex &coord) { return 0 != m_map.erase(coord); }
+
+  template <class F> void for_each(F f) const
+  {
+    for (const auto &item : m_map)
+    {
+      f(item.first, item.second);
+    }
+  }
+  template <class F> void for_each(F f)
+  {
+    for (auto &item : m_map)
+    {
+      f(item.first, item.second);
+    }
+  }
+
+  template <class F>
+  void for_each_in_box(const Hex &lo, const Hex &hi, F f) const
+  {
+    // Coordinates are ordered by q, then r, so each column is a contiguous
+    // run.
+    for (int32_t q = lo.q(); q <= hi.q(); q++)
+    {
+      for (auto it = m_map.lower_bound(Hex(q, lo.r()));
+           (it != m_map.end()) && (it->first.q() == q) &&
+           (it->first.r() <= hi.r());
+           it++)
+      {
+        f(it->first, it->second);
+      }
+    }
+  }
+
+  template <class P>
+  const T *nearest(const Hex &from, P pred, Hex &at,
+                   const uint32_t = ALL_TAGS) const
+  {
+    return scan_nearest(*this, from, pred, at);
+  }
+
+protected:
+private:
+  std::map<Hex, T> m_map;
+};
+/// Chained hash-table storage (std::unordered_map keyed on the mixed Hex
+/// hash).
+template <class T> class Hashed_store
+{
+public:
+  using value_type = T;
+
+  inline size_t size() const { return m_map.size(); }
+  inline bool empty() const { return m_map.empty(); }
+  inline void clear() { m_map.clear(); }
+  inline bool contains(const Hex &coord) const
+  {
+    return m_map.contains(coord);
+  }
+
+  T *find(const Hex &coord)
+  {
+    auto it = m_map.find(coord);
+    return (it == m_map.end() ? nullptr : &it->second);
+  }
+  const T *find(const Hex &coord) const
+  {
+    auto it = m_map.find(coord);
+    return (it == m_map.end() ? nullptr : &it->second);
+  }
+
+  bool insert(const Hex &coord, T value)
+  {
+    return m_map.insert({coord, std::move(value)}).second;
+  }
+  bool erase(const Hex &coord) { return 0 != m_map.erase(coord); }
+
+  template <class F> void for_each(F f) const
+  {
+    for (const auto &item : m_map)
+    {
+      f(item.first, item.second);
+    }
+  }
+  template <class F> void for_each(F f)
+  {
+    for (auto &item : m_map)
+    {
+      f(item.first, item.second);
+    }
+  }
+
+  template <class F>
+  void for_each_in_box(const Hex &lo, const Hex &hi, F f) const
+  {
+    box_query(*this, lo, hi, f);
+  }
+
+  template <class P>
+  const T *nearest(const Hex &from, P pred, Hex &at,
+                   const uint32_t = ALL_TAGS) const
+  {
+    return scan_nearest(*this, from, pred, at);
+  }
+
+protected:
+private:
+  std::unordered_map<Hex, T> m_map;
+};
+
+/// Open-addressing hash-table storage. Keys and values sit in flat arrays
+/// probed linearly from the key's mixed hash; removal shifts later entries
+/// back rather than leaving tombstones.
+template <class T> class Flat_store
+{
+public:
+  using value_type = T;
+
+  Flat_store() : m_size(0) {}
+
+  inline size_t size() const { return m_size; }
+  inline bool empty() const { return 0 == m_size; }
+  inline void clear()
+  {
+    m_keys.clear();
+    m_used.clear();
+    m_values.clear();
+    m_size = 0;
+  }
+  inline bool contains(const Hex &coord) const
+  {
+    return nullptr != find(coord);
+  }
+
+  T *find(const Hex &coord)
+  {
+    size_t slot = 0;
+    return (probe(coord, slot) ? &m_values[slot] : nullptr);
+  }
+  const T *find(const Hex &coord) const
+  {
+    size_t slot = 0;
+    return (probe(coord, slot) ? &m_values[slot] : nullptr);
+  }
+
+  bool insert(const Hex &coord, T value)
+  {
+    // Keep the table at most 3/4 full so probe runs stay short.
+    if ((m_size + 1) * 4 > m_keys.size() * 3)
+    {
+      grow();
+    }
+    size_t slot = 0;
+    if (probe(coord, slot))
+    {
+      return false;
+    }
+    m_keys[slot] = coord;
+    m_used[slot] = true;
+    m_values[slot] = std::move(value);
+    m_size++;
+    return true;
+  }
+
+  bool erase(const Hex &coord)
+  {
+    size_t slot = 0;
+    if (!probe(coord, slot))
+    {
+      return false;
+    }
+    // Shift back any entries whose probe run passed through the freed slot.
+    size_t mask = m_keys.size() - 1;
+    size_t next = slot;
+    while (true)
+    {
+      next = (next + 1) & mask;
+      if (!m_used[next])
+      {
+        break;
+      }
+      size_t home = m_keys[next].hash() & mask;
+      if (((next - home) & mask) >= ((next - slot) & mask))
+      {
+        m_keys[slot] = m_keys[next];
+        m_values[slot] = std::move(m_values[next]);
+        slot = next;
+      }
+    }
+    m_used[slot] = false;
+    m_values[slot] = T();
+    m_size--;
+    return true;
+  }
+
+  template <class F> void for_each(F f) const
+  {
+    for (size_t slot = 0; slot < m_keys.size(); slot++)
+    {
+      if (m_used[slot])
+      {
+        f(m_keys[slot], m_values[slot]);
+      }
+    }
+  }
+  template <class F> void for_each(F f)
+  {
+    for (size_t slot = 0; slot < m_keys.size(); slot++)
+    {
+      if (m_used[slot])
+      {
+        f(m_keys[slot], m_values[slot]);
+      }
+    }
+  }
+
+  template <class F>
+  void for_each_in_box(const Hex &lo, const Hex &hi, F f) const
+  {
+    box_query(*this, lo, hi, f);
+  }
+
+  template <class P>
+  const T *nearest(const Hex &from, P pred, Hex &at,
+                   const uint32_t = ALL_TAGS) const
+  {
+    return scan_nearest(*this, from, pred, at);
+  }
+
+protected:
+private:
+  /// Looks for the key's slot.
+  /// @param[in] coord
+  /// @param[out] slot The key's slot if found; otherwise the empty slot it
+  /// would be placed in.
+  /// @return true if the key was found
+  bool probe(const Hex &coord, size_t &slot) const
+  {
+    if (m_keys.empty())
+    {
+      return false;
+    }
+    size_t mask = m_keys.size() - 1;
+    for (slot = coord.hash() & mask; m_used[slot]; slot = (slot + 1) & mask)
+    {
+      if (m_keys[slot] == coord)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void grow()
+  {
+    std::vector<Hex> keys(std::max<size_t>(16, m_keys.size() * 2));
+    std::vector<uint8_t> used(keys.size(), false);
+    std::vector<T> values(keys.size());
+    keys.swap(m_keys);
+    used.swap(m_used);
+    values.swap(m_values);
+    m_size = 0;
+    for (size_t slot = 0; slot < keys.size(); slot++)
+    {
+      if (used[slot])
+      {
+        insert(keys[slot], std::move(values[slot]));
+      }
+    }
+  }
+
+  std::vector<Hex> m_keys;
+  std::vector<uint8_t> m_used;
+  std::vector<T> m_values;
+  size_t m_size;
+};
+
+/// Walks a range of coordinates (see Hex_range.h), yielding only the values
+/// stored at occupied ones, passed through the Proj projection. Nothing is
+/// copied or allocated; each step is a single store lookup.
+template <class Store, class Region, class Proj = std::identity>
+class Occupied_view
+    : public std::ranges::view_interface<Occupied_view<Store, Region, Proj>>
+{
+public:
+  using pointer = decltype(std::declval<Store &>().find(std::declval<Hex>()));
+
+  class iterator
+  {
+  public:
+    using value_type = std::remove_cvref_t<
+        std::invoke_result_t<const Proj &, decltype(*std::declval<pointer>())>>;
+    using difference_type = std::ptrdiff_t;
+
+    iterator() = default;
+    iterator(Store *store, const Region &region)
+        : m_store(store), m_it(std::ranges::begin(region)),
+          m_end(std::ranges::end(region)), m_found(nullptr)
+    {
+      skip();
+    }
+
+    decltype(auto) operator*() const { return std::invoke(Proj(), *m_found); }
+    iterator &operator++()
+    {
+      ++m_it;
+      skip();
+      return *this;
+    }
+    iterator operator++(int)
+    {
+      iterator prev = *this;
+      ++(*this);
+      return prev;
+    }
+    bool operator==(const iterator &other) const
+    {
+      return m_found == other.m_found;
+    }
+    bool operator==(std::default_sentinel_t) const
+    {
+      return nullptr == m_found;
+    }
+
+  private:
+    /// Moves forward to the next occupied coordinates, if any.
+    void skip()
+    {
+      m_found = nullptr;
+      for (; m_it != m_end; ++m_it)
+      {
+        m_found = m_store->find(*m_it);
+        if (nullptr != m_found)
+        {
+          return;
+        }
+      }
+    }
+
+    Store *m_store = nullptr;
+    std::ranges::iterator_t<const Region> m_it;
+    std::ranges::sentinel_t<const Region> m_end;
+    pointer m_found = nullptr;
+  };
+
+  Occupied_view() = default;
+  Occupied_view(Store &store, const Region region)
+      : m_store(&store), m_region(region)
+  {
+  }
+
+  iterator begin() const { return iterator(m_store, m_region); }
+  std::default_sentinel_t end() const { return {}; }
+
+private:
+  Store *m_store = nullptr;
+  Region m_region;
+};
+} // namespace tile
+
+#endif
@@ -20,16 +20,18 @@
 #include <tiles/Tile.h>
 #include <tiles/components/Area.h>
 #include <tiles/components/Border.h>
+#include <tiles/components/Hex.h>
+#include <tiles/components/Rotation.h>
 #include <utils/id_utils.h>
 
 namespace tile
 {
-Area::Area(std::set<Border> borders, tile::Tile *parent)
+Area::Area(Border_mask borders, tile::Tile *parent)
     : m_borders(borders), m_parent(parent)
 {
 }
 
-Area::Area(std::set<Border> borders, std::set<Border> roads,
+Area::Area(Border_mask borders, Border_mask roads,
            std::unique_ptr<building::Building> &building,
            portable::Cache &resources, tile::Tile *parent)
     : m_roads(roads), m_borders(borders), m_building(std::move(building)),
@@ -39,9 +41,15 @@ Area::Area(std::set<Border> borders, std::set<Border> roads,
 
 Area::Area(const Area &other)
     : m_borders(other.m_borders), m_roads(other.m_roads),
-      m_building(std::move(other.m_building.get())),
       m_resources(other.m_resources), m_parent(other.m_parent)
 {
+  // Each area owns its building, so the copy gets its own.
+  if (other.m_building)
+  {
+    building::Building::Type bldg_type = other.m_building->get_type();
+    (void)building::make_building(bldg_type, m_building,
+                                  other.m_building.get());
+  }
 }
 
 Area::Area() {}
@@ -76,33 +84,29 @@ Area Area::operator=(const Area &other)
   return (*this);
 }
 
-bool Area::operator==(Area &other)
-{
-  return ((other.m_borders == m_borders) && (other.m_roads == m_roads) &&
-          (other.m_building == m_building) &&
-          (other.m_resources == m_resources) && (other.m_parent == m_parent));
-}
 bool Area::operator==(Area const &other) const
 {
   return ((other.m_borders == m_borders) && (other.m_roads == m_roads) &&
           (other.m_building == m_building) &&
           (other.m_resources == m_resources) && (other.m_parent == m_parent));
 }
-bool Area::operator==(std::set<Border> &borders)
+bool Area::operator==(Border_mask const borders) const
 {
   return m_borders == borders;
 }
-bool Area::operator==(std::set<Border> const &borders) const
-{
-  return m_borders == borders;
-}
-bool Area::operator!=(Area &other) { return !(*this == other); }
 bool Area::operator!=(Area const &other) const { return !(*this == other); }
-bool Area::operator!=(std::set<Border> &borders) { return !(*this == borders); }
-bool Area::operator!=(std::set<Border> const &borders) const
+bool Area::operator!=(Border_mask const borders) const
 {
   return !(*this == borders);
 }
+uint64_t Area::fingerprint() const
+{
+  uint64_t building =
+      m_building ? static_cast<uint64_t>(1 + m_building->get_type()) : 0;
+  return mix_hash((uint64_t{2} << 56) | (building << 32) |
+                  (uint64_t{m_roads.bits()} << 16) | m_borders.bits());
+}
+
 bool Area::operator<(Area const &other) const
 {
   return m_borders.size() < other.m_borders.size();
@@ -120,59 +124,36 @@ bool Area::operator>(Area &other)
   return m_borders.size() > other.m_borders.size();
 }
 
-void Area::operator+=(const std::vector<portable::Resource *> &res_list)
+void Area::operator+=(const std::vector<portable::Resource> &res_list)
 {
   m_resources += res_list;
 }
 
-template <typename Iter> bool Area::has_borders(Iter begin, Iter end)
+void Area::operator+=(const portable::Cache &resources)
 {
-  while (begin != end)
-  {
-    if (!m_borders.contains(*begin))
-    {
-      return false;
-    }
-    ++begin;
-  }
-  return true;
+  m_resources += resources;
 }
 
-bool Area::contains(const Area other)
+bool Area::contains(const Area &other) const
 {
-  return has_borders<std::set<Border>::iterator>(other.m_borders.begin(),
-                                                 other.m_borders.end());
+  return has_borders(other.m_borders);
 }
 
-bool Area::does_share_direction(const Direction dir)
+bool Area::does_share_direction(const Direction dir) const
 {
-  std::set<Direction> checked;
-
-  for (Border b : m_borders)
-  {
-    Direction border_direction = direction_from_border(b);
-    if ((border_direction == dir) && (!checked.contains(border_direction)))
-    {
-      return true;
-    }
-    checked.insert(border_direction);
-  }
-  return false;
+  return !(m_borders & side_borders(dir)).empty();
 }
 
-bool Area::can_build_road(const Border b)
+bool Area::can_build_road(const Border b) const
 {
   if ((!m_borders.contains(b)) || (m_roads.contains(b)))
   {
     return false;
   }
 
-  Direction d = direction_from_border(b);
-  std::vector<Border> both = borders_from_direction(d);
-  bool has_both_borders =
-      ((m_borders.contains(both.at(0))) && (m_borders.contains(both.at(1))));
-  bool direction_has_road =
-      ((m_roads.contains(both.at(0))) || (m_roads.contains(both.at(1))));
+  Border_mask both = side_borders(direction_from_border(b));
+  bool has_both_borders = m_borders.includes(both);
+  bool direction_has_road = !(m_roads & both).empty();
 
   // If the border isn't split by a river, only allow 1 road to be built
   // between both borders in that direction.
@@ -215,26 +196,7 @@ common::Error Area::rotate(int rotations)
     return common::ERR_FAIL;
   }
 
-  // Making 0 rotations doesn't do anything...
-  if (0 != rotations)
-  {
-    bool is_clockwise = (0 < rotations);
-    rotations = abs(rotations) % MAX_DIRECTIONS;
-    rotations = (is_clockwise ? rotations : (MAX_DIRECTIONS - rotations));
-    // Two borders makes up one direction. Rotating an area is done by
-    // direction; hence rotating for two borders.
-    rotations *= 2;
-
-    std::vector<Border> tmp_borders;
-    for (auto b : m_borders)
-    {
-      Border rotated = static_cast<Border>((rotations + b) % MAX_BORDERS);
-      tmp_borders.push_back(rotated);
-    }
-    m_borders.clear();
-    m_borders.insert(tmp_borders.begin(), tmp_borders.end());
-  }
-
+  m_borders = rotated(m_borders, clockwise_steps(rotations));
   return common::ERR_NONE;
 }
 
@@ -268,8 +230,8 @@ common::Error Area::load_building(const nlohmann::json &j)
 
 std::ostream &operator<<(std::ostream &os, tile::Area const &a)
 {
-  std::set<tile::Border> bdrs = a.get_borders();
-  std::set<tile::Border> rds = a.get_roads();
+  tile::Border_mask bdrs = a.get_borders();
+  tile::Border_mask rds = a.get_roads();
   std::vector<tile::Border> borders(bdrs.begin(), bdrs.end());
   std::vector<tile::Border> roads(rds.begin(), rds.end());
   os << "<Area::borders=[" << borders.at(0);
@@ -306,24 +268,8 @@ std::ostream &operator<<(std::ostream &os, tile::Area const &a)
 
 void to_json(nlohmann::json &j, const Area &area)
 {
-  // List borders
-  for (auto border : area.m_borders)
-  {
-    nlohmann::json b;
-    to_json(b, border);
-    j["borders"].push_back(border);
-  }
-  if (area.m_roads.size() == 0)
-  {
-    j["roads"] = nlohmann::json::array();
-  }
-  else
-  {
-    for (auto road : area.m_roads)
-    {
-      j["roads"].push_back(to_string(road));
-    }
-  }
+  j["borders"] = area.m_borders;
+  j["roads"] = area.m_roads;
 
   // List building if found
   if (nullptr != area.m_building)
@@ -343,7 +289,7 @@ void to_json(nlohmann::json &j, const Area &area)
 
 void from_json(const nlohmann::json &j, Area &area)
 {
-  std::set<Border> borders;
+  Border_mask borders;
   for (auto b : j.at("borders").get<std::vector<Border>>())
   {
     if (Border::invalid_border == b)
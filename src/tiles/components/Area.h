@@ -1,7 +1,8 @@
 #ifndef SECTION_H
 #define SECTION_H
 
-#include <set>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include <nlohmann/json.hpp>
@@ -22,8 +23,8 @@ class Tile;
 class Area
 {
 public:
-  Area(std::set<Border> borders, tile::Tile *parent = nullptr);
-  Area(std::set<Border> borders, std::set<Border> roads,
+  Area(Border_mask borders, tile::Tile *parent = nullptr);
+  Area(Border_mask borders, Border_mask roads,
        std::unique_ptr<building::Building> &building,
        portable::Cache &resources, tile::Tile *parent = nullptr);
   Area(const Area &other);
@@ -33,42 +34,53 @@ public:
   /// Clears the area of all roads/buildings/resources
   void clear();
 
-  /// Resets the area for a new round
+  /// Resets the area for a new round. Tile_map::next_phase() does the same
+  /// for the resources of every area on a map at once.
   void reset();
 
   Area operator=(const Area &other);
-  Area operator+(std::vector<portable::Resource *> res_list) const;
 
-  bool operator==(std::set<Border> &borders);
-  bool operator==(std::set<Border> const &borders) const;
-  bool operator==(Area &other);
+  bool operator==(Border_mask const borders) const;
   bool operator==(Area const &other) const;
-  bool operator!=(std::set<Border> &borders);
-  bool operator!=(std::set<Border> const &borders) const;
-  bool operator!=(Area &other);
+  bool operator!=(Border_mask const borders) const;
   bool operator!=(Area const &other) const;
   bool operator<(Area const &other) const;
   bool operator<(Area &other);
   bool operator>(Area const &other) const;
   bool operator>(Area &other);
 
-  void operator+=(const std::vector<portable::Resource *> &res_list);
+  void operator+=(const std::vector<portable::Resource> &res_list);
+  void operator+=(const portable::Cache &resources);
 
   inline void set_parent(tile::Tile *parent) { m_parent = parent; }
 
-  inline bool has_border(const Border b) { return m_borders.contains(b); }
-  template <typename Iter> bool has_borders(Iter begin, Iter end);
-  inline bool has_road(const Border b) { return m_roads.contains(b); }
-  inline std::set<Border> get_borders() { return m_borders; }
-  inline std::set<Border> get_borders() const { return m_borders; }
-  inline std::set<Border> get_roads() { return m_roads; }
-  inline std::set<Border> get_roads() const { return m_roads; }
+  /// Attaches the area's resources to its game's phase clock
+  /// @param[in] clock
+  inline void set_phase_clock(const portable::Phase_clock *clock)
+  {
+    m_resources.set_clock(clock);
+  }
+
+  inline bool has_border(const Border b) const
+  {
+    return m_borders.contains(b);
+  }
+  inline bool has_borders(const Border_mask borders) const
+  {
+    return m_borders.includes(borders);
+  }
+  inline bool has_road(const Border b) const { return m_roads.contains(b); }
+  inline Border_mask get_borders() const { return m_borders; }
+  inline Border_mask get_roads() const { return m_roads; }
   inline building::Building *get_building() const { return m_building.get(); };
-  inline std::vector<portable::Resource *> get_resources()
+  /// Returns a 64-bit fingerprint of the area's borders, roads and building.
+  /// Resources come and go every round, so they're left out.
+  uint64_t fingerprint() const;
+  inline portable::Cache::View get_resources() const
   {
-    return m_resources.all();
+    return m_resources.view();
   }
-  inline std::vector<portable::Resource *>
+  inline std::vector<portable::Resource>
   get_moveable_resources(const player::Color player)
   {
     return m_resources.all_moveable(player);
@@ -83,16 +95,24 @@ public:
   }
 
   inline bool has_resources() const { return m_resources.size() > 0; }
+  inline const portable::Cache &get_resource_cache() const
+  {
+    return m_resources;
+  }
+  inline const portable::Cache::Counts &get_resource_counts() const
+  {
+    return m_resources.counts();
+  }
 
   /// Checks to see if input Area is contained within this Area.
   /// @param[in] other
   /// @return true, false
-  bool contains(const Area other);
+  bool contains(const Area &other) const;
 
   /// Checks to see if one of the area's borders is in the input direction
   /// @param[in] dir
   /// @return boolean for whether the area does include the input direction
-  bool does_share_direction(const Direction dir);
+  bool does_share_direction(const Direction dir) const;
 
   /// Checks to see if building can be built with the given resources on the
   /// input tile.
@@ -105,7 +125,7 @@ public:
     return B::can_build(m_resources, m_parent);
   }
 
-  bool can_build_road(const Border b);
+  bool can_build_road(const Border b) const;
 
   /// Adds building to this area
   /// @param[in] bldg Desired building to add to the area.
@@ -141,7 +161,7 @@ public:
   /// @return
   ///   - common::ERR_NONE on success
   ///   - common::ERR_INVALID if the input is invalid
-  common::Error add_resource(portable::Resource *res)
+  common::Error add_resource(const portable::Resource res)
   {
     return m_resources.add(res);
   }
@@ -151,11 +171,35 @@ public:
   /// @return
   ///   - common::ERR_NONE on success
   ///   - common::ERR_INVALID if the input is invalid
-  common::Error add_resource(std::vector<portable::Resource *> &res_list)
+  common::Error add_resource(const std::vector<portable::Resource> &res_list)
   {
     return m_resources.add(res_list);
   }
 
+  /// Moves every resource of the input cache into the area, leaving the
+  /// cache empty.
+  /// @param[in] resources  Resources to move in
+  void merge_resources(portable::Cache &&resources)
+  {
+    m_resources.merge_from(std::move(resources));
+  }
+
+  /// Moves some of a resource from another area into this one, keeping track
+  /// of who's carried them.
+  /// @param[in] res  Resource type to move
+  /// @param[in] amount  Amount of resource to move
+  /// @param[in] other  Area to move the resources out of
+  /// @return
+  ///   - common::ERR_NONE on success
+  ///   - common::ERR_INVALID on invalid resource specified, or if other is
+  ///   this area
+  ///   - common::ERR_FAIL if insufficient resource amount in other
+  common::Error splice_resource(const portable::Resource::Type res,
+                                const uint16_t amount, Area &other)
+  {
+    return m_resources.splice(res, amount, other.m_resources);
+  }
+
   /// Removes resource from the area
   /// @param[in] res  Resource type to remove
   /// @param[in] amount  Amount of resource to remove
@@ -177,10 +221,9 @@ public:
   ///   - common::ERR_NONE on success
   ///   - common::ERR_FAIL if insufficient resource amount to remove
   ///   - common::ERR_INVALID on invalid resource specified
-  common::Error
-  get_resource(const portable::Resource::Type res_type,
-               std::vector<std::unique_ptr<portable::Resource>> &result,
-               const uint16_t amount = 1)
+  common::Error get_resource(const portable::Resource::Type res_type,
+                             std::vector<portable::Resource> &result,
+                             const uint16_t amount = 1)
   {
     return m_resources.get(res_type, result, amount);
   }
@@ -194,10 +237,10 @@ public:
   ///   - common::ERR_NONE on success
   ///   - common::ERR_FAIL on insufficient resources in cache
   ///   - common::ERR_INVALID on invalid resource type requested
-  common::Error
-  get_resource(const portable::Resource::Type res_type, const player::Color clr,
-               std::vector<std::unique_ptr<portable::Resource>> &result,
-               const uint16_t amount = 1)
+  common::Error get_resource(const portable::Resource::Type res_type,
+                             const player::Color clr,
+                             std::vector<portable::Resource> &result,
+                             const uint16_t amount = 1)
   {
     return m_resources.get(res_type, clr, result, amount);
   }
@@ -222,8 +265,8 @@ public:
 
 protected:
 private:
-  std::set<Border> m_borders;
-  std::set<Border> m_roads;
+  Border_mask m_borders;
+  Border_mask m_roads;
   std::unique_ptr<building::Building> m_building;
   portable::Cache m_resources;
   tile::Tile *m_parent;
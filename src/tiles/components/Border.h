@@ -1,15 +1,218 @@
 #ifndef BORDER_H
 #define BORDER_H
 
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <initializer_list>
 #include <iostream>
-#include <set>
+#include <iterator>
 #include <string>
 #include <vector>
 
+#include <nlohmann/json.hpp>
+
 #include <common/Errors.h>
 
 namespace tile
 {
+/// Set of enum values packed into a single integer, one bit per value. It
+/// keeps the parts of std::set's interface the tile code uses, and iterates
+/// its values in ascending order like a std::set would. Values outside
+/// [0, N) are never stored.
+template <class E, class Bits, uint8_t N> class Enum_mask
+{
+public:
+  using value_type = E;
+  using size_type = size_t;
+
+  class iterator
+  {
+  public:
+    using value_type = E;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = E;
+    using iterator_category = std::forward_iterator_tag;
+
+    constexpr iterator() = default;
+    constexpr explicit iterator(const Bits bits) : m_bits(bits) {}
+
+    constexpr E operator*() const
+    {
+      return static_cast<E>(std::countr_zero(m_bits));
+    }
+    constexpr iterator &operator++()
+    {
+      m_bits = static_cast<Bits>(m_bits & (m_bits - 1));
+      return *this;
+    }
+    constexpr iterator operator++(int)
+    {
+      iterator prev = *this;
+      ++(*this);
+      return prev;
+    }
+    constexpr bool operator==(const iterator &other) const = default;
+
+  private:
+    Bits m_bits = 0;
+  };
+  using const_iterator = iterator;
+
+  /// Mask with every valid bit set.
+  static constexpr Bits FULL = static_cast<Bits>((1u << N) - 1);
+
+  constexpr Enum_mask() = default;
+  constexpr Enum_mask(std::initializer_list<E> values)
+  {
+    for (E value : values)
+    {
+      insert(value);
+    }
+  }
+  template <class Iter> constexpr Enum_mask(Iter first, Iter last)
+  {
+    for (; first != last; ++first)
+    {
+      insert(*first);
+    }
+  }
+
+  /// Builds a mask straight from its bits; bits past N are dropped.
+  /// @param[in] bits
+  /// @return The mask
+  static constexpr Enum_mask from_bits(const Bits bits)
+  {
+    Enum_mask retval;
+    retval.m_bits = static_cast<Bits>(bits & FULL);
+    return retval;
+  }
+  constexpr Bits bits() const { return m_bits; }
+
+  constexpr iterator begin() const { return iterator(m_bits); }
+  constexpr iterator end() const { return iterator(); }
+  constexpr bool empty() const { return 0 == m_bits; }
+  constexpr size_t size() const { return std::popcount(m_bits); }
+
+  constexpr bool contains(const E value) const
+  {
+    return (is_bit(value)) && (0 != (m_bits & bit(value)));
+  }
+  constexpr size_t count(const E value) const { return contains(value); }
+
+  /// Adds the value to the mask.
+  /// @param[in] value
+  /// @return true if the value wasn't in the mask yet
+  constexpr bool insert(const E value)
+  {
+    if ((!is_bit(value)) || (contains(value)))
+    {
+      return false;
+    }
+    m_bits = static_cast<Bits>(m_bits | bit(value));
+    return true;
+  }
+  template <class Iter> constexpr void insert(Iter first, Iter last)
+  {
+    for (; first != last; ++first)
+    {
+      insert(*first);
+    }
+  }
+
+  /// Removes the value from the mask.
+  /// @param[in] value
+  /// @return Number of values removed (0 or 1)
+  constexpr size_t erase(const E value)
+  {
+    if (!contains(value))
+    {
+      return 0;
+    }
+    m_bits = static_cast<Bits>(m_bits & ~bit(value));
+    return 1;
+  }
+  constexpr void clear() { m_bits = 0; }
+
+  /// Checks whether every value in the input mask is in this one.
+  constexpr bool includes(const Enum_mask other) const
+  {
+    return (other.m_bits & m_bits) == other.m_bits;
+  }
+
+  constexpr Enum_mask operator|(const Enum_mask other) const
+  {
+    return from_bits(m_bits | other.m_bits);
+  }
+  constexpr Enum_mask operator&(const Enum_mask other) const
+  {
+    return from_bits(m_bits & other.m_bits);
+  }
+  /// Values in this mask that aren't in the other one.
+  constexpr Enum_mask operator-(const Enum_mask other) const
+  {
+    return from_bits(m_bits & ~other.m_bits);
+  }
+  constexpr Enum_mask operator~() const { return from_bits(~m_bits); }
+  constexpr Enum_mask &operator|=(const Enum_mask other)
+  {
+    m_bits = static_cast<Bits>(m_bits | other.m_bits);
+    return *this;
+  }
+  constexpr Enum_mask &operator&=(const Enum_mask other)
+  {
+    m_bits = static_cast<Bits>(m_bits & other.m_bits);
+    return *this;
+  }
+
+  constexpr bool operator==(const Enum_mask &other) const = default;
+  /// Orders masks the same way std::set orders its contents: by comparing
+  /// their values in ascending order, element by element.
+  constexpr bool operator<(const Enum_mask &other) const
+  {
+    return std::lexicographical_compare(begin(), end(), other.begin(),
+                                        other.end());
+  }
+
+private:
+  static constexpr bool is_bit(const E value)
+  {
+    return (0 <= static_cast<int>(value)) && (N > static_cast<int>(value));
+  }
+  static constexpr Bits bit(const E value)
+  {
+    return static_cast<Bits>(1u << static_cast<int>(value));
+  }
+
+  Bits m_bits = 0;
+};
+
+/// Masks are written to JSON as an array of their values.
+template <class E, class Bits, uint8_t N>
+void to_json(nlohmann::json &j, const Enum_mask<E, Bits, N> &mask)
+{
+  j = nlohmann::json::array();
+  for (E value : mask)
+  {
+    j.push_back(value);
+  }
+}
+template <class E, class Bits, uint8_t N>
+void from_json(const nlohmann::json &j, Enum_mask<E, Bits, N> &mask)
+{
+  mask.clear();
+  for (const nlohmann::json &item : j)
+  {
+    // Lists were sets before they were masks, so repeats just collapse.
+    E value = item.get<E>();
+    if ((!mask.insert(value)) && (!mask.contains(value)))
+    {
+      throw nlohmann::json::type_error::create(501, "Invalid value in list!",
+                                               j);
+    }
+  }
+}
 
 enum Direction
 {
@@ -36,8 +239,10 @@ static bool is_valid(const Direction d)
 {
   return ((0 <= d) && (MAX_DIRECTIONS > d));
 }
-static const std::set<Direction> ALL_DIRECTIONS = {
-    north_west, north_east, east, south_east, south_west, west};
+/// Set of directions, e.g. a tile's river points.
+using Direction_mask = Enum_mask<Direction, uint8_t, MAX_DIRECTIONS>;
+static constexpr Direction_mask ALL_DIRECTIONS =
+    Direction_mask::from_bits(Direction_mask::FULL);
 static std::string to_string(const Direction d)
 {
   if (is_valid(d))
@@ -84,9 +289,10 @@ static const std::string BORDER_NAMES[MAX_BORDERS]{
     "north_east_right", "east_left",        "east_right",
     "south_east_left",  "south_east_right", "south_west_left",
     "south_west_right", "west_left",        "west_right"};
-static const std::set<Border> ALL_BORDERS = {
-    NW_left, NW_right, NE_left, NE_right, E_left, E_right,
-    SE_left, SE_right, SW_left, SW_right, W_left, W_right};
+/// Set of borders, e.g. an area's borders or roads.
+using Border_mask = Enum_mask<Border, uint16_t, MAX_BORDERS>;
+static constexpr Border_mask ALL_BORDERS =
+    Border_mask::from_bits(Border_mask::FULL);
 NLOHMANN_JSON_SERIALIZE_ENUM(Border, {{invalid_border, nullptr},
                                       {NW_left, BORDER_NAMES[NW_left]},
                                       {NW_right, BORDER_NAMES[NW_right]},
@@ -135,6 +341,16 @@ static std::vector<Border> borders_from_direction(const Direction d)
   return borders;
 }
 
+/// Both borders on the input side of a tile, as a mask.
+static constexpr Border_mask side_borders(const Direction d)
+{
+  if (!((0 <= d) && (MAX_DIRECTIONS > d)))
+  {
+    return Border_mask();
+  }
+  return Border_mask::from_bits(static_cast<uint16_t>(0x3u << (2 * d)));
+}
+
 static Border border_from_string(const std::string str)
 {
   for (uint8_t i = 0; i < MAX_BORDERS; i++)
@@ -1,6 +1,7 @@
 #ifndef HEX_H
 #define HEX_H
 
+#include <cstdint>
 #include <sstream>
 
 #include <nlohmann/json.hpp>
@@ -15,56 +16,124 @@
 
 namespace tile
 {
+/// Scrambles a 64-bit key so every input bit affects every output bit
+/// (splitmix64's finalizer). It's a bijection, so distinct keys never collide
+/// before being reduced to a bucket.
+/// @param[in] x
+/// @return The mixed key
+constexpr uint64_t mix_hash(uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
 class Hex
 {
 public:
-  Hex();
-  Hex(const int q, const int r);
-  Hex(const Hex &other);
-  virtual ~Hex();
-
-  inline int q() { return m_q; }
-  inline int r() { return m_r; }
-  inline int s() { return -m_q - m_r; }
-
-  inline int q() const { return m_q; }
-  inline int r() const { return m_r; }
-  inline int s() const { return -m_q - m_r; }
-
-  Hex operator=(const Hex &other);
-  Hex operator+(const Hex &other) const;
-  Hex operator-(const Hex &other) const;
-
-  bool operator==(Hex &other);
-  bool operator==(const Hex &other) const;
-  bool operator!=(const Hex &other) const;
-  bool operator!=(Hex &other);
-  void operator+=(Hex const &other);
-  void operator-=(Hex const &other);
-  bool operator<(Hex const &other) const;
-  bool operator<(Hex &other);
-  bool operator>(Hex const &other) const;
-  bool operator>(Hex &other);
+  constexpr Hex() : m_q(0), m_r(0) {}
+  constexpr Hex(const int q, const int r) : m_q(q), m_r(r) {}
+  constexpr Hex(const Hex &other) : m_q(other.m_q), m_r(other.m_r) {}
+
+  constexpr inline int q() { return m_q; }
+  constexpr inline int r() { return m_r; }
+  constexpr inline int s() { return -m_q - m_r; }
+
+  constexpr inline int q() const { return m_q; }
+  constexpr inline int r() const { return m_r; }
+  constexpr inline int s() const { return -m_q - m_r; }
+
+  constexpr Hex operator=(const Hex &other)
+  {
+    m_q = other.m_q;
+    m_r = other.m_r;
+    return (*this);
+  }
+  constexpr Hex operator+(const Hex &other) const
+  {
+    return Hex(m_q + other.m_q, m_r + other.m_r);
+  }
+  constexpr Hex operator-(const Hex &other) const
+  {
+    return Hex(m_q - other.m_q, m_r - other.m_r);
+  }
+
+  constexpr bool operator==(Hex &other)
+  {
+    return ((m_q == other.m_q) && (m_r == other.m_r));
+  }
+  constexpr bool operator==(const Hex &other) const
+  {
+    return ((m_q == other.m_q) && (m_r == other.m_r));
+  }
+  constexpr bool operator!=(const Hex &other) const
+  {
+    return !(*this == other);
+  }
+  constexpr bool operator!=(Hex &other) { return !(*this == other); }
+  constexpr void operator+=(Hex const &other)
+  {
+    m_q += other.m_q;
+    m_r += other.m_r;
+  }
+  constexpr void operator-=(Hex const &other)
+  {
+    m_q -= other.m_q;
+    m_r -= other.m_r;
+  }
+  constexpr bool operator<(Hex const &other) const
+  {
+    return ((m_q != other.m_q) ? (m_q < other.m_q) : (m_r < other.m_r));
+  }
+  constexpr bool operator<(Hex &other)
+  {
+    return ((m_q != other.m_q) ? (m_q < other.m_q) : (m_r < other.m_r));
+  }
+  constexpr bool operator>(Hex const &other) const
+  {
+    return ((m_q != other.m_q) ? (m_q > other.m_q) : (m_r > other.m_r));
+  }
+  constexpr bool operator>(Hex &other)
+  {
+    return ((m_q != other.m_q) ? (m_q > other.m_q) : (m_r > other.m_r));
+  }
 
   /// Calculates the distance between this hex and another
   /// @param other
   /// @return distance from this hex to the other in axial distance
-  int16_t distance(const Hex other) const;
+  constexpr int16_t distance(const Hex other) const
+  {
+    Hex diff(*this - other);
+    int16_t dq = static_cast<int16_t>(diff.m_q);
+    int16_t dr = static_cast<int16_t>(diff.m_r);
+    int16_t ds = static_cast<int16_t>(diff.s());
+    return ((dq < 0 ? -dq : dq) + (dr < 0 ? -dr : dr) + (ds < 0 ? -ds : ds)) /
+           2;
+  }
 
   /// Returns coordinates for moving input amount along q axis
   /// @param[in] amount
   /// @return The resulting coordinates
-  inline Hex move_q(const int amount) { return Hex(m_q, m_r - amount); }
+  constexpr inline Hex move_q(const int amount)
+  {
+    return Hex(m_q, m_r - amount);
+  }
 
   /// Returns coordinates for moving input amount along r axis
   /// @param[in] amount
   /// @return The resulting coordinates
-  inline Hex move_r(const int amount) { return Hex(m_q + amount, m_r); }
+  constexpr inline Hex move_r(const int amount)
+  {
+    return Hex(m_q + amount, m_r);
+  }
 
   /// Returns coordinates for moving input amount along s axis
   /// @param[in] amount
   /// @return The resulting coordinates
-  inline Hex move_s(const int amount)
+  constexpr inline Hex move_s(const int amount)
   {
     return Hex(m_q - amount, m_r + amount);
   }
@@ -73,7 +142,7 @@ public:
   /// @param[in] d Direction of neighbor from this tile
   /// @return The neighbor's coordinates. Returns this point on invalid
   /// Direction.
-  inline Hex neighbor(const Direction d)
+  constexpr inline Hex neighbor(const Direction d)
   {
     int q = m_q;
     int r = m_r;
@@ -110,7 +179,7 @@ public:
   /// @param[in] d Direction of neighbor from this tile
   /// @return The neighbor's coordinates. Returns this point on invalid
   /// Direction.
-  inline Hex neighbor(const Direction d) const
+  constexpr inline Hex neighbor(const Direction d) const
   {
     int q = m_q;
     int r = m_r;
@@ -143,6 +212,18 @@ public:
     return Hex(q, r);
   }
 
+  /// Packs the coordinates into a single 64-bit key.
+  /// @return q in the upper 32 bits, r in the lower 32 bits
+  constexpr uint64_t key() const
+  {
+    return ((static_cast<uint64_t>(static_cast<uint32_t>(m_q)) << 32) |
+            static_cast<uint32_t>(m_r));
+  }
+
+  /// Well-mixed hash of the coordinates, for hashed containers.
+  /// @return The hash
+  constexpr uint64_t hash() const { return mix_hash(key()); }
+
   inline std::string to_string() const
   {
     std::stringstream ss;
@@ -165,11 +246,7 @@ template <> struct std::hash<tile::Hex>
 {
   std::size_t operator()(tile::Hex const &hp) const noexcept
   {
-    std::size_t hq = std::hash<int>{}(hp.q());
-    std::size_t hr = std::hash<int>{}(hp.r());
-    return hq ^
-           (hr << 1); // or use boost::hash_combine (see Discussion)
-                      // https://en.cppreference.com/w/Talk:cpp/utility/hash
+    return static_cast<std::size_t>(hp.hash());
   }
 };
 
@@ -0,0 +1,427 @@
+#ifndef HEX_RANGE_H
+#define HEX_RANGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <ranges>
+
+#include <tiles/components/Border.h>
+#include <tiles/components/Hex.h>
+
+/// Lazy, allocation-free ranges of hex coordinates. Each range only holds a
+/// few integers and computes its coordinates as it's walked, so they can be
+/// used in range-for loops, std::ranges algorithms, and constant expressions
+/// without any heap traffic. For the underlying math, see
+/// https://www.redblobgames.com/grids/hexagons.
+
+namespace tile
+{
+/// Order rings are walked in, starting from the ring's south west corner.
+static constexpr Direction RING_WALK[MAX_DIRECTIONS] = {
+    east, north_east, north_west, west, south_west, south_east};
+
+/// Walks a single ring of hexes around a center, one side at a time.
+struct Ring_walker
+{
+  Hex center;
+  Hex current;
+  int radius = 0;
+  uint8_t side = 0;
+  int step = 0;
+
+  /// Moves to the first hex of the ring at the input radius.
+  constexpr void start(const int r)
+  {
+    radius = r;
+    side = 0;
+    step = 0;
+    current = center;
+    for (int i = 0; i < radius; i++)
+    {
+      current = current.neighbor(south_west);
+    }
+  }
+
+  /// Moves to the next hex in the ring.
+  /// @return false once the whole ring has been walked
+  constexpr bool advance()
+  {
+    if (0 == radius)
+    {
+      return false;
+    }
+    current = current.neighbor(RING_WALK[side]);
+    if (++step == radius)
+    {
+      step = 0;
+      side++;
+    }
+    return side < MAX_DIRECTIONS;
+  }
+};
+
+/// Hexes exactly `radius` away from the center. A ring of radius 0 is just the
+/// center itself; a negative radius is empty.
+class Hex_ring : public std::ranges::view_interface<Hex_ring>
+{
+public:
+  class iterator
+  {
+  public:
+    using value_type = Hex;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr iterator() = default;
+    constexpr iterator(const Hex center, const int radius)
+    {
+      m_walker.center = center;
+      m_walker.start(radius);
+      m_done = (radius < 0);
+    }
+
+    constexpr Hex operator*() const { return m_walker.current; }
+    constexpr iterator &operator++()
+    {
+      m_done = !m_walker.advance();
+      return *this;
+    }
+    constexpr iterator operator++(int)
+    {
+      iterator prev = *this;
+      ++(*this);
+      return prev;
+    }
+    constexpr bool operator==(const iterator &other) const
+    {
+      return ((m_done == other.m_done) &&
+              ((m_done) || ((m_walker.current == other.m_walker.current) &&
+                            (m_walker.side == other.m_walker.side))));
+    }
+    constexpr bool operator==(std::default_sentinel_t) const { return m_done; }
+
+  private:
+    Ring_walker m_walker;
+    bool m_done = true;
+  };
+
+  constexpr Hex_ring() = default;
+  constexpr Hex_ring(const Hex center, const int radius)
+      : m_center(center), m_radius(radius)
+  {
+  }
+
+  constexpr iterator begin() const { return iterator(m_center, m_radius); }
+  constexpr std::default_sentinel_t end() const { return {}; }
+  constexpr size_t size() const
+  {
+    return ((m_radius < 0) ? 0 : ((0 == m_radius) ? 1 : 6 * m_radius));
+  }
+
+private:
+  Hex m_center;
+  int m_radius = -1;
+};
+
+/// Every hex within `radius` of the center, starting at the center and then
+/// walking each ring outward.
+class Hex_spiral : public std::ranges::view_interface<Hex_spiral>
+{
+public:
+  class iterator
+  {
+  public:
+    using value_type = Hex;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr iterator() = default;
+    constexpr iterator(const Hex center, const int radius)
+        : m_max_radius(radius), m_done(radius < 0)
+    {
+      m_walker.center = center;
+      m_walker.start(0);
+    }
+
+    constexpr Hex operator*() const { return m_walker.current; }
+    constexpr iterator &operator++()
+    {
+      if (!m_walker.advance())
+      {
+        if (m_walker.radius >= m_max_radius)
+        {
+          m_done = true;
+        }
+        else
+        {
+          m_walker.start(m_walker.radius + 1);
+        }
+      }
+      return *this;
+    }
+    constexpr iterator operator++(int)
+    {
+      iterator prev = *this;
+      ++(*this);
+      return prev;
+    }
+    constexpr bool operator==(const iterator &other) const
+    {
+      return ((m_done == other.m_done) &&
+              ((m_done) || ((m_walker.current == other.m_walker.current) &&
+                            (m_walker.radius == other.m_walker.radius) &&
+                            (m_walker.side == other.m_walker.side))));
+    }
+    constexpr bool operator==(std::default_sentinel_t) const { return m_done; }
+
+  private:
+    Ring_walker m_walker;
+    int m_max_radius = -1;
+    bool m_done = true;
+  };
+
+  constexpr Hex_spiral() = default;
+  constexpr Hex_spiral(const Hex center, const int radius)
+      : m_center(center), m_radius(radius)
+  {
+  }
+
+  constexpr iterator begin() const { return iterator(m_center, m_radius); }
+  constexpr std::default_sentinel_t end() const { return {}; }
+  constexpr size_t size() const
+  {
+    return ((m_radius < 0) ? 0 : (1 + 3 * m_radius * (m_radius + 1)));
+  }
+
+private:
+  Hex m_center;
+  int m_radius = -1;
+};
+
+/// Every hex within `radius` of the center, walked column by column (by q,
+/// then r). Cheaper per step than a spiral when the order doesn't matter.
+class Hex_range : public std::ranges::view_interface<Hex_range>
+{
+public:
+  class iterator
+  {
+  public:
+    using value_type = Hex;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr iterator() = default;
+    constexpr iterator(const Hex center, const int radius)
+        : m_center(center), m_radius(radius), m_dq(-radius),
+          m_dr(column_start(-radius, radius))
+    {
+    }
+
+    constexpr Hex operator*() const
+    {
+      return Hex(m_center.q() + m_dq, m_center.r() + m_dr);
+    }
+    constexpr iterator &operator++()
+    {
+      if (++m_dr > column_end(m_dq, m_radius))
+      {
+        m_dq++;
+        m_dr = column_start(m_dq, m_radius);
+      }
+      return *this;
+    }
+    constexpr iterator operator++(int)
+    {
+      iterator prev = *this;
+      ++(*this);
+      return prev;
+    }
+    constexpr bool operator==(const iterator &other) const
+    {
+      return ((m_center == other.m_center) && (m_dq == other.m_dq) &&
+              (m_dr == other.m_dr));
+    }
+    constexpr bool operator==(std::default_sentinel_t) const
+    {
+      return m_dq > m_radius;
+    }
+
+  private:
+    static constexpr int column_start(const int dq, const int radius)
+    {
+      return ((-radius > -dq - radius) ? -radius : -dq - radius);
+    }
+    static constexpr int column_end(const int dq, const int radius)
+    {
+      return ((radius < -dq + radius) ? radius : -dq + radius);
+    }
+
+    Hex m_center;
+    int m_radius = -1;
+    int m_dq = 0;
+    int m_dr = 0;
+  };
+
+  constexpr Hex_range() = default;
+  constexpr Hex_range(const Hex center, const int radius)
+      : m_center(center), m_radius(radius)
+  {
+  }
+
+  constexpr iterator begin() const { return iterator(m_center, m_radius); }
+  constexpr std::default_sentinel_t end() const { return {}; }
+  constexpr size_t size() const
+  {
+    return ((m_radius < 0) ? 0 : (1 + 3 * m_radius * (m_radius + 1)));
+  }
+
+private:
+  Hex m_center;
+  int m_radius = -1;
+};
+
+/// Hexes along the straight line from one hex to another, both ends included.
+class Hex_line : public std::ranges::view_interface<Hex_line>
+{
+public:
+  class iterator
+  {
+  public:
+    using value_type = Hex;
+    using difference_type = std::ptrdiff_t;
+
+    constexpr iterator() = default;
+    constexpr iterator(const Hex from, const Hex to)
+        : m_from(from), m_to(to), m_length(from.distance(to)), m_step(0)
+    {
+    }
+
+    constexpr Hex operator*() const
+    {
+      if (0 == m_length)
+      {
+        return m_from;
+      }
+      // Nudge the line slightly off center, so points landing exactly on an
+      // edge between two hexes are always rounded the same way.
+      double t = static_cast<double>(m_step) / m_length;
+      double q = (m_from.q() + 1e-6) + (m_to.q() - m_from.q()) * t;
+      double r = (m_from.r() + 1e-6) + (m_to.r() - m_from.r()) * t;
+      return round(q, r);
+    }
+    constexpr iterator &operator++()
+    {
+      m_step++;
+      return *this;
+    }
+    constexpr iterator operator++(int)
+    {
+      iterator prev = *this;
+      ++(*this);
+      return prev;
+    }
+    constexpr bool operator==(const iterator &other) const
+    {
+      return ((m_from == other.m_from) && (m_to == other.m_to) &&
+              (m_step == other.m_step));
+    }
+    constexpr bool operator==(std::default_sentinel_t) const
+    {
+      return m_step > m_length;
+    }
+
+  private:
+    /// Rounds fractional cube coordinates to the nearest hex.
+    static constexpr Hex round(const double q, const double r)
+    {
+      double s = -q - r;
+      int rq = nearest(q);
+      int rr = nearest(r);
+      int rs = nearest(s);
+      double dq = (rq > q) ? (rq - q) : (q - rq);
+      double dr = (rr > r) ? (rr - r) : (r - rr);
+      double ds = (rs > s) ? (rs - s) : (s - rs);
+      if ((dq > dr) && (dq > ds))
+      {
+        rq = -rr - rs;
+      }
+      else if (dr > ds)
+      {
+        rr = -rq - rs;
+      }
+      return Hex(rq, rr);
+    }
+    static constexpr int nearest(const double value)
+    {
+      return static_cast<int>((value < 0) ? (value - 0.5) : (value + 0.5));
+    }
+
+    Hex m_from;
+    Hex m_to;
+    int m_length = -1;
+    int m_step = 0;
+  };
+
+  constexpr Hex_line() = default;
+  constexpr Hex_line(const Hex from, const Hex to) : m_from(from), m_to(to) {}
+
+  constexpr iterator begin() const { return iterator(m_from, m_to); }
+  constexpr std::default_sentinel_t end() const { return {}; }
+  constexpr size_t size() const { return m_from.distance(m_to) + 1; }
+
+private:
+  Hex m_from;
+  Hex m_to;
+};
+
+/// Hexes exactly `radius` away from the center.
+/// @param[in] center
+/// @param[in] radius
+/// @return Lazy range of the ring's coordinates
+constexpr Hex_ring hex_ring(const Hex center, const int radius)
+{
+  return Hex_ring(center, radius);
+}
+
+/// Hexes within `radius` of the center, from the center outward ring by ring.
+/// @param[in] center
+/// @param[in] radius
+/// @return Lazy range of the spiral's coordinates
+constexpr Hex_spiral hex_spiral(const Hex center, const int radius)
+{
+  return Hex_spiral(center, radius);
+}
+
+/// Hexes within `radius` of the center, in column order.
+/// @param[in] center
+/// @param[in] radius
+/// @return Lazy range of the coordinates
+constexpr Hex_range hex_range(const Hex center, const int radius)
+{
+  return Hex_range(center, radius);
+}
+
+/// Hexes along the line between two hexes, both ends included.
+/// @param[in] from
+/// @param[in] to
+/// @return Lazy range of the line's coordinates
+constexpr Hex_line hex_line(const Hex from, const Hex to)
+{
+  return Hex_line(from, to);
+}
+} // namespace tile
+
+// The ranges don't reference any outside storage, so iterators stay valid
+// after the range itself is gone.
+template <>
+inline constexpr bool std::ranges::enable_borrowed_range<tile::Hex_ring> =
+    true;
+template <>
+inline constexpr bool std::ranges::enable_borrowed_range<tile::Hex_spiral> =
+    true;
+template <>
+inline constexpr bool std::ranges::enable_borrowed_range<tile::Hex_range> =
+    true;
+template <>
+inline constexpr bool std::ranges::enable_borrowed_range<tile::Hex_line> =
+    true;
+
+#endif
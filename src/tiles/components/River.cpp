@@ -1,5 +1,5 @@
 #include <memory>
-#include <set>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 #include <stduuid/include/uuid.h>
@@ -7,7 +7,10 @@
 #include <portables/transporters/Transporter.h>
 #include <tiles/components/Area.h>
 #include <tiles/components/Border.h>
+#include <tiles/components/Hex.h>
 #include <tiles/components/River.h>
+#include <tiles/components/Rotation.h>
+#include <tiles/components/Topology.h>
 #include <utils/id_utils.h>
 
 namespace tile
@@ -15,7 +18,12 @@ namespace tile
 
 River::River() {}
 
-River::River(const std::set<Direction> river_points) : m_points(river_points) {}
+River::River(const Direction_mask river_points) : m_points(river_points) {}
+
+River::River(const Direction_mask river_points, const Direction_mask bridges)
+    : m_points(river_points), m_bridges(bridges)
+{
+}
 
 River::River(const River &other)
     : m_points(other.m_points), m_bridges(other.m_bridges)
@@ -49,77 +57,37 @@ bool River::operator==(River const &other) const
   return ((m_points == other.m_points) && (m_bridges == other.m_bridges));
 }
 
-bool River::operator==(River &other)
-{
-  return ((m_points == other.m_points) && (m_bridges == other.m_bridges));
-}
-
 bool River::operator!=(River const &other) const { return !(*this == other); }
 
-bool River::operator!=(River &other) { return !(*this == other); }
+uint64_t River::fingerprint() const
+{
+  // The top byte tags what's hashed, so rivers never collide with the other
+  // parts of a tile's fingerprint.
+  return mix_hash((uint64_t{1} << 56) |
+                  (uint64_t{m_bridges.bits()} << 8) | m_points.bits());
+}
 
-bool River::splits_borders(std::set<Border> borders) const
+bool River::splits_borders(const Border_mask borders) const
 {
-  bool does_split = false;
   if (m_points.size() <= 1)
   {
     return false;
   }
 
-  for (auto point : m_points)
+  for (Direction point : m_points)
   {
-    std::vector<Border> b = borders_from_direction(point);
-    if ((borders.contains(b[0])) && (borders.contains(b[1])))
+    if (borders.includes(side_borders(point)))
     {
-      does_split = true;
-      break;
+      return true;
     }
   }
-  return does_split;
+  return false;
 }
 
-std::vector<std::set<Border>>
-River::get_area_borders(std::set<Border> borders) const
+std::vector<Border_mask> River::get_area_borders(Border_mask borders) const
 {
-  std::vector<std::set<Border>> retval;
-  if (m_points.size() > 1)
-  {
-    std::vector<Direction> p(m_points.begin(), m_points.end());
-
-    // Pair up the right border of each point with the next point's left border.
-    // Because it's circular, we know the last pairing will be whatever's
-    // leftover.
-    for (size_t i = 0; i < p.size() - 1; i++)
-    {
-      int next = i + 1;
-      Border start = borders_from_direction(p[i])[1];
-      Border end = borders_from_direction(p[next])[0];
-      // Only add to potential areas if the river point splits available area
-      if ((borders.contains(start)) && borders.contains(end))
-      {
-        std::set<Border> area_borders;
-        area_borders.insert(start);
-        borders.erase(start);
-        area_borders.insert(end);
-        borders.erase(end);
-        // Fill in all borders between the two.
-        // Only add the ones that we can from the borders remaining.
-        for (size_t j = start; j < end; j++)
-        {
-          Border border = static_cast<Border>(j);
-          if (borders.contains(border))
-          {
-            borders.erase(border);
-            area_borders.insert(border);
-          }
-        }
-        retval.push_back(area_borders);
-      }
-    }
-  }
-  retval.push_back(borders);
-
-  return retval;
+  Area_partition partition = split_borders(m_points, borders);
+  return std::vector<Border_mask>(partition.begin(), partition.end());
 }
 
 common::Error River::build(const Direction d)
@@ -148,24 +116,7 @@ common::Error River::rotate(int rotations)
   common::Error err = common::ERR_UNKNOWN;
   if (can_rotate())
   {
-    // Making 0 rotations doesn't do anything...
-    if (0 != rotations)
-    {
-      bool is_clockwise = (0 < rotations);
-      rotations = abs(rotations) % MAX_DIRECTIONS;
-      rotations = (is_clockwise ? rotations : (MAX_DIRECTIONS - rotations));
-
-      std::vector<Direction> tmp_river_points;
-      for (auto p : m_points)
-      {
-        Direction rotated =
-            static_cast<Direction>((rotations + p) % MAX_DIRECTIONS);
-        tmp_river_points.push_back(rotated);
-      }
-      m_points.clear();
-      m_points.insert(tmp_river_points.begin(), tmp_river_points.end());
-    }
-
+    m_points = rotated(m_points, clockwise_steps(rotations));
     err = common::ERR_NONE;
   }
   else
@@ -177,9 +128,9 @@ common::Error River::rotate(int rotations)
 
 std::ostream &operator<<(std::ostream &os, tile::River const &river)
 {
-  std::set<tile::Direction> pts = river.get_points();
+  tile::Direction_mask pts = river.get_points();
   std::vector<tile::Direction> points(pts.begin(), pts.end());
-  std::set<tile::Direction> brs = river.get_bridges();
+  tile::Direction_mask brs = river.get_bridges();
   std::vector<tile::Direction> bridges(brs.begin(), brs.end());
   os << "<River::points=[" << points.at(0);
   for (size_t i = 1; i < points.size(); i++)
@@ -203,35 +154,14 @@ std::ostream &operator<<(std::ostream &os, tile::River const &river)
 
 void to_json(nlohmann::json &j, const River &river)
 {
-  if (river.m_points.size() == 0)
-  {
-    j["points"] = nlohmann::json::array();
-  }
-  else
-  {
-    for (Direction d : river.m_points)
-    {
-      j["points"].push_back(to_string(d));
-    }
-  }
-
-  if (river.m_bridges.size() == 0)
-  {
-    j["bridges"] = nlohmann::json::array();
-  }
-  else
-  {
-    for (auto bridge : river.m_bridges)
-    {
-      j["bridges"].push_back(to_string(bridge));
-    }
-  }
+  j["points"] = river.m_points;
+  j["bridges"] = river.m_bridges;
 }
 
 void from_json(const nlohmann::json &j, River &river)
 {
-  std::set<Direction> points;
-  std::set<Direction> bridges;
+  Direction_mask points;
+  Direction_mask bridges;
   for (auto p : j.at("points").get<std::vector<Direction>>())
   {
     if (Direction::invalid_direction == p)
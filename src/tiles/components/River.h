@@ -2,7 +2,7 @@
 #define RIVER_H
 
 #include <memory>
-#include <set>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 #include <stduuid/include/uuid.h>
@@ -17,7 +17,8 @@ class River : public std::enable_shared_from_this<River>
 {
 public:
   River();
-  River(const std::set<Direction> river_points);
+  River(const Direction_mask river_points);
+  River(const Direction_mask river_points, const Direction_mask bridges);
   River(const River &other);
   virtual ~River();
 
@@ -27,9 +28,11 @@ public:
   River operator=(River const &other);
   River operator=(River &other);
   bool operator==(River const &other) const;
-  bool operator==(River &other);
   bool operator!=(River const &other) const;
-  bool operator!=(River &other);
+
+  /// Returns a 64-bit fingerprint of the river's points and bridges. Equal
+  /// rivers always have equal fingerprints.
+  uint64_t fingerprint() const;
 
   bool inline can_build_bridge(Direction d)
   {
@@ -46,18 +49,16 @@ public:
   {
     return m_bridges.contains(d);
   }
-  inline std::set<Direction> get_points() { return m_points; }
-  inline std::set<Direction> get_bridges() { return m_bridges; }
-  inline std::set<Direction> get_points() const { return m_points; }
-  inline std::set<Direction> get_bridges() const { return m_bridges; }
+  inline Direction_mask get_points() const { return m_points; }
+  inline Direction_mask get_bridges() const { return m_bridges; }
 
-  bool splits_borders(const std::set<Border> borders) const;
+  bool splits_borders(const Border_mask borders) const;
 
   /// Returns a list of area borders this river creates from a otherwise empty
   /// tile.
   /// @return The list of area borders.
-  std::vector<std::set<Border>>
-  get_area_borders(std::set<Border> borders = ALL_BORDERS) const;
+  std::vector<Border_mask>
+  get_area_borders(Border_mask borders = ALL_BORDERS) const;
 
   /// Builds a bridge over the point at the input direction.
   /// @param[in] d
@@ -86,17 +87,17 @@ public:
 
 protected:
 private:
-  inline void set_points(const std::set<Direction> points)
+  inline void set_points(const Direction_mask points)
   {
     m_points = points;
   }
-  inline void set_bridges(const std::set<Direction> bridges)
+  inline void set_bridges(const Direction_mask bridges)
   {
     m_bridges = bridges;
   }
 
-  std::set<Direction> m_points;
-  std::set<Direction> m_bridges;
+  Direction_mask m_points;
+  Direction_mask m_bridges;
 };
 } // namespace tile
 
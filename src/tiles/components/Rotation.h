@@ -0,0 +1,144 @@
+#ifndef ROTATION_H
+#define ROTATION_H
+
+#include <array>
+#include <cstdint>
+
+#include <tiles/components/Border.h>
+
+namespace tile
+{
+/// Turns a number of rotations into clockwise steps. Negative rotations turn
+/// counter-clockwise, and full turns drop out.
+/// @param[in] rotations
+/// @return Clockwise steps, in [0, MAX_DIRECTIONS)
+constexpr uint8_t clockwise_steps(const int rotations)
+{
+  int steps = rotations % MAX_DIRECTIONS;
+  return static_cast<uint8_t>((0 > steps) ? (steps + MAX_DIRECTIONS) : steps);
+}
+
+/// Works out where each direction ends up after some clockwise steps.
+constexpr std::array<std::array<Direction, MAX_DIRECTIONS>, MAX_DIRECTIONS>
+make_direction_rotations()
+{
+  std::array<std::array<Direction, MAX_DIRECTIONS>, MAX_DIRECTIONS> retval{};
+  for (uint8_t steps = 0; steps < MAX_DIRECTIONS; steps++)
+  {
+    for (uint8_t d = 0; d < MAX_DIRECTIONS; d++)
+    {
+      retval[steps][d] = static_cast<Direction>((d + steps) % MAX_DIRECTIONS);
+    }
+  }
+  return retval;
+}
+
+/// Works out where each border ends up after some clockwise steps. Each step
+/// moves a border two places, onto the same side of the next direction.
+constexpr std::array<std::array<Border, MAX_BORDERS>, MAX_DIRECTIONS>
+make_border_rotations()
+{
+  std::array<std::array<Border, MAX_BORDERS>, MAX_DIRECTIONS> retval{};
+  for (uint8_t steps = 0; steps < MAX_DIRECTIONS; steps++)
+  {
+    for (uint8_t b = 0; b < MAX_BORDERS; b++)
+    {
+      retval[steps][b] = static_cast<Border>((b + steps * 2) % MAX_BORDERS);
+    }
+  }
+  return retval;
+}
+
+/// Direction rotations, indexed by [steps][direction].
+inline constexpr std::array<std::array<Direction, MAX_DIRECTIONS>,
+                            MAX_DIRECTIONS>
+    DIRECTION_ROTATIONS = make_direction_rotations();
+
+/// Border rotations, indexed by [steps][border].
+inline constexpr std::array<std::array<Border, MAX_BORDERS>, MAX_DIRECTIONS>
+    BORDER_ROTATIONS = make_border_rotations();
+
+/// Works out the bits of every direction mask after some clockwise steps.
+constexpr std::array<std::array<uint8_t, 1 << MAX_DIRECTIONS>, MAX_DIRECTIONS>
+make_direction_mask_rotations()
+{
+  std::array<std::array<uint8_t, 1 << MAX_DIRECTIONS>, MAX_DIRECTIONS>
+      retval{};
+  for (uint8_t steps = 0; steps < MAX_DIRECTIONS; steps++)
+  {
+    for (uint8_t bits = 0; bits < retval[steps].size(); bits++)
+    {
+      for (uint8_t d = 0; d < MAX_DIRECTIONS; d++)
+      {
+        if (bits & (1u << d))
+        {
+          retval[steps][bits] |=
+              static_cast<uint8_t>(1u << DIRECTION_ROTATIONS[steps][d]);
+        }
+      }
+    }
+  }
+  return retval;
+}
+
+/// Direction mask rotations, indexed by [steps][mask bits].
+inline constexpr std::array<std::array<uint8_t, 1 << MAX_DIRECTIONS>,
+                            MAX_DIRECTIONS>
+    DIRECTION_MASK_ROTATIONS = make_direction_mask_rotations();
+
+/// Rotates a direction clockwise. Invalid directions are left as they are.
+/// @param[in] d
+/// @param[in] steps  Clockwise steps, in [0, MAX_DIRECTIONS)
+/// @return The rotated direction
+constexpr Direction rotated(const Direction d, const uint8_t steps)
+{
+  if (!((0 <= d) && (MAX_DIRECTIONS > d)))
+  {
+    return d;
+  }
+  return DIRECTION_ROTATIONS[steps][d];
+}
+
+/// Rotates a border clockwise. Invalid borders are left as they are.
+/// @param[in] b
+/// @param[in] steps  Clockwise steps, in [0, MAX_DIRECTIONS)
+/// @return The rotated border
+constexpr Border rotated(const Border b, const uint8_t steps)
+{
+  if (!((0 <= b) && (MAX_BORDERS > b)))
+  {
+    return b;
+  }
+  return BORDER_ROTATIONS[steps][b];
+}
+
+/// Rotates every direction in a mask clockwise.
+/// @param[in] mask
+/// @param[in] steps  Clockwise steps, in [0, MAX_DIRECTIONS)
+/// @return The rotated mask
+constexpr Direction_mask rotated(const Direction_mask mask,
+                                 const uint8_t steps)
+{
+  return Direction_mask::from_bits(
+      DIRECTION_MASK_ROTATIONS[steps][mask.bits()]);
+}
+
+/// Rotates every border in a mask clockwise. A table over all 4096 border
+/// masks per step would buy nothing over rotating the bits directly.
+/// @param[in] mask
+/// @param[in] steps  Clockwise steps, in [0, MAX_DIRECTIONS)
+/// @return The rotated mask
+constexpr Border_mask rotated(const Border_mask mask, const uint8_t steps)
+{
+  if (0 == steps)
+  {
+    return mask;
+  }
+  const uint16_t bits = mask.bits();
+  const uint8_t shift = steps * 2;
+  return Border_mask::from_bits(static_cast<uint16_t>(
+      (bits << shift) | (bits >> (MAX_BORDERS - shift))));
+}
+} // namespace tile
+
+#endif
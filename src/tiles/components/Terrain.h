@@ -0,0 +1,45 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include <cstdint>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+namespace tile
+{
+enum Terrain
+{
+  invalid = -1,
+  desert = 0,
+  forest,
+  mountain,
+  plains,
+  rock,
+  sea
+};
+static const uint8_t MAX_TERRAIN_TYPES = 6;
+static const std::string TERRAIN_NAMES[MAX_TERRAIN_TYPES]{
+    "desert", "forest", "mountain", "plains", "rock", "sea"};
+NLOHMANN_JSON_SERIALIZE_ENUM(Terrain, {{invalid, nullptr},
+                                       {desert, TERRAIN_NAMES[desert]},
+                                       {forest, TERRAIN_NAMES[forest]},
+                                       {mountain, TERRAIN_NAMES[mountain]},
+                                       {plains, TERRAIN_NAMES[plains]},
+                                       {rock, TERRAIN_NAMES[rock]},
+                                       {sea, TERRAIN_NAMES[sea]}});
+static bool is_valid(const Terrain t)
+{
+  return ((0 <= t) && (MAX_TERRAIN_TYPES > t));
+}
+static const std::string to_string(const Terrain t)
+{
+  if (is_valid(t))
+  {
+    return TERRAIN_NAMES[t];
+  }
+  return "unknown";
+}
+} // namespace tile
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include <tiles/components/Border.h>
+
+namespace tile
+{
+/// Borders of the areas a tile is split into. Areas never share a border, so
+/// there's never more than one per border.
+struct Area_partition
+{
+  constexpr const Border_mask *begin() const { return areas.data(); }
+  constexpr const Border_mask *end() const { return areas.data() + count; }
+  constexpr size_t size() const { return count; }
+  constexpr void push_back(const Border_mask borders)
+  {
+    areas[count++] = borders;
+  }
+
+  uint8_t count = 0;
+  std::array<Border_mask, MAX_BORDERS> areas{};
+};
+
+/// Splits the input borders along a river with the input points. The right
+/// border of each point is paired up with the next point's left border, and
+/// each pair whose borders are both available bounds a new area. Because the
+/// river is circular, whatever's left over makes the last area.
+/// @param[in] points  The river's points
+/// @param[in] borders  Borders available to split
+/// @return The split borders, in the order they were split off
+constexpr Area_partition split_borders(const Direction_mask points,
+                                       Border_mask borders)
+{
+  Area_partition retval;
+  if (points.size() > 1)
+  {
+    auto it = points.begin();
+    Direction point = *it;
+    for (++it; it != points.end(); ++it)
+    {
+      Direction next = *it;
+      Border start = static_cast<Border>(point * 2 + 1);
+      Border end = static_cast<Border>(next * 2);
+      point = next;
+      // Only add to potential areas if the river point splits available area
+      if ((borders.contains(start)) && (borders.contains(end)))
+      {
+        // The area takes every border still available from start to end.
+        Border_mask area_borders =
+            Border_mask::from_bits(static_cast<uint16_t>(
+                (1u << (end + 1)) - (1u << start))) &
+            borders;
+        borders = borders - area_borders;
+        retval.push_back(area_borders);
+      }
+    }
+  }
+  retval.push_back(borders);
+  return retval;
+}
+
+/// Splits an otherwise empty tile along every possible single river, with the
+/// areas sorted the way the tile keeps them.
+constexpr std::array<Area_partition, 1 << MAX_DIRECTIONS>
+make_river_partitions()
+{
+  std::array<Area_partition, 1 << MAX_DIRECTIONS> retval{};
+  for (uint8_t bits = 0; bits < retval.size(); bits++)
+  {
+    Area_partition &partition = retval[bits];
+    partition = split_borders(Direction_mask::from_bits(bits), ALL_BORDERS);
+    std::sort(partition.areas.begin(),
+              partition.areas.begin() + partition.count);
+  }
+  return retval;
+}
+
+/// Areas of a tile with a single river, indexed by the river's point bits.
+/// Rotated layouts are just other entries: rotate the point bits to find
+/// them.
+inline constexpr std::array<Area_partition, 1 << MAX_DIRECTIONS>
+    RIVER_PARTITIONS = make_river_partitions();
+
+/// Splits a tile along all of its rivers. The first river's areas come
+/// straight from RIVER_PARTITIONS; every other river splits whichever of
+/// those areas it flows through.
+/// @param[in] rivers  Points of each river, in the tile's order
+/// @param[in] count  Number of rivers
+/// @return The areas' borders, in the order a std::set of border sets would
+/// hold them
+constexpr Area_partition partition_rivers(const Direction_mask *rivers,
+                                          const size_t count)
+{
+  if (0 == count)
+  {
+    return RIVER_PARTITIONS[0];
+  }
+  Area_partition retval = RIVER_PARTITIONS[rivers[0].bits()];
+  for (size_t i = 1; i < count; i++)
+  {
+    const Direction_mask points = rivers[i];
+    Area_partition split;
+    for (Border_mask b : retval)
+    {
+      // Only rivers reaching across both borders of a side split an area.
+      bool splits = false;
+      for (Direction point : points)
+      {
+        splits |= ((1 < points.size()) && (b.includes(side_borders(point))));
+      }
+      if (!splits)
+      {
+        split.push_back(b);
+        continue;
+      }
+      for (Border_mask part : split_borders(points, b))
+      {
+        // Rivers sharing a point can leave nothing over for the last area.
+        if (!part.empty())
+        {
+          split.push_back(part);
+        }
+      }
+    }
+    std::sort(split.areas.begin(), split.areas.begin() + split.count);
+    retval = split;
+  }
+  return retval;
+}
+} // namespace tile
+
+#endif
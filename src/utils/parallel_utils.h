@@ -0,0 +1,70 @@
+#ifndef PARALLEL_UTILS_H
+#define PARALLEL_UTILS_H
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace utils
+{
+
+/// Splits [0, count) into contiguous slices and calls f(begin, end) on each
+/// from its own thread. Work smaller than two slices of `min_per_worker` runs
+/// on the calling thread instead. The first exception thrown by any slice is
+/// rethrown once every thread has finished.
+/// @param[in] count  Number of items to process
+/// @param[in] min_per_worker  Smallest slice worth handing to a thread
+/// @param[in] f  Callable taking the slice's (begin, end) indices
+template <class F>
+void parallel_for(const size_t count, const size_t min_per_worker, F f)
+{
+  size_t workers = 1;
+  if ((0 < min_per_worker) && (count >= min_per_worker))
+  {
+    // hardware_concurrency() may report 0 when it can't tell.
+    workers = std::clamp<size_t>(
+        count / min_per_worker, 1,
+        std::max(1u, std::thread::hardware_concurrency()));
+  }
+  if (workers <= 1)
+  {
+    f(static_cast<size_t>(0), count);
+    return;
+  }
+
+  std::vector<std::thread> pool;
+  std::vector<std::exception_ptr> errors(workers);
+  size_t per_worker = (count + workers - 1) / workers;
+  for (size_t w = 0; w < workers; w++)
+  {
+    size_t begin = std::min(count, w * per_worker);
+    size_t end = std::min(count, begin + per_worker);
+    pool.emplace_back(
+        [&f, &errors, w, begin, end]()
+        {
+          try
+          {
+            f(begin, end);
+          }
+          catch (...)
+          {
+            errors[w] = std::current_exception();
+          }
+        });
+  }
+  for (auto &worker : pool)
+  {
+    worker.join();
+  }
+  for (auto &err : errors)
+  {
+    if (err)
+    {
+      std::rethrow_exception(err);
+    }
+  }
+}
+} // namespace utils
+
+#endif
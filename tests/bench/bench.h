@@ -0,0 +1,80 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/// Minimal benchmark harness. Each benchmark file registers its cases with
+/// BENCHMARK(name); bench_runner.cpp runs every registered case in order.
+namespace bench
+{
+struct Case
+{
+  std::string name;
+  std::function<void()> run;
+};
+
+inline std::vector<Case> &registry()
+{
+  static std::vector<Case> cases;
+  return cases;
+}
+
+struct Registrar
+{
+  Registrar(const std::string name, std::function<void()> run)
+  {
+    registry().push_back({name, run});
+  }
+};
+
+/// Returns the number of heap allocations made so far. bench_runner.cpp
+/// replaces the global operator new to count them.
+size_t allocations();
+
+/// Times f() over the input number of iterations and prints the mean cost,
+/// along with the mean number of heap allocations it made.
+/// @param[in] label  Name printed alongside the measurement
+/// @param[in] iterations  Number of times to run f
+/// @param[in] f  Work to time
+template <class F> void measure(const std::string label, size_t iterations, F f)
+{
+  size_t allocs = allocations();
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; i++)
+  {
+    f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  allocs = allocations() - allocs;
+  double total_us =
+      std::chrono::duration<double, std::micro>(end - start).count();
+  std::cout << "  " << std::left << std::setw(48) << label << std::right
+            << std::setw(12) << std::fixed << std::setprecision(2)
+            << (total_us / iterations) << " us/iter" << std::setw(10)
+            << (static_cast<double>(allocs) / iterations) << " allocs/iter"
+            << std::endl;
+}
+
+/// Keeps the optimizer from discarding a computed value.
+template <class T> void keep(T const &value)
+{
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+} // namespace bench
+
+#define BENCH_CONCAT_(a, b) a##b
+#define BENCH_CONCAT(a, b) BENCH_CONCAT_(a, b)
+#define BENCHMARK(name)                                                        \
+  static void BENCH_CONCAT(bench_, name)();                                    \
+  static bench::Registrar BENCH_CONCAT(bench_registrar_, name)(               \
+      #name, BENCH_CONCAT(bench_, name));                                      \
+  static void BENCH_CONCAT(bench_, name)()
+
+#endif
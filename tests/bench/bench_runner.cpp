@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+
+namespace
+{
+std::atomic<size_t> s_allocations{0};
+} // namespace
+
+size_t bench::allocations()
+{
+  return s_allocations.load(std::memory_order_relaxed);
+}
+
+// Every allocation in the benchmarks goes through here to be counted.
+void *operator new(std::size_t size)
+{
+  s_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc((0 == size) ? 1 : size))
+  {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+// Runs every registered case, or only the ones named on the command line.
+int main(int argc, char **argv)
+{
+  std::vector<std::string> names(argv + 1, argv + argc);
+  for (auto &c : bench::registry())
+  {
+    if ((!names.empty()) &&
+        (names.end() == std::find(names.begin(), names.end(), c.name)))
+    {
+      continue;
+    }
+    std::cout << "[ BENCH ] " << c.name << std::endl;
+    c.run();
+  }
+  return 0;
+}
@@ -0,0 +1,165 @@
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <players/Player.h>
+#include <portables/resources/Cache.h>
+#include <portables/resources/Resource.h>
+
+#include "bench.h"
+
+using namespace portable;
+
+namespace
+{
+// Fills a cache the way a busy area might look mid-phase: a few of every
+// resource, some of them already moved by a player or two.
+Cache busy_cache()
+{
+  Cache cache;
+  for (size_t r = 0; r < RESOURCE_TYPES; r++)
+  {
+    Resource::Type t = static_cast<Resource::Type>(r);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+      cache.add(t);
+    }
+    cache.add(Resource(t, {player::Color::blue}));
+  }
+  return cache;
+}
+} // namespace
+
+BENCHMARK(cache_ops)
+{
+  Cache cache = busy_cache();
+  bench::measure("Cache copy", 200000,
+                 [&]()
+                 {
+                   Cache copy(cache);
+                   bench::keep(copy);
+                 });
+  bench::measure("Cache count_moveable, every type", 200000,
+                 [&]()
+                 {
+                   uint32_t total = 0;
+                   for (size_t r = 0; r < RESOURCE_TYPES; r++)
+                   {
+                     total += cache.count_moveable(
+                         static_cast<Resource::Type>(r), player::Color::blue);
+                   }
+                   bench::keep(total);
+                 });
+  bench::measure("Cache add then remove", 200000,
+                 [&]()
+                 {
+                   cache.add(Resource::Type::goose);
+                   bench::keep(cache.remove(Resource::Type::goose));
+                 });
+  bench::measure("Cache reset", 200000, [&]() { cache.reset(); });
+}
+
+BENCHMARK(cache_merge)
+{
+  // Each pair moves the same goods the old way, through lists and copies,
+  // then the new way, in place.
+  Cache from = busy_cache();
+  Cache to = busy_cache();
+  bench::measure("Move 3 geese there and back, get then add", 200000,
+                 [&]()
+                 {
+                   std::vector<Resource> moved;
+                   from.get(Resource::Type::goose, moved, 3);
+                   to.add(moved);
+                   moved.clear();
+                   to.get(Resource::Type::goose, moved, 3);
+                   from.add(moved);
+                 });
+  bench::measure("Move 3 geese there and back, splice", 200000,
+                 [&]()
+                 {
+                   to.splice(Resource::Type::goose, 3, from);
+                   from.splice(Resource::Type::goose, 3, to);
+                 });
+
+  std::vector<Resource> output(2, Resource(Resource::Type::fuel));
+  bench::measure("Drop off 2 fuel, operator+", 200000,
+                 [&]()
+                 {
+                   to = to + output;
+                   to.remove(Resource::Type::fuel, 2);
+                 });
+  bench::measure("Drop off 2 fuel, operator+=", 200000,
+                 [&]()
+                 {
+                   to += output;
+                   to.remove(Resource::Type::fuel, 2);
+                 });
+
+  // The load is taken back out after each merge to keep the sizes steady.
+  const Cache load = busy_cache();
+  bench::measure("Empty a cache into another, operator+", 200000,
+                 [&]()
+                 {
+                   Cache other(load);
+                   to = to + other;
+                   other.clear();
+                   to.remove(load.counts());
+                 });
+  bench::measure("Empty a cache into another, merge_from", 200000,
+                 [&]()
+                 {
+                   Cache other(load);
+                   to.merge_from(std::move(other));
+                   to.remove(load.counts());
+                 });
+}
+
+BENCHMARK(phase_reset)
+{
+  // Every area of a large board holding a busy cache.
+  const size_t areas = 2000;
+  Phase_clock clock;
+  Cache busy = busy_cache();
+  busy.set_clock(&clock);
+  std::vector<Cache> board(areas, busy);
+  const std::string suffix = " (" + std::to_string(areas) + " caches)";
+  bench::measure("Reset every cache" + suffix, 200,
+                 [&]()
+                 {
+                   for (Cache &cache : board)
+                   {
+                     cache.reset();
+                   }
+                 });
+  bench::measure("Start a new phase" + suffix, 200,
+                 [&]() { clock.next(); });
+
+  // Caches that change during the phase pay for the reset then instead.
+  const Resource dropped(Resource::Type::goose, {player::Color::red});
+  bench::measure("Reset every cache, then drop off in each", 200,
+                 [&]()
+                 {
+                   for (Cache &cache : board)
+                   {
+                     cache.reset();
+                   }
+                   for (Cache &cache : board)
+                   {
+                     cache.add(dropped);
+                     cache.remove(Resource::Type::goose);
+                   }
+                 });
+  bench::measure("Start a new phase, then drop off in each", 200,
+                 [&]()
+                 {
+                   clock.next();
+                   for (Cache &cache : board)
+                   {
+                     cache.add(dropped);
+                     cache.remove(Resource::Type::goose);
+                   }
+                 });
+}
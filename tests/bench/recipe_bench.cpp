@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <buildings/Building.h>
+#include <buildings/Recipes.h>
+#include <portables/resources/Cache.h>
+#include <portables/resources/Resource.h>
+#include <tiles/Tile.h>
+#include <tiles/Tile_map.h>
+#include <tiles/components/Hex.h>
+#include <tiles/components/Terrain.h>
+
+#include "bench.h"
+
+using namespace building;
+
+namespace
+{
+// A cache that covers some recipes and falls short of others.
+portable::Cache stocked_cache(const size_t seed)
+{
+  portable::Cache cache;
+  for (size_t r = 0; r < portable::RESOURCE_TYPES; r++)
+  {
+    for (size_t n = 0; n < ((seed + r * 3) % 4); n++)
+    {
+      cache.add(static_cast<portable::Resource::Type>(r));
+    }
+  }
+  return cache;
+}
+
+// Checks every recipe the way each building did on its own: one count call
+// per resource it takes.
+template <size_t N>
+Building_mask match_one_by_one(const Recipe_book<N> &book,
+                               const portable::Cache &cache)
+{
+  Building_mask retval = 0;
+  for (size_t i = 0; i < N; i++)
+  {
+    bool covered = true;
+    for (size_t r = 0; r < portable::RESOURCE_TYPES; r++)
+    {
+      if ((0 != book[i].needs[r]) &&
+          (cache.count(static_cast<portable::Resource::Type>(r)) <
+           book[i].needs[r]))
+      {
+        covered = false;
+      }
+    }
+    if (covered)
+    {
+      retval |= building_bit(book[i].building);
+    }
+  }
+  return retval;
+}
+} // namespace
+
+BENCHMARK(recipe_match)
+{
+  std::vector<portable::Cache> caches;
+  for (size_t i = 0; i < 64; i++)
+  {
+    caches.push_back(stocked_cache(i));
+  }
+  size_t next = 0;
+  bench::measure("Costs and recipes, one check at a time", 200000,
+                 [&]()
+                 {
+                   const portable::Cache &cache = caches[next++ & 63];
+                   bench::keep(match_one_by_one(CONSTRUCTION_COSTS, cache));
+                   bench::keep(match_one_by_one(PRODUCTION_RECIPES, cache));
+                 });
+  bench::measure("Costs and recipes, matched at once", 200000,
+                 [&]()
+                 {
+                   const portable::Cache &cache = caches[next++ & 63];
+                   bench::keep(affordable(cache.counts()));
+                   bench::keep(producible(cache.counts()));
+                 });
+
+  // Every area of a locked board with something in it.
+  const int radius = 20;
+  tile::Tile_map map;
+  std::vector<std::pair<tile::Hex, std::shared_ptr<tile::Tile>>> batch;
+  for (int q = -radius; q <= radius; q++)
+  {
+    for (int r = std::max(-radius, -q - radius);
+         r <= std::min(radius, -q + radius); r++)
+    {
+      tile::Terrain terrain =
+          static_cast<tile::Terrain>((q * 7 + r * 13 + 1000) % 6);
+      std::shared_ptr<tile::Tile> tile = std::make_shared<tile::Tile>(terrain);
+      for (portable::Resource res : stocked_cache(q * 31 + r).all())
+      {
+        tile->get_areas().front().add_resource(res);
+      }
+      batch.push_back({tile::Hex(q, r), tile});
+    }
+  }
+  map.insert_many(batch);
+  map.set_lock(true);
+  std::vector<Area_match> matches;
+  std::string suffix = " (" + std::to_string(batch.size()) + " tiles)";
+  bench::measure("match_areas, whole board" + suffix, 500,
+                 [&]()
+                 {
+                   match_areas(map, matches);
+                   bench::keep(matches.size());
+                 });
+}
@@ -0,0 +1,346 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <tiles/Map_generator.h>
+#include <tiles/Tile.h>
+#include <tiles/Tile_map.h>
+#include <tiles/Tile_store.h>
+#include <tiles/components/Hex.h>
+#include <tiles/components/Topology.h>
+
+#include "bench.h"
+
+using namespace tile;
+
+namespace
+{
+// Builds a roughly hexagonal board of at least the requested size.
+std::vector<Hex> board_coords(const int radius)
+{
+  std::vector<Hex> coords;
+  for (int q = -radius; q <= radius; q++)
+  {
+    for (int r = std::max(-radius, -q - radius);
+         r <= std::min(radius, -q + radius); r++)
+    {
+      coords.push_back(Hex(q, r));
+    }
+  }
+  return coords;
+}
+
+template <class Store> void bench_store(const std::string name, int radius)
+{
+  std::vector<Hex> coords = board_coords(radius);
+  std::string suffix = " (" + std::to_string(coords.size()) + " tiles)";
+  // Keep each measurement to roughly the same amount of work.
+  size_t iterations = std::max<size_t>(2, 200000 / coords.size());
+
+  bench::measure(name + " insert" + suffix, iterations,
+                 [&]()
+                 {
+                   Store store;
+                   for (const Hex &h : coords)
+                   {
+                     store.insert(h, std::shared_ptr<Tile>());
+                   }
+                   bench::keep(store.size());
+                 });
+
+  Store store;
+  for (const Hex &h : coords)
+  {
+    store.insert(h, std::shared_ptr<Tile>());
+  }
+  bench::measure(name + " neighbor probes" + suffix, iterations,
+                 [&]()
+                 {
+                   size_t found = 0;
+                   for (const Hex &h : coords)
+                   {
+                     for (uint8_t d = 0; d < MAX_DIRECTIONS; d++)
+                     {
+                       found += store.contains(
+                           h.neighbor(static_cast<Direction>(d)));
+                     }
+                   }
+                   bench::keep(found);
+                 });
+  bench::measure(name + " iterate" + suffix, iterations,
+                 [&]()
+                 {
+                   size_t visited = 0;
+                   store.for_each([&visited](const Hex &h,
+                                             const std::shared_ptr<Tile> &t)
+                                  { visited += h.q(); });
+                   bench::keep(visited);
+                 });
+}
+} // namespace
+
+BENCHMARK(tile_store_lookup)
+{
+  // Roughly 1k, 10k and 100k tile boards.
+  for (int radius : {18, 57, 182})
+  {
+    bench_store<Tree_store<std::shared_ptr<Tile>>>("tree", radius);
+    bench_store<Hashed_store<std::shared_ptr<Tile>>>("chained hash", radius);
+    bench_store<Flat_store<std::shared_ptr<Tile>>>("open addressing",
+                                                   radius);
+    bench_store<Chunked_store<std::shared_ptr<Tile>>>("chunked", radius);
+  }
+}
+
+BENCHMARK(tile_map_setup)
+{
+  std::vector<Hex> coords = board_coords(40);
+  bench::measure("Tile_map insert (" + std::to_string(coords.size()) +
+                     " tiles)",
+                 3,
+                 [&]()
+                 {
+                   Tile_map map;
+                   std::vector<std::shared_ptr<Tile>> tiles;
+                   for (const Hex &h : coords)
+                   {
+                     tiles.push_back(std::make_shared<Tile>(Terrain::plains));
+                     map.insert(h, tiles.back());
+                   }
+                   bench::keep(map.is_valid());
+                 });
+  bench::measure("Tile_map insert_many (" + std::to_string(coords.size()) +
+                     " tiles)",
+                 3,
+                 [&]()
+                 {
+                   Tile_map map;
+                   std::vector<std::pair<Hex, std::shared_ptr<Tile>>> batch;
+                   for (const Hex &h : coords)
+                   {
+                     batch.push_back(
+                         {h, std::make_shared<Tile>(Terrain::plains)});
+                   }
+                   map.insert_many(batch);
+                   bench::keep(map.is_valid());
+                 });
+}
+
+BENCHMARK(tile_map_load)
+{
+  std::vector<Hex> coords = board_coords(40);
+  Tile_map map;
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> batch;
+  for (const Hex &h : coords)
+  {
+    batch.push_back({h, std::make_shared<Tile>(Terrain::plains)});
+  }
+  map.insert_many(batch);
+  nlohmann::json j = map;
+
+  bench::measure("Tile_map from_json (" + std::to_string(coords.size()) +
+                     " tiles)",
+                 3,
+                 [&]()
+                 {
+                   Tile_map loaded;
+                   from_json(j, loaded);
+                   bench::keep(loaded.size());
+                 });
+}
+
+BENCHMARK(tile_map_fork)
+{
+  std::vector<Hex> coords = board_coords(40);
+  Tile_map map;
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> batch;
+  for (const Hex &h : coords)
+  {
+    batch.push_back({h, std::make_shared<Tile>(Terrain::plains)});
+  }
+  map.insert_many(batch);
+  std::string suffix = " (" + std::to_string(coords.size()) + " tiles)";
+
+  bench::measure("Tile_map fork" + suffix, 10000,
+                 [&]()
+                 {
+                   Tile_map fork = map.fork();
+                   bench::keep(fork.size());
+                 });
+  bench::measure("Tile_map fork, then read" + suffix, 10000,
+                 [&]()
+                 {
+                   Tile_map fork = map.fork();
+                   std::shared_ptr<const Tile> tile;
+                   fork.get_tile(Hex(0, 0), tile);
+                   bench::keep(tile.get());
+                 });
+  bench::measure("Tile_map fork, then change a tile" + suffix, 20,
+                 [&]()
+                 {
+                   Tile_map fork = map.fork();
+                   std::shared_ptr<Tile> tile;
+                   fork.get_tile(Hex(0, 0), tile);
+                   bench::keep(tile.get());
+                 });
+}
+
+BENCHMARK(map_generate)
+{
+  for (size_t count : {10000, 100000})
+  {
+    bench::measure("Map_generator generate (" + std::to_string(count) +
+                       " tiles)",
+                   2,
+                   [&]()
+                   {
+                     Tile_map map;
+                     Map_generator(count).generate(count, map);
+                     bench::keep(map.is_valid());
+                   });
+  }
+}
+
+BENCHMARK(tile_construct)
+{
+  // Cycle through every single-river layout, including none at all.
+  uint8_t bits = 0;
+  bench::measure("split borders, per river layout", 1000000,
+                 [&]()
+                 {
+                   bits = (bits + 1) % RIVER_PARTITIONS.size();
+                   bench::keep(split_borders(Direction_mask::from_bits(bits),
+                                             ALL_BORDERS));
+                 });
+  bench::measure("partition table, per river layout", 1000000,
+                 [&]()
+                 {
+                   bits = (bits + 1) % RIVER_PARTITIONS.size();
+                   bench::keep(RIVER_PARTITIONS[bits]);
+                 });
+  bench::measure("Tile construct, per river layout", 1000000,
+                 [&]()
+                 {
+                   bits = (bits + 1) % RIVER_PARTITIONS.size();
+                   Tile tile(Direction_mask::from_bits(bits), Terrain::plains);
+                   bench::keep(tile.get_areas().size());
+                 });
+}
+
+BENCHMARK(tile_rotate)
+{
+  // Try every orientation of a river tile against a neighbor, the way an
+  // auto-rotate pass would at each frontier position.
+  Tile tile(Direction_mask{Direction::north_west, Direction::east},
+            Terrain::plains);
+  Tile neighbor(Direction_mask{Direction::west}, Terrain::plains);
+  bench::measure("Tile rotate, all orientations", 200000,
+                 [&]()
+                 {
+                   size_t fits = 0;
+                   for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
+                   {
+                     tile.rotate(1);
+                     fits += (tile.has_river_point(Direction::east) ==
+                              neighbor.has_river_point(Direction::west));
+                   }
+                   bench::keep(fits);
+                 });
+  bench::measure("Tile rotated_view, all orientations", 200000,
+                 [&]()
+                 {
+                   size_t fits = 0;
+                   for (uint8_t i = 0; i < MAX_DIRECTIONS; i++)
+                   {
+                     fits += tile.rotated_view(i).fits(neighbor,
+                                                       Direction::east);
+                   }
+                   bench::keep(fits);
+                 });
+}
+
+BENCHMARK(tile_compare)
+{
+  // Compare tiles of the same shape, a road apart: the usual near miss when
+  // checking a candidate against a tile's neighbors.
+  Direction_mask rp{Direction::north_west, Direction::east};
+  Tile tile(rp, Terrain::plains);
+  Tile other(rp, Terrain::plains);
+  other.get_areas().front().build(Border::NW_right);
+  bench::measure("Tile fingerprint", 1000000,
+                 [&]() { bench::keep(tile.fingerprint()); });
+  bench::measure("Tile operator==, near miss", 1000000,
+                 [&]() { bench::keep(tile == other); });
+}
+
+BENCHMARK(tile_shore)
+{
+  // Ask every tile of a board speckled with sea whether it's on the shore.
+  std::vector<Hex> coords = board_coords(57);
+  Tile_map map;
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> batch;
+  for (const Hex &h : coords)
+  {
+    Terrain terrain = (0 == (h.q() * 7 + h.r() * 13) % 5) ? Terrain::sea
+                                                           : Terrain::plains;
+    batch.push_back({h, std::make_shared<Tile>(terrain)});
+  }
+  map.insert_many(batch);
+  std::string suffix = " (" + std::to_string(coords.size()) + " tiles)";
+
+  bench::measure("is_shore, every tile" + suffix, 200,
+                 [&]()
+                 {
+                   size_t shore = 0;
+                   for (const auto &[coord, tile] : batch)
+                   {
+                     shore += tile->is_shore();
+                   }
+                   bench::keep(shore);
+                 });
+}
+
+BENCHMARK(tile_map_region)
+{
+  std::vector<Hex> coords = board_coords(57);
+  Tile_map map;
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> batch;
+  for (const Hex &h : coords)
+  {
+    Terrain terrain = (0 == (h.q() * 7 + h.r() * 13) % 97) ? Terrain::rock
+                                                            : Terrain::plains;
+    batch.push_back({h, std::make_shared<Tile>(terrain)});
+  }
+  map.insert_many(batch);
+  std::string suffix = " (" + std::to_string(coords.size()) + " tiles)";
+
+  bench::measure("viewport 20x12, per-hex probes" + suffix, 2000,
+                 [&]()
+                 {
+                   size_t count = 0;
+                   for (int row = 0; row < 12; row++)
+                   {
+                     for (int col = 0; col < 20; col++)
+                     {
+                       std::shared_ptr<Tile> tile;
+                       count += (common::ERR_NONE ==
+                                 map.get_tile(col - (row >> 1), row, tile));
+                     }
+                   }
+                   bench::keep(count);
+                 });
+  bench::measure("viewport 20x12, tiles_in_view" + suffix, 2000,
+                 [&]()
+                 { bench::keep(map.tiles_in_view(0, 0, 19, 11).size()); });
+  bench::measure("radius 10, tiles_within" + suffix, 2000,
+                 [&]()
+                 { bench::keep(map.tiles_within(Hex(5, -3), 10).size()); });
+  bench::measure("nearest rock" + suffix, 2000,
+                 [&]()
+                 {
+                   std::shared_ptr<const Tile> tile;
+                   bench::keep(map.nearest(Hex(1, 2), Terrain::rock, tile));
+                 });
+}
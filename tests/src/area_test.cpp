@@ -15,6 +15,7 @@
 #include <portables/resources/Cache.h>
 #include <portables/resources/Resource.h>
 #include <portables/transporters/Transporter.h>
+#include <tiles/Tile.h>
 #include <tiles/components/Area.h>
 #include <tiles/components/Border.h>
 #include <utils/id_utils.h>
@@ -23,7 +24,7 @@ using namespace tile;
 
 TEST(area_test, create_area_test)
 {
-  std::set<Border> borders;
+  Border_mask borders;
   borders.insert(Border::NW_right);
   borders.insert(Border::NE_left);
   borders.insert(Border::NE_right);
@@ -40,7 +41,7 @@ TEST(area_test, create_area_test)
 
 TEST(area_test, build_road_test)
 {
-  std::set<Border> borders;
+  Border_mask borders;
   borders.insert(Border::NW_right);
   borders.insert(Border::NE_left);
   borders.insert(Border::NE_right);
@@ -100,21 +101,19 @@ TEST(area_test, build_building_test)
   // only be built on a forest tile.
   Tile tile = Tile(Terrain::plains);
   // The tile only has one area, so first border should retrieve it.
-  test_object = tile.get_area(Border::E_left).get();
+  test_object = tile.get_area(Border::E_left);
   // Add resources so we only test that the terrain matters
-  test_object->add_resource(
-      new portable::Resource(portable::Resource::Type::boards));
+  test_object->add_resource(portable::Resource::Type::boards);
   ASSERT_EQ(common::ERR_FAIL, test_object->build<building::Woodcutter>());
   ASSERT_EQ(nullptr, test_object->get_building());
 
   tile = Tile(Terrain::forest);
-  test_object = tile.get_area(Border::E_left).get();
+  test_object = tile.get_area(Border::E_left);
   ASSERT_EQ(common::ERR_FAIL, test_object->build<building::Woodcutter>());
   ASSERT_EQ(nullptr, test_object->get_building());
 
   // An area will add a building when valid
-  test_object->add_resource(
-      new portable::Resource(portable::Resource::Type::boards));
+  test_object->add_resource(portable::Resource::Type::boards);
   ASSERT_EQ(common::ERR_NONE, test_object->build<building::Woodcutter>());
   ASSERT_NE(nullptr, test_object->get_building());
   ASSERT_EQ(building::Building::Type::woodcutter,
@@ -126,12 +125,51 @@ TEST(area_test, build_building_test)
             test_object->get_building()->get_type());
 }
 
+TEST(area_test, move_resources_test)
+{
+  // A river splits the tile in two, so goods have to be moved across.
+  Tile tile(Direction_mask{Direction::north_west, Direction::east},
+            Terrain::plains);
+  ASSERT_EQ(2, tile.get_areas().size());
+  Area *north = &tile.get_areas()[0];
+  Area *south = &tile.get_areas()[1];
+
+  // Production output is merged in whole, leaving the output empty.
+  portable::Cache output;
+  output.add(portable::Resource::Type::boards);
+  output.add(portable::Resource::Type::boards);
+  north->merge_resources(std::move(output));
+  EXPECT_EQ(0, output.size());
+  EXPECT_EQ(2, north->get_resource_amount(portable::Resource::Type::boards));
+  portable::Cache more;
+  more.add(portable::Resource::Type::trunks);
+  (*north) += more;
+  EXPECT_EQ(1, more.size());
+  EXPECT_EQ(1, north->get_resource_amount(portable::Resource::Type::trunks));
+
+  // Splicing moves goods from one area to the other.
+  EXPECT_EQ(common::ERR_FAIL, south->splice_resource(
+                                  portable::Resource::Type::boards, 3, *north));
+  EXPECT_EQ(common::ERR_INVALID, north->splice_resource(
+                                     portable::Resource::Type::boards, 1,
+                                     *north));
+  ASSERT_EQ(common::ERR_NONE, south->splice_resource(
+                                  portable::Resource::Type::boards, 1, *north));
+  EXPECT_EQ(1, north->get_resource_amount(portable::Resource::Type::boards));
+  EXPECT_EQ(1, south->get_resource_amount(portable::Resource::Type::boards));
+
+  // The tile's totals cover both areas.
+  auto all = tile.get_all_resources();
+  EXPECT_EQ(2, all[portable::Resource::Type::boards].size());
+  EXPECT_EQ(1, all[portable::Resource::Type::trunks].size());
+}
+
 TEST(area_test, rotate_area_test)
 {
   // Rotating an area should be clockwise. If the input value is negative, the
   // the rotation is counter-clockwise. This should rotate all of the borders
   // and roads accordingly.
-  std::set<Border> borders;
+  Border_mask borders;
   borders.insert(Border::NW_left);
   borders.insert(Border::NW_right);
   borders.insert(Border::NE_left);
@@ -7,7 +7,9 @@
 
 #include <buildings/Building.h>
 #include <buildings/Primary.h>
+#include <buildings/Recipes.h>
 #include <buildings/Secondary.h>
+#include <buildings/utils.h>
 
 #include <buildings/factories/Raft_factory.h>
 #include <buildings/factories/Rowboat_factory.h>
@@ -37,6 +39,7 @@
 #include <tiles/components/Border.h>
 #include <tiles/components/Hex.h>
 #include <tiles/Tile.h>
+#include <tiles/Tile_map.h>
 
 using namespace building;
 
@@ -98,7 +101,7 @@ TEST(building_test, produce_test)
   portable::Cache cache;
   cache.add(portable::Resource::goose);
   cache.add(portable::Resource::gold);
-  std::vector<portable::Portable *> output;
+  std::vector<portable::Resource> output;
 
   Woodcutter w = Woodcutter();
   Sawmill s = Sawmill();
@@ -114,9 +117,9 @@ TEST(building_test, produce_test)
   EXPECT_EQ(1, w.count_remaining_production());
   EXPECT_EQ(common::ERR_NONE, w.produce(cache, transporters, output));
   EXPECT_EQ(1, output.size());
-  ASSERT_EQ(portable::Portable::Object::resource, output.at(0)->get_object());
+  ASSERT_EQ(portable::Portable::Object::resource, output.at(0).get_object());
   EXPECT_EQ(portable::Resource::Type::trunks,
-            static_cast<portable::Resource *>(output.at(0))->get_type());
+            output.at(0).get_type());
 
   // After producing everything allowed by the woodcutter, it shouldn't be
   // able to produce until the building is reset.
@@ -143,9 +146,9 @@ TEST(building_test, produce_test)
   EXPECT_EQ(2, output.size());
   for (size_t i = 0; i < output.size(); i++)
   {
-    ASSERT_EQ(portable::Portable::Object::resource, output.at(i)->get_object());
+    ASSERT_EQ(portable::Portable::Object::resource, output.at(i).get_object());
     EXPECT_EQ(portable::Resource::Type::boards,
-              static_cast<portable::Resource *>(output.at(0))->get_type());
+              output.at(0).get_type());
   }
 
   ASSERT_EQ(common::ERR_NONE, cache.add(output));
@@ -167,9 +170,9 @@ TEST(building_test, produce_test)
   EXPECT_EQ(4, output.size());
   for (size_t i = 0; i < output.size(); i++)
   {
-    ASSERT_EQ(portable::Portable::Object::resource, output.at(i)->get_object());
+    ASSERT_EQ(portable::Portable::Object::resource, output.at(i).get_object());
     EXPECT_EQ(portable::Resource::Type::boards,
-              static_cast<portable::Resource *>(output.at(0))->get_type());
+              output.at(0).get_type());
   }
 }
 
@@ -179,7 +182,7 @@ void double_primary_output_test(portable::Resource::Type output_type)
   // Required for checking whether a building can produce
   std::vector<portable::Transporter *> transporters;
   portable::Cache cache;
-  std::vector<portable::Portable *> output;
+  std::vector<portable::Resource> output;
 
   Bldg bldg = Bldg();
 
@@ -196,9 +199,9 @@ void double_primary_output_test(portable::Resource::Type output_type)
   EXPECT_EQ(2, output.size());
   for (size_t i = 0; i < output.size(); i++)
   {
-    ASSERT_EQ(portable::Portable::Object::resource, output.at(i)->get_object());
+    ASSERT_EQ(portable::Portable::Object::resource, output.at(i).get_object());
     EXPECT_EQ(output_type,
-              static_cast<portable::Resource *>(output.at(i))->get_type());
+              output.at(i).get_type());
   }
   EXPECT_EQ(0, bldg.count_remaining_production());
 
@@ -224,7 +227,7 @@ void double_secondary_output_test(
   // Required for checking whether a building can produce
   std::vector<portable::Transporter *> transporters;
   portable::Cache cache;
-  std::vector<portable::Portable *> output;
+  std::vector<portable::Resource> output;
 
   // Add enough of input resources for full default production
   for (size_t i = 0; i < inputs.size(); i++)
@@ -251,9 +254,9 @@ void double_secondary_output_test(
   EXPECT_EQ(default_max_output, output.size());
   for (size_t i = 0; i < output.size(); i++)
   {
-    ASSERT_EQ(portable::Portable::Object::resource, output.at(i)->get_object());
+    ASSERT_EQ(portable::Portable::Object::resource, output.at(i).get_object());
     EXPECT_EQ(output_type,
-              static_cast<portable::Resource *>(output.at(i))->get_type());
+              output.at(i).get_type());
   }
   // Add enough of input resources for another full production
   for (size_t i = 0; i < inputs.size(); i++)
@@ -266,9 +269,9 @@ void double_secondary_output_test(
   EXPECT_EQ(default_max_output * 2, output.size());
   for (size_t i = 0; i < output.size(); i++)
   {
-    ASSERT_EQ(portable::Portable::Object::resource, output.at(i)->get_object());
+    ASSERT_EQ(portable::Portable::Object::resource, output.at(i).get_object());
     EXPECT_EQ(output_type,
-              static_cast<portable::Resource *>(output.at(i))->get_type());
+              output.at(i).get_type());
   }
 
 
@@ -470,7 +473,7 @@ void construct_shore_building_test(
 {
   portable::Cache empty_input;
 
-  std::set<tile::Direction> river_points;
+  tile::Direction_mask river_points;
   river_points.insert(tile::Direction::north_west);
   tile::Hex hex = tile::Hex(0,0);
 
@@ -678,7 +681,7 @@ void primary_producer_test(portable::Resource::Type output_res)
   // Required for checking whether a building can produce.
   std::vector<portable::Transporter*> transporters;
   portable::Cache cache;
-  std::vector<portable::Portable *> output;
+  std::vector<portable::Resource> output;
   // Add extranneous resource not used in production
   cache.add(portable::Resource::stock);
 
@@ -691,8 +694,8 @@ void primary_producer_test(portable::Resource::Type output_res)
   EXPECT_EQ(1, output.size());
   EXPECT_EQ(0, b.count_remaining_production());
   ASSERT_EQ(portable::Portable::Object::resource,
-            output.at(0)->get_object());
-  EXPECT_EQ(output_res, static_cast<portable::Resource *>(output.at(0))->get_type());
+            output.at(0).get_object());
+  EXPECT_EQ(output_res, output.at(0).get_type());
 
   // After producing once, shouldn't keep producing this round.
   EXPECT_FALSE(b.can_produce(cache, transporters));
@@ -700,8 +703,8 @@ void primary_producer_test(portable::Resource::Type output_res)
   EXPECT_EQ(1, output.size());
   EXPECT_EQ(0, b.count_remaining_production());
   ASSERT_EQ(portable::Portable::Object::resource,
-            output.at(0)->get_object());
-  EXPECT_EQ(output_res, static_cast<portable::Resource *>(output.at(0))->get_type());
+            output.at(0).get_object());
+  EXPECT_EQ(output_res, output.at(0).get_type());
 }
 
 TEST(building_test, primary_producer_tests)
@@ -724,7 +727,7 @@ TEST(building_test, mine_test)
   // Required for checking whether a building can produce.
   std::vector<portable::Transporter*> transporters;
   portable::Cache cache;
-  std::vector<portable::Portable *> output;
+  std::vector<portable::Resource> output;
 
   // Default type of mine should be filled with 3 gold, 3 iron
   Mine mine = Mine();
@@ -738,8 +741,8 @@ TEST(building_test, mine_test)
   EXPECT_EQ(1, output.size());
   EXPECT_EQ(0, mine.count_remaining_production());
   ASSERT_EQ(portable::Portable::Object::resource,
-            output.at(0)->get_object());
-  portable::Resource::Type produced = static_cast<portable::Resource *>(output.at(0))->get_type();
+            output.at(0).get_object());
+  portable::Resource::Type produced = output.at(0).get_type();
   EXPECT_TRUE((portable::Resource::iron == produced) ||
               (portable::Resource::gold == produced));
 
@@ -749,7 +752,7 @@ TEST(building_test, mine_test)
   EXPECT_EQ(1, output.size());
   EXPECT_EQ(0, mine.count_remaining_production());
   ASSERT_EQ(portable::Portable::Object::resource,
-            output.at(0)->get_object());
+            output.at(0).get_object());
   EXPECT_TRUE((portable::Resource::iron == produced) ||
               (portable::Resource::gold == produced));
 
@@ -764,8 +767,8 @@ TEST(building_test, mine_test)
     EXPECT_EQ(i + 2, output.size());
     EXPECT_EQ(0, mine.count_remaining_production());
     ASSERT_EQ(portable::Portable::Object::resource,
-              output.at(i+1)->get_object());
-    produced = static_cast<portable::Resource *>(output.at(i+1))->get_type();
+              output.at(i+1).get_object());
+    produced = output.at(i+1).get_type();
     EXPECT_TRUE((portable::Resource::iron == produced) ||
                 (portable::Resource::gold == produced));
     mine.reset();
@@ -795,8 +798,8 @@ TEST(building_test, mine_test)
     EXPECT_EQ(i+1, output.size());
     EXPECT_EQ(0, mine.count_remaining_production());
     ASSERT_EQ(portable::Portable::Object::resource,
-              output.at(i)->get_object());
-    produced = static_cast<portable::Resource *>(output.at(i))->get_type();
+              output.at(i).get_object());
+    produced = output.at(i).get_type();
     EXPECT_TRUE((portable::Resource::iron == produced) ||
                 (portable::Resource::gold == produced));
     mine.reset();
@@ -824,8 +827,8 @@ TEST(building_test, mine_test)
     EXPECT_EQ(i + 1, output.size());
     EXPECT_EQ(0, mine.count_remaining_production());
     ASSERT_EQ(portable::Portable::Object::resource,
-              output.at(i)->get_object());
-    produced = static_cast<portable::Resource *>(output.at(i))->get_type();
+              output.at(i).get_object());
+    produced = output.at(i).get_type();
     EXPECT_EQ(portable::Resource::gold, produced);
     mine.reset();
   }
@@ -851,8 +854,8 @@ TEST(building_test, mine_test)
     EXPECT_EQ(i + 1, output.size());
     EXPECT_EQ(0, mine.count_remaining_production());
     ASSERT_EQ(portable::Portable::Object::resource,
-              output.at(i)->get_object());
-    produced = static_cast<portable::Resource *>(output.at(i))->get_type();
+              output.at(i).get_object());
+    produced = output.at(i).get_type();
     EXPECT_EQ(portable::Resource::iron, produced);
     mine.reset();
   }
@@ -877,7 +880,7 @@ void secondary_producer_test(
   // Required for checking whether a building can produce.
   std::vector<portable::Transporter*> transporters;
   portable::Cache cache;
-  std::vector<portable::Portable *> output;
+  std::vector<portable::Resource> output;
   // Add extranneous resource not used in production
   cache.add(portable::Resource::stock);
 
@@ -907,9 +910,9 @@ void secondary_producer_test(
   for (size_t i = 0; i < output.size(); i++)
   {
     ASSERT_EQ(portable::Portable::Object::resource,
-              output.at(i)->get_object());
+              output.at(i).get_object());
     EXPECT_EQ(output_res,
-              static_cast<portable::Resource *>(output.at(i))->get_type());
+              output.at(i).get_type());
   }
   EXPECT_EQ(0, b.count_remaining_production());
   // Extra resources should be untouched.
@@ -933,9 +936,9 @@ void secondary_producer_test(
   for (size_t i = 0; i < output.size(); i++)
   {
     ASSERT_EQ(portable::Portable::Object::resource,
-              output.at(i)->get_object());
+              output.at(i).get_object());
     EXPECT_EQ(output_res,
-              static_cast<portable::Resource *>(output.at(i))->get_type());
+              output.at(i).get_type());
   }
 }
 
@@ -1003,7 +1006,7 @@ void sea_factory_test(
   // Required for checking whether a building can produce.
   std::vector<portable::Transporter*> transporters;
   portable::Cache cache;
-  std::vector<portable::Portable *> output;
+  std::vector<portable::Resource> output;
   // Add extranneous resource not used in production
   cache.add(portable::Resource::stock);
 
@@ -1090,7 +1093,7 @@ TEST(building_test, truck_factory_test)
   // Required for checking whether a building can produce.
   std::vector<portable::Transporter*> transporters;
   portable::Cache cache;
-  std::vector<portable::Portable *> output;
+  std::vector<portable::Resource> output;
   // Add extranneous resource not used in production
   cache.add(portable::Resource::stock);
 
@@ -1135,7 +1138,7 @@ TEST(building_test, wagon_factory_test)
   // Required for checking whether a building can produce.
   std::vector<portable::Transporter*> transporters;
   portable::Cache cache;
-  std::vector<portable::Portable *> output;
+  std::vector<portable::Resource> output;
   // Add extranneous resource not used in production
   cache.add(portable::Resource::stock);
 
@@ -1172,3 +1175,156 @@ TEST(building_test, wagon_factory_test)
   // EXPECT_EQ(2, cache.count(portable::Resource::boards));
   // EXPECT_EQ(1, cache.count(portable::Resource::stock));
 }
+
+TEST(building_test, recipe_match_test)
+{
+  // The production recipes should agree with every building's own check, for
+  // any mix of the resources they take. The wagon factory also needs a donkey
+  // to hand, which isn't a resource, so it's left to wagon_factory_test.
+  std::vector<portable::Transporter *> transporters;
+  const portable::Resource::Type inputs[] = {
+      portable::Resource::trunks, portable::Resource::boards,
+      portable::Resource::clay,   portable::Resource::fuel,
+      portable::Resource::gold,   portable::Resource::iron,
+      portable::Resource::paper,  portable::Resource::coins};
+  for (uint32_t mix = 0; mix < (1u << 16); mix += 7)
+  {
+    portable::Cache cache;
+    for (size_t i = 0; i < 8; i++)
+    {
+      // Two bits a resource: 0 to 3 of each.
+      for (uint32_t n = 0; n < ((mix >> (i * 2)) & 3); n++)
+      {
+        cache.add(inputs[i]);
+      }
+    }
+    if (5 == (mix % 11))
+    {
+      for (uint8_t n = 0; n < 5; n++)
+      {
+        cache.add(portable::Resource::boards);
+      }
+    }
+
+    Building_mask producible = building::producible(cache.counts());
+    for (size_t t = 0; t < BUILDING_NAMES_SIZE; t++)
+    {
+      Building::Type type = static_cast<Building::Type>(t);
+      if (Building::Type::wagon_factory == type)
+      {
+        continue;
+      }
+      std::unique_ptr<Building> b;
+      ASSERT_EQ(common::ERR_NONE, make_building(type, b));
+      EXPECT_EQ(b->can_produce(cache, transporters),
+                0 != (producible & building_bit(type)))
+          << building::to_string(type) << " with " << cache.size()
+          << " resources";
+    }
+  }
+
+  // Construction costs come off all at once, or not at all.
+  portable::Cache cache;
+  cache.add(portable::Resource::boards);
+  cache.add(portable::Resource::boards);
+  cache.add(portable::Resource::stone);
+  EXPECT_EQ(common::ERR_FAIL,
+            building::remove_construction_resources(
+                Building::Type::steamer_factory, cache));
+  EXPECT_EQ(3, cache.size());
+  EXPECT_EQ(common::ERR_INVALID,
+            building::remove_construction_resources(Building::Type::invalid,
+                                                    cache));
+  EXPECT_EQ(common::ERR_NONE, building::remove_construction_resources(
+                                  Building::Type::rowboat_factory, cache));
+  EXPECT_EQ(0, cache.size());
+}
+
+TEST(building_test, match_areas_test)
+{
+  // A forest on the shore, the sea beside it, and a desert inland.
+  std::shared_ptr<tile::Tile> forest =
+      std::make_shared<tile::Tile>(tile::Terrain::forest);
+  std::shared_ptr<tile::Tile> sea =
+      std::make_shared<tile::Tile>(tile::Terrain::sea);
+  std::shared_ptr<tile::Tile> desert =
+      std::make_shared<tile::Tile>(tile::Terrain::desert);
+  tile::Tile_map map;
+  ASSERT_EQ(common::ERR_NONE, map.insert(0, 0, forest));
+  ASSERT_EQ(common::ERR_NONE, map.insert(1, 0, sea));
+  ASSERT_EQ(common::ERR_NONE, map.insert(-1, 0, desert));
+  for (uint8_t i = 0; i < 3; i++)
+  {
+    forest->get_areas().front().add_resource(portable::Resource::boards);
+    desert->get_areas().front().add_resource(portable::Resource::boards);
+  }
+  forest->get_areas().front().add_resource(portable::Resource::trunks);
+
+  // Only locked maps have the compiled view to walk.
+  std::vector<Area_match> matches;
+  EXPECT_EQ(common::ERR_FAIL, match_areas(map, matches));
+  EXPECT_TRUE(matches.empty());
+  map.set_lock(true);
+  ASSERT_EQ(common::ERR_NONE, match_areas(map, matches));
+  ASSERT_EQ(3, matches.size());
+
+  const Building_mask primaries = building_bit(Building::Type::woodcutter) |
+                                  building_bit(Building::Type::oil_rig) |
+                                  building_bit(Building::Type::quarry) |
+                                  building_bit(Building::Type::clay_pit) |
+                                  building_bit(Building::Type::mine);
+  bool seen[3] = {false, false, false};
+  for (const Area_match &match : matches)
+  {
+    Building_mask buildable = 0;
+    Building_mask producible = primaries;
+    if (forest.get() == match.tile)
+    {
+      seen[0] = true;
+      // 3 boards covers these; the clay pit is fine on the shore.
+      buildable = building_bit(Building::Type::woodcutter) |
+                  building_bit(Building::Type::clay_pit) |
+                  building_bit(Building::Type::coal_burner) |
+                  building_bit(Building::Type::stone_factory);
+      producible |= building_bit(Building::Type::sawmill) |
+                    building_bit(Building::Type::coal_burner) |
+                    building_bit(Building::Type::papermill) |
+                    building_bit(Building::Type::wagon_factory);
+    }
+    else if (desert.get() == match.tile)
+    {
+      seen[1] = true;
+      // Nothing goes on the desert, resources or not.
+      producible |= building_bit(Building::Type::coal_burner) |
+                    building_bit(Building::Type::papermill) |
+                    building_bit(Building::Type::wagon_factory);
+    }
+    else
+    {
+      seen[2] = true;
+      EXPECT_EQ(sea.get(), match.tile);
+    }
+    EXPECT_EQ(&match.tile->get_areas().front(), match.area);
+    EXPECT_EQ(buildable, match.buildable);
+    EXPECT_EQ(producible, match.producible);
+    // The batch is just the single-area checks run over the board.
+    EXPECT_EQ(producible,
+              building::producible(match.area->get_resource_counts()));
+  }
+  EXPECT_TRUE(seen[0] && seen[1] && seen[2]);
+  EXPECT_TRUE(Woodcutter::can_build(portable::Cache(), nullptr) ==
+              building::can_build(Building::Type::woodcutter,
+                                  portable::Cache(), nullptr));
+
+  // Once something's built on a tile, there's no more room on it.
+  ASSERT_EQ(common::ERR_NONE,
+            forest->build_building<Woodcutter>(&forest->get_areas().front()));
+  ASSERT_EQ(common::ERR_NONE, match_areas(map, matches));
+  for (const Area_match &match : matches)
+  {
+    if (forest.get() == match.tile)
+    {
+      EXPECT_EQ(0, match.buildable);
+    }
+  }
+}
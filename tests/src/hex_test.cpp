@@ -1,4 +1,8 @@
+#include <algorithm>
 #include <memory>
+#include <ranges>
+#include <set>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include <nlohmann/json.hpp>
@@ -7,6 +11,7 @@
 #include <common/Errors.h>
 #include <tiles/components/Border.h>
 #include <tiles/components/Hex.h>
+#include <tiles/components/Hex_range.h>
 
 using namespace tile;
 
@@ -172,4 +177,169 @@ TEST(hex_test, neighboring_points_test)
                                        .neighbor(Direction::north_west)
                                        .neighbor(Direction::north_west)
                                        .neighbor(Direction::east));
-}
\ No newline at end of file
+}
+
+// Ranges should be usable entirely at compile time.
+static_assert(6 == std::ranges::distance(hex_ring(Hex(3, -1), 1)));
+static_assert(19 == std::ranges::distance(hex_spiral(Hex(0, 0), 2)));
+static_assert(37 == std::ranges::distance(hex_range(Hex(-4, 2), 3)));
+static_assert(Hex(3, -3) ==
+              *std::ranges::next(hex_line(Hex(0, 0), Hex(3, -3)).begin(), 3));
+
+TEST(hex_test, hash_test)
+{
+  // Hashes should be well spread: no two hexes on a board should share a
+  // hash, even in the low bits used to pick a bucket.
+  std::set<size_t> hashes;
+  std::set<size_t> buckets;
+  for (Hex h : hex_range(Hex(0, 0), 20))
+  {
+    EXPECT_TRUE(hashes.insert(std::hash<Hex>{}(h)).second);
+    buckets.insert(std::hash<Hex>{}(h) & 0x3ff);
+  }
+  // 1261 hexes across 1024 buckets; a good hash fills most of them.
+  EXPECT_LT(700, buckets.size());
+
+  // Mirrored coordinates used to collide with each other.
+  EXPECT_NE(std::hash<Hex>{}(Hex(2, 0)), std::hash<Hex>{}(Hex(0, 1)));
+  EXPECT_NE(std::hash<Hex>{}(Hex(1, -1)), std::hash<Hex>{}(Hex(-1, 1)));
+}
+
+TEST(hex_test, ring_test)
+{
+  Hex center(2, -1);
+
+  // A ring of radius 0 is just the center; a negative radius is empty.
+  std::vector<Hex> expected = {center};
+  std::vector<Hex> actual;
+  std::ranges::copy(hex_ring(center, 0), std::back_inserter(actual));
+  EXPECT_EQ(expected, actual);
+  EXPECT_TRUE(hex_ring(center, -1).empty());
+
+  // Every hex in a ring should be exactly the radius away, with no repeats.
+  for (int radius = 1; radius <= 4; radius++)
+  {
+    std::set<Hex> seen;
+    for (Hex h : hex_ring(center, radius))
+    {
+      EXPECT_EQ(radius, center.distance(h));
+      EXPECT_TRUE(seen.insert(h).second);
+    }
+    EXPECT_EQ(6 * radius, seen.size());
+    EXPECT_EQ(seen.size(), hex_ring(center, radius).size());
+  }
+
+  // The radius 1 ring is the center's neighbors.
+  std::set<Hex> neighbors;
+  for (Direction d : ALL_DIRECTIONS)
+  {
+    neighbors.insert(center.neighbor(d));
+  }
+  std::set<Hex> ring;
+  std::ranges::copy(hex_ring(center, 1), std::inserter(ring, ring.end()));
+  EXPECT_EQ(neighbors, ring);
+}
+
+TEST(hex_test, spiral_and_range_test)
+{
+  Hex center(-3, 5);
+  for (int radius = 0; radius <= 4; radius++)
+  {
+    // The spiral starts at the center, and walks outward ring by ring.
+    std::vector<Hex> spiral;
+    std::ranges::copy(hex_spiral(center, radius), std::back_inserter(spiral));
+    ASSERT_FALSE(spiral.empty());
+    EXPECT_EQ(center, spiral.front());
+    for (size_t i = 1; i < spiral.size(); i++)
+    {
+      EXPECT_LE(center.distance(spiral[i - 1]), center.distance(spiral[i]));
+    }
+
+    // Both should cover the same hexes, just in a different order.
+    std::vector<Hex> range;
+    std::ranges::copy(hex_range(center, radius), std::back_inserter(range));
+    std::set<Hex> spiral_set(spiral.begin(), spiral.end());
+    std::set<Hex> range_set(range.begin(), range.end());
+    EXPECT_EQ(spiral.size(), spiral_set.size());
+    EXPECT_EQ(range.size(), range_set.size());
+    EXPECT_EQ(spiral_set, range_set);
+    EXPECT_EQ(hex_range(center, radius).size(), range.size());
+    for (Hex h : range)
+    {
+      EXPECT_LE(center.distance(h), radius);
+    }
+  }
+  EXPECT_TRUE(hex_spiral(center, -1).empty());
+  EXPECT_TRUE(hex_range(center, -1).empty());
+
+  // Ranges should work with std::ranges adaptors too.
+  auto far =
+      hex_spiral(center, 2) |
+      std::views::filter([&center](Hex h) { return 2 == center.distance(h); });
+  EXPECT_EQ(12, std::ranges::distance(far));
+}
+
+TEST(hex_test, line_test)
+{
+  // A line to the same hex is just that hex.
+  Hex a(1, 1);
+  std::vector<Hex> expected = {a};
+  std::vector<Hex> actual;
+  std::ranges::copy(hex_line(a, a), std::back_inserter(actual));
+  EXPECT_EQ(expected, actual);
+
+  // Lines include both ends, and each step moves to a neighbor.
+  Hex b(5, -2);
+  actual.clear();
+  std::ranges::copy(hex_line(a, b), std::back_inserter(actual));
+  ASSERT_EQ(a.distance(b) + 1, actual.size());
+  EXPECT_EQ(a, actual.front());
+  EXPECT_EQ(b, actual.back());
+  for (size_t i = 1; i < actual.size(); i++)
+  {
+    EXPECT_EQ(1, actual[i - 1].distance(actual[i]));
+  }
+
+  // Straight lines along an axis should stay on that axis.
+  actual.clear();
+  std::ranges::copy(hex_line(Hex(0, 0), Hex(4, 0)),
+                    std::back_inserter(actual));
+  for (int i = 0; i <= 4; i++)
+  {
+    EXPECT_EQ(Hex(i, 0), actual.at(i));
+  }
+}
+
+// Masks should be usable entirely at compile time.
+static_assert(Border_mask{NE_left, NE_right} == side_borders(north_east));
+static_assert(ALL_BORDERS.includes(side_borders(west)));
+static_assert(6 == ALL_DIRECTIONS.size());
+
+TEST(hex_test, mask_test)
+{
+  // Masks iterate and compare in the same order a std::set would.
+  Direction_mask points{west, north_west, east};
+  std::vector<Direction> expected = {north_west, east, west};
+  EXPECT_EQ(expected, std::vector<Direction>(points.begin(), points.end()));
+  EXPECT_TRUE((Direction_mask{north_west, east} < points));
+  EXPECT_TRUE((points < Direction_mask{north_west, south_east}));
+
+  EXPECT_FALSE(points.insert(east));
+  EXPECT_TRUE(points.insert(south_west));
+  EXPECT_EQ(1, points.erase(west));
+  EXPECT_EQ(0, points.erase(west));
+  EXPECT_EQ(3, points.size());
+  EXPECT_EQ(ALL_DIRECTIONS - points, ~points);
+  EXPECT_TRUE((points | ~points) == ALL_DIRECTIONS);
+  EXPECT_TRUE((points & ~points).empty());
+
+  // They're written as the same arrays a std::set would be.
+  nlohmann::json j = Border_mask{W_right, NW_left};
+  EXPECT_EQ(nlohmann::json({"north_west_left", "west_right"}), j);
+  EXPECT_EQ((Border_mask{NW_left, W_right}), j.get<Border_mask>());
+  // Older saves may repeat values, which just collapse.
+  j.push_back("north_west_left");
+  EXPECT_EQ((Border_mask{NW_left, W_right}), j.get<Border_mask>());
+  EXPECT_THROW(nlohmann::json({"up"}).get<Border_mask>(),
+               nlohmann::json::type_error);
+}
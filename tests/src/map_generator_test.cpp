@@ -0,0 +1,97 @@
+#include <memory>
+#include <set>
+
+#include <gtest/gtest.h>
+
+#include <common/Errors.h>
+#include <tiles/Map_generator.h>
+#include <tiles/Tile.h>
+#include <tiles/Tile_map.h>
+#include <tiles/components/Hex.h>
+#include <tiles/components/Hex_range.h>
+
+using namespace tile;
+
+TEST(map_generator_test, generate_test)
+{
+  Map_generator test_object(7);
+  Tile_map map;
+
+  // There's no map without any tiles, and locked maps can't be filled in.
+  EXPECT_EQ(common::ERR_INVALID, test_object.generate(0, map));
+  EXPECT_TRUE(map.empty());
+  map.set_lock(true);
+  EXPECT_EQ(common::ERR_INVALID, test_object.generate(10, map));
+  map.set_lock(false);
+
+  // A single tile is all edge, so it's sea.
+  ASSERT_EQ(common::ERR_NONE, test_object.generate(1, map));
+  EXPECT_EQ(1, map.size());
+  EXPECT_TRUE(map.is_valid());
+  std::shared_ptr<const Tile> tile;
+  ASSERT_EQ(common::ERR_NONE, map.get_tile(Hex(0, 0), tile));
+  EXPECT_EQ(Terrain::sea, tile->get_terrain());
+
+  // Larger maps get exactly the tiles asked for, with every river meeting
+  // another river or the sea, and the whole edge of the board in sea.
+  ASSERT_EQ(common::ERR_NONE, test_object.generate(5000, map));
+  EXPECT_EQ(5000, map.size());
+  EXPECT_TRUE(map.is_valid());
+  EXPECT_TRUE(map.invalid_hexes().empty());
+  std::set<Terrain> terrains;
+  size_t river_tiles = 0;
+  for (const Hex coord : hex_spiral(Hex(), 41))
+  {
+    if (common::ERR_NONE != map.get_tile(coord, tile))
+    {
+      continue;
+    }
+    terrains.insert(tile->get_terrain());
+    river_tiles += (tile->get_river_points().empty() ? 0 : 1);
+    for (uint8_t d = 0; d < MAX_DIRECTIONS; d++)
+    {
+      std::shared_ptr<const Tile> other;
+      if (common::ERR_NONE !=
+          map.get_tile(coord.neighbor(static_cast<Direction>(d)), other))
+      {
+        EXPECT_EQ(Terrain::sea, tile->get_terrain());
+      }
+    }
+  }
+  EXPECT_EQ(MAX_TERRAIN_TYPES, terrains.size());
+  EXPECT_LT(0, river_tiles);
+}
+
+TEST(map_generator_test, seed_test)
+{
+  // The same seed always builds the same map; a different one doesn't.
+  Tile_map first;
+  Tile_map second;
+  Tile_map other;
+  ASSERT_EQ(common::ERR_NONE, Map_generator(42).generate(5000, first));
+  ASSERT_EQ(common::ERR_NONE, Map_generator(42).generate(5000, second));
+  ASSERT_EQ(common::ERR_NONE, Map_generator(43).generate(5000, other));
+
+  size_t differences = 0;
+  for (const Hex coord : hex_spiral(Hex(), 41))
+  {
+    std::shared_ptr<const Tile> a;
+    std::shared_ptr<const Tile> b;
+    std::shared_ptr<const Tile> c;
+    common::Error err = first.get_tile(coord, a);
+    ASSERT_EQ(err, second.get_tile(coord, b));
+    ASSERT_EQ(err, other.get_tile(coord, c));
+    if (common::ERR_NONE != err)
+    {
+      continue;
+    }
+    EXPECT_EQ(a->get_terrain(), b->get_terrain());
+    EXPECT_EQ(a->get_river_points(), b->get_river_points());
+    if ((a->get_terrain() != c->get_terrain()) ||
+        (a->get_river_points() != c->get_river_points()))
+    {
+      differences++;
+    }
+  }
+  EXPECT_LT(0, differences);
+}
@@ -1,9 +1,14 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include <gtest/gtest.h>
 #include <nlohmann/json.hpp>
 
 #include <common/Errors.h>
 #include <players/Player.h>
 #include <portables/Portable.h>
+#include <portables/resources/Cache.h>
 #include <portables/resources/Resource.h>
 
 TEST(resource_test, create_resource_test)
@@ -37,4 +42,306 @@ TEST(resource_test, create_resource_test)
   EXPECT_EQ(portable::Resource::Type::stock, test.get_type());
   EXPECT_EQ(portable::Portable::Object::resource, test.get_object());
   EXPECT_EQ(0, test.get_carriers().size());
-}
\ No newline at end of file
+
+  // Carriers can be added and removed once each; neutral never sticks.
+  EXPECT_EQ(common::ERR_NONE, test.add_carrier(player::Color::red));
+  EXPECT_EQ(common::ERR_FAIL, test.add_carrier(player::Color::red));
+  EXPECT_EQ(common::ERR_NONE, test.add_carrier(player::Color::neutral));
+  EXPECT_EQ(common::ERR_INVALID, test.add_carrier(player::Color::invalid));
+  EXPECT_TRUE(test.was_carried_by(player::Color::red));
+  EXPECT_FALSE(test.was_carried_by(player::Color::neutral));
+  EXPECT_FALSE(test.can_add_carrier(player::Color::red));
+  EXPECT_EQ(std::set<player::Color>{player::Color::red}, test.get_carriers());
+  portable::Resource copy = test;
+  EXPECT_TRUE(copy.was_carried_by(player::Color::red));
+  EXPECT_EQ(common::ERR_NONE, test.remove_carrier(player::Color::red));
+  EXPECT_EQ(common::ERR_FAIL, test.remove_carrier(player::Color::red));
+  EXPECT_FALSE(test.was_carried());
+  EXPECT_TRUE(copy.was_carried());
+}
+
+TEST(resource_test, cache_view_test)
+{
+  // A cache's view should walk the same resources as its list, in the same
+  // order, without copying them out.
+  portable::Cache cache;
+  EXPECT_TRUE(cache.view().empty());
+
+  cache.add(portable::Resource::Type::gold);
+  cache.add(portable::Resource::Type::trunks);
+  cache.add(portable::Resource::Type::gold);
+  // Emptied piles should be skipped over.
+  cache.add(portable::Resource::Type::clay);
+  ASSERT_EQ(common::ERR_NONE, cache.remove(portable::Resource::Type::clay));
+
+  portable::Cache::View view = cache.view();
+  EXPECT_FALSE(view.empty());
+  std::vector<portable::Resource> viewed(view.begin(), view.end());
+  EXPECT_EQ(cache.all(), viewed);
+  ASSERT_EQ(3, viewed.size());
+  EXPECT_EQ(portable::Resource::Type::trunks, viewed[0].get_type());
+  EXPECT_EQ(portable::Resource::Type::gold, viewed[1].get_type());
+  EXPECT_EQ(portable::Resource::Type::gold, viewed[2].get_type());
+}
+
+TEST(resource_test, cache_carriers_test)
+{
+  // Resources are counted by who's carried them this phase; each player can
+  // only move the ones they haven't.
+  portable::Cache cache;
+  portable::Resource goose(portable::Resource::Type::goose,
+                           {player::Color::blue});
+  portable::Resource gander(portable::Resource::Type::goose,
+                            {player::Color::blue, player::Color::red});
+  ASSERT_EQ(common::ERR_NONE, cache.add(goose));
+  ASSERT_EQ(common::ERR_NONE, cache.add(gander));
+  ASSERT_EQ(common::ERR_NONE, cache.add(portable::Resource::Type::goose));
+  EXPECT_EQ(3, cache.count(portable::Resource::Type::goose));
+  EXPECT_EQ(1, cache.count_moveable(portable::Resource::Type::goose,
+                                    player::Color::blue));
+  EXPECT_EQ(2, cache.count_moveable(portable::Resource::Type::goose,
+                                    player::Color::red));
+  EXPECT_EQ(3, cache.count_moveable(portable::Resource::Type::goose,
+                                    player::Color::green));
+  EXPECT_EQ(3, cache.count_moveable(portable::Resource::Type::goose,
+                                    player::Color::neutral));
+  EXPECT_EQ(2, cache.all_moveable(player::Color::red).size());
+
+  // Copies and JSON keep the carriers.
+  portable::Cache copy(cache);
+  EXPECT_EQ(cache, copy);
+  nlohmann::json j = cache;
+  portable::Cache loaded = j.get<portable::Cache>();
+  EXPECT_EQ(1, loaded.count_moveable(portable::Resource::Type::goose,
+                                     player::Color::blue));
+
+  // Players can't take more than they may move, and take what they can.
+  std::vector<portable::Resource> taken;
+  EXPECT_EQ(common::ERR_FAIL, cache.get(portable::Resource::Type::goose,
+                                        player::Color::blue, taken, 2));
+  EXPECT_EQ(3, cache.count(portable::Resource::Type::goose));
+  ASSERT_EQ(common::ERR_NONE, cache.get(portable::Resource::Type::goose,
+                                        player::Color::red, taken, 2));
+  ASSERT_EQ(2, taken.size());
+  for (const portable::Resource &res : taken)
+  {
+    EXPECT_FALSE(res.was_carried_by(player::Color::red));
+  }
+  EXPECT_EQ(1, cache.count(portable::Resource::Type::goose));
+  EXPECT_EQ(0, cache.count_moveable(portable::Resource::Type::goose,
+                                    player::Color::red));
+  EXPECT_NE(cache, copy);
+
+  // A new phase frees everything up again.
+  cache.reset();
+  EXPECT_EQ(1, cache.count(portable::Resource::Type::goose));
+  EXPECT_EQ(1, cache.count_moveable(portable::Resource::Type::goose,
+                                    player::Color::red));
+  copy.reset();
+  EXPECT_EQ(3, copy.count_moveable(portable::Resource::Type::goose,
+                                   player::Color::blue));
+}
+
+TEST(resource_test, cache_piles_test)
+{
+  // Carried piles of several types, added out of order.
+  portable::Cache cache;
+  cache.add(portable::Resource(portable::Resource::Type::fuel,
+                               {player::Color::red, player::Color::blue}));
+  cache.add(portable::Resource::Type::fuel);
+  cache.add(portable::Resource(portable::Resource::Type::goose,
+                               {player::Color::blue}));
+  cache.add(portable::Resource(portable::Resource::Type::fuel,
+                               {player::Color::red}));
+  cache.add(portable::Resource(portable::Resource::Type::goose,
+                               {player::Color::blue}));
+  EXPECT_EQ(5, cache.size());
+
+  // The view walks types in order, uncarried resources first.
+  std::vector<portable::Resource> seen;
+  for (const portable::Resource res : cache.view())
+  {
+    seen.push_back(res);
+  }
+  ASSERT_EQ(5, seen.size());
+  EXPECT_TRUE(std::is_sorted(
+      seen.begin(), seen.end(),
+      [](const portable::Resource &a, const portable::Resource &b)
+      { return a.get_type() < b.get_type(); }));
+  auto by_blue = [](const portable::Resource &res)
+  { return res.was_carried_by(player::Color::blue); };
+  EXPECT_EQ(3, std::count_if(seen.begin(), seen.end(), by_blue));
+
+  // Adding a cache to itself doubles every pile.
+  cache += cache;
+  EXPECT_EQ(10, cache.size());
+  EXPECT_EQ(2, cache.count_moveable(portable::Resource::Type::fuel,
+                                    player::Color::red));
+  EXPECT_EQ(0, cache.count_moveable(portable::Resource::Type::goose,
+                                    player::Color::blue));
+
+  // Piles moved by the most players go first, and emptied piles are dropped.
+  std::vector<portable::Resource> taken;
+  ASSERT_EQ(common::ERR_NONE,
+            cache.get(portable::Resource::Type::fuel, taken, 3));
+  EXPECT_EQ(2, std::count_if(taken.begin(), taken.end(), by_blue));
+  EXPECT_EQ(3, cache.count(portable::Resource::Type::fuel));
+  EXPECT_EQ(3, cache.count_moveable(portable::Resource::Type::fuel,
+                                    player::Color::blue));
+  EXPECT_EQ(2, cache.all_moveable(player::Color::red).size() -
+                   cache.count(portable::Resource::Type::goose));
+}
+
+TEST(resource_test, cache_pile_limit_test)
+{
+  // Past MAX_PILES carried piles, the pile moved by the fewest players forgets
+  // its carriers. Totals are never touched.
+  portable::Cache cache;
+  for (size_t i = 0; i < portable::Cache::MAX_PILES; i++)
+  {
+    const auto t = static_cast<portable::Resource::Type>(i);
+    cache.add(portable::Resource(t, {player::Color::red}));
+    cache.add(portable::Resource(t, {player::Color::red}));
+  }
+  const auto last =
+      static_cast<portable::Resource::Type>(portable::Cache::MAX_PILES);
+  cache.add(portable::Resource(last, {player::Color::red}));
+  EXPECT_EQ(1, cache.count_moveable(last, player::Color::red));
+  EXPECT_EQ(0, cache.count_moveable(static_cast<portable::Resource::Type>(0),
+                                    player::Color::red));
+
+  cache.add(
+      portable::Resource(last, {player::Color::red, player::Color::blue}));
+  EXPECT_EQ(2, cache.count(last));
+  EXPECT_EQ(1, cache.count_moveable(last, player::Color::red));
+  EXPECT_EQ(2, cache.count_moveable(static_cast<portable::Resource::Type>(0),
+                                    player::Color::red));
+  EXPECT_EQ(2 * portable::Cache::MAX_PILES + 2, cache.size());
+
+  // Copies are plain copies of the counts.
+  portable::Cache copy(cache);
+  EXPECT_EQ(cache.all(), copy.all());
+}
+
+TEST(resource_test, cache_phase_test)
+{
+  portable::Phase_clock clock;
+  portable::Cache cache;
+  cache.set_clock(&clock);
+  cache.add(portable::Resource::Type::goose);
+  cache.add(portable::Resource(portable::Resource::Type::goose,
+                               {player::Color::red, player::Color::blue}));
+  cache.add(portable::Resource(portable::Resource::Type::fuel,
+                               {player::Color::red}));
+  portable::Cache other;
+  other.set_clock(&clock);
+  other.add(portable::Resource(portable::Resource::Type::fuel,
+                               {player::Color::red}));
+  // Caches in another game, or in none, keep to their own phases.
+  portable::Cache elsewhere;
+  portable::Phase_clock other_clock;
+  elsewhere.set_clock(&other_clock);
+  elsewhere.add(portable::Resource(portable::Resource::Type::fuel,
+                                   {player::Color::red}));
+  portable::Cache unclocked(elsewhere);
+  unclocked.set_clock(nullptr);
+  EXPECT_EQ(1, cache.count_moveable(portable::Resource::Type::goose,
+                                    player::Color::red));
+  EXPECT_EQ(0, cache.count_moveable(portable::Resource::Type::fuel,
+                                    player::Color::red));
+
+  // Starting a new phase frees up every cache on the clock at once, without
+  // touching them.
+  clock.next();
+  EXPECT_EQ(0, elsewhere.count_moveable(portable::Resource::Type::fuel,
+                                        player::Color::red));
+  EXPECT_EQ(0, unclocked.count_moveable(portable::Resource::Type::fuel,
+                                        player::Color::red));
+  EXPECT_EQ(2, cache.count_moveable(portable::Resource::Type::goose,
+                                    player::Color::red));
+  EXPECT_EQ(1, cache.count_moveable(portable::Resource::Type::fuel,
+                                    player::Color::red));
+  EXPECT_EQ(3, cache.all_moveable(player::Color::blue).size());
+  for (const portable::Resource res : cache.view())
+  {
+    EXPECT_FALSE(res.was_carried());
+  }
+  nlohmann::json j = cache;
+  portable::Cache loaded = j.get<portable::Cache>();
+  EXPECT_EQ(2, loaded.count_moveable(portable::Resource::Type::goose,
+                                     player::Color::blue));
+
+  // Carriers from this phase count again, and old ones stay cleared.
+  cache.add(portable::Resource(portable::Resource::Type::goose,
+                               {player::Color::red}));
+  EXPECT_EQ(2, cache.count_moveable(portable::Resource::Type::goose,
+                                    player::Color::red));
+  EXPECT_EQ(3, cache.count_moveable(portable::Resource::Type::goose,
+                                    player::Color::blue));
+  std::vector<portable::Resource> taken;
+  ASSERT_EQ(common::ERR_NONE, cache.get(portable::Resource::Type::goose,
+                                        player::Color::blue, taken, 3));
+  EXPECT_EQ(1, std::count_if(taken.begin(), taken.end(),
+                             [](const portable::Resource &res)
+                             { return res.was_carried(); }));
+
+  // Merging in a cache from an earlier phase brings none of its carriers.
+  cache += other;
+  EXPECT_EQ(2, cache.count_moveable(portable::Resource::Type::fuel,
+                                    player::Color::red));
+  other.add(portable::Resource(portable::Resource::Type::fuel,
+                               {player::Color::red}));
+  cache += other;
+  EXPECT_EQ(3, cache.count_moveable(portable::Resource::Type::fuel,
+                                    player::Color::red));
+}
+
+TEST(resource_test, cache_merge_test)
+{
+  // Splicing moves counts between caches, carriers and all.
+  portable::Cache from;
+  portable::Cache to;
+  ASSERT_EQ(common::ERR_NONE,
+            from.add(portable::Resource(portable::Resource::Type::goose,
+                                        {player::Color::blue})));
+  ASSERT_EQ(common::ERR_NONE, from.add(portable::Resource::Type::goose));
+  ASSERT_EQ(common::ERR_NONE, from.add(portable::Resource::Type::gold));
+  EXPECT_EQ(common::ERR_FAIL,
+            to.splice(portable::Resource::Type::goose, 3, from));
+  EXPECT_EQ(common::ERR_INVALID,
+            to.splice(portable::Resource::Type::invalid, 1, from));
+  EXPECT_EQ(common::ERR_INVALID,
+            from.splice(portable::Resource::Type::goose, 1, from));
+  EXPECT_EQ(3, from.size());
+  EXPECT_EQ(0, to.size());
+
+  // The goose blue carried goes first, and blue still can't move it.
+  ASSERT_EQ(common::ERR_NONE,
+            to.splice(portable::Resource::Type::goose, 1, from));
+  EXPECT_EQ(1, to.count(portable::Resource::Type::goose));
+  EXPECT_EQ(0, to.count_moveable(portable::Resource::Type::goose,
+                                 player::Color::blue));
+  EXPECT_EQ(1, from.count_moveable(portable::Resource::Type::goose,
+                                   player::Color::blue));
+
+  // Merging empties the other cache into this one.
+  portable::Cache expected = to + from;
+  to.merge_from(std::move(from));
+  EXPECT_EQ(expected, to);
+  EXPECT_EQ(3, to.size());
+  EXPECT_EQ(0, from.size());
+  EXPECT_EQ(1, to.count_moveable(portable::Resource::Type::goose,
+                                 player::Color::blue));
+  to.merge_from(std::move(to));
+  EXPECT_EQ(3, to.size());
+
+  // Whole amounts come out all at once, or not at all.
+  portable::Cache::Counts amounts{};
+  amounts[portable::Resource::Type::goose] = 2;
+  amounts[portable::Resource::Type::gold] = 2;
+  EXPECT_EQ(common::ERR_FAIL, to.remove(amounts));
+  EXPECT_EQ(3, to.size());
+  amounts[portable::Resource::Type::gold] = 1;
+  EXPECT_EQ(common::ERR_NONE, to.remove(amounts));
+  EXPECT_EQ(0, to.size());
+}
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <memory>
 #include <set>
 
@@ -9,12 +10,13 @@
 #include <portables/transporters/Transporter.h>
 #include <tiles/components/Border.h>
 #include <tiles/components/River.h>
+#include <tiles/components/Topology.h>
 
 using namespace tile;
 
 TEST(river_test, create_river_test)
 {
-  std::set<Direction> points;
+  Direction_mask points;
   points.insert(Direction::north_west);
   points.insert(Direction::south_west);
   River a = River(points);
@@ -35,7 +37,7 @@ TEST(river_test, rotate_river_test)
   // Rotating a river should be clockwise. If the input value is negative, the
   // the rotation is counter-clockwise. This should rotate all of the river
   // points and bridges accordingly.
-  std::set<Direction> points;
+  Direction_mask points;
   points.insert(Direction::north_west);
   points.insert(Direction::east);
   points.insert(Direction::south_east);
@@ -120,10 +122,10 @@ TEST(river_test, area_borders_test)
   // These first tests assume only 1 river is on a tile.
   // When there's only one river point, the area should effectively not be
   // divided. This should still only create 1 area: NW_right->NW_left
-  std::set<Direction> points;
+  Direction_mask points;
   points.insert(Direction::north_west);
   River test_object(points);
-  std::vector<std::set<Border>> results = test_object.get_area_borders();
+  std::vector<Border_mask> results = test_object.get_area_borders();
   ASSERT_EQ(1, results.size());
   ASSERT_EQ(ALL_BORDERS, results[0]);
 
@@ -153,7 +155,7 @@ TEST(river_test, area_borders_test)
   // This should still create two areas:
   // NW_right->E_left + SE_right->SW_left
   // SW_right->NW_left
-  std::set<Border> partial = ALL_BORDERS;
+  Border_mask partial = ALL_BORDERS;
   partial.erase(Border::E_right);
   partial.erase(Border::SE_left);
   results = test_object.get_area_borders(partial);
@@ -180,7 +182,7 @@ TEST(river_test, area_borders_test)
 
   // If we try to split a partial area that this river does not flow throw, the
   // resulting list should just return the input.
-  std::set<Border> unused;
+  Border_mask unused;
   unused.insert(Border::E_right);
   unused.insert(Border::SE_left);
   results = test_object.get_area_borders(unused);
@@ -215,4 +217,24 @@ TEST(river_test, area_borders_test)
     ASSERT_TRUE(results[2].contains(static_cast<Border>(i)));
   }
   ASSERT_TRUE(results[2].contains(Border::NW_left));
+}
+
+TEST(river_test, river_partitions_test)
+{
+  // The partition table should hold the same areas the river itself works
+  // out, sorted the way a tile keeps them.
+  static_assert(1 == RIVER_PARTITIONS[0].size());
+  static_assert(ALL_BORDERS == RIVER_PARTITIONS[0].areas[0]);
+  static_assert(6 == RIVER_PARTITIONS[ALL_DIRECTIONS.bits()].size());
+  for (uint8_t bits = 0; bits < RIVER_PARTITIONS.size(); bits++)
+  {
+    River test_object(Direction_mask::from_bits(bits));
+    std::vector<Border_mask> expected = test_object.get_area_borders();
+    std::sort(expected.begin(), expected.end());
+    const Area_partition &partition = RIVER_PARTITIONS[bits];
+    EXPECT_EQ(expected,
+              std::vector<Border_mask>(partition.begin(), partition.end()));
+    EXPECT_EQ(std::max<size_t>(1, test_object.get_points().size()),
+              partition.size());
+  }
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include <map>
+#include <memory>
 #include <set>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -9,9 +12,11 @@
 #include <players/Player.h>
 #include <tiles/Tile.h>
 #include <tiles/Tile_map.h>
+#include <tiles/Tile_store.h>
 #include <tiles/components/Area.h>
 #include <tiles/components/Border.h>
 #include <tiles/components/Hex.h>
+#include <tiles/components/Hex_range.h>
 #include <tiles/components/River.h>
 
 using namespace tile;
@@ -125,7 +130,7 @@ TEST(tile_map_test, add_tile_test)
 
   // Adding a river tile means all potential neighbors have to match with
   // rivers/non-river sides.
-  std::set<Direction> rp;
+  Direction_mask rp;
   rp.insert(Direction::east);
   rp.insert(Direction::south_west);
   std::shared_ptr<Tile> river_tile =
@@ -149,6 +154,60 @@ TEST(tile_map_test, add_tile_test)
   EXPECT_EQ(test_tile, plains_tile->get_neighbor(Direction::south_east));
 }
 
+TEST(tile_map_test, insert_many_test)
+{
+  Tile_map test_object = Tile_map();
+  Direction_mask rp;
+  rp.insert(Direction::east);
+  std::shared_ptr<Tile> base_tile = std::make_shared<Tile>();
+  std::shared_ptr<Tile> river_tile =
+      std::make_shared<Tile>(rp, Terrain::mountain);
+  std::shared_ptr<Tile> sea_tile = std::make_shared<Tile>(Terrain::sea);
+  std::shared_ptr<Tile> rock_tile = std::make_shared<Tile>(Terrain::rock);
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(0, 0, base_tile));
+
+  // A river running into a tile without one should fail the whole batch,
+  // leaving the map and every tile untouched.
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> bad_batch = {
+      {Hex(1, 0), river_tile}, {Hex(2, 0), rock_tile}};
+  EXPECT_EQ(common::ERR_FAIL, test_object.insert_many(bad_batch));
+  EXPECT_EQ(1, test_object.size());
+  EXPECT_EQ(nullptr, base_tile->get_neighbor(Direction::east));
+  EXPECT_EQ(nullptr, river_tile->get_neighbor(Direction::west));
+
+  // Null tiles, repeated spots, and occupied spots aren't allowed either.
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> null_batch = {
+      {Hex(1, 0), nullptr}};
+  EXPECT_EQ(common::ERR_INVALID, test_object.insert_many(null_batch));
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> repeat_batch = {
+      {Hex(1, 0), river_tile}, {Hex(1, 0), sea_tile}};
+  EXPECT_EQ(common::ERR_FAIL, test_object.insert_many(repeat_batch));
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> taken_batch = {
+      {Hex(0, 0), sea_tile}};
+  EXPECT_EQ(common::ERR_FAIL, test_object.insert_many(taken_batch));
+  EXPECT_EQ(1, test_object.size());
+
+  // A good batch gets linked to itself and to the tiles already placed.
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> batch = {
+      {Hex(1, 0), river_tile}, {Hex(2, 0), sea_tile}, {Hex(0, 1), rock_tile}};
+  EXPECT_EQ(common::ERR_NONE, test_object.insert_many(batch));
+  EXPECT_EQ(4, test_object.size());
+  EXPECT_TRUE(test_object.is_valid());
+  EXPECT_EQ(Hex(2, 0), sea_tile->get_hex());
+  EXPECT_EQ(river_tile, base_tile->get_neighbor(Direction::east));
+  EXPECT_EQ(base_tile, river_tile->get_neighbor(Direction::west));
+  EXPECT_EQ(sea_tile, river_tile->get_neighbor(Direction::east));
+  EXPECT_EQ(river_tile, sea_tile->get_neighbor(Direction::west));
+  EXPECT_EQ(rock_tile, river_tile->get_neighbor(Direction::south_west));
+  EXPECT_EQ(base_tile, rock_tile->get_neighbor(Direction::north_west));
+
+  // Locked maps can't take any more tiles.
+  test_object.set_lock(true);
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> late_batch = {
+      {Hex(5, 5), std::make_shared<Tile>()}};
+  EXPECT_EQ(common::ERR_FAIL, test_object.insert_many(late_batch));
+}
+
 TEST(tile_map_test, remove_tile_test)
 {
   Tile_map test_object = Tile_map();
@@ -177,14 +236,26 @@ TEST(tile_map_test, remove_tile_test)
   EXPECT_EQ(common::ERR_NONE, test_object.get_tile(2, 0, test_tile));
   EXPECT_EQ(rock_tile, test_tile);
 
+  // Tiles on the map are found by handle through the map.
+  const Tile_handle plains_handle = plains_tile->get_handle();
+  EXPECT_EQ(plains_tile.get(), test_object.resolve(plains_handle));
+
   // A valid remove should be fine.
   EXPECT_EQ(common::ERR_NONE, test_object.remove(1, 0));
   EXPECT_EQ(2, test_object.size());
   EXPECT_EQ(common::ERR_FAIL, test_object.get_tile(1, 0, test_tile));
   EXPECT_EQ(nullptr, test_tile);
-  // The neighbors should no longer track the removed tile
+  // The neighbors should no longer track the removed tile, nor it them.
   EXPECT_EQ(nullptr, base_tile->get_neighbor(Direction::east));
   EXPECT_EQ(nullptr, rock_tile->get_neighbor(Direction::west));
+  EXPECT_EQ(nullptr, plains_tile->get_neighbor(Direction::west));
+  EXPECT_EQ(nullptr, plains_tile->get_neighbor(Direction::east));
+  EXPECT_TRUE(plains_tile->get_handle().empty());
+  EXPECT_EQ(nullptr, test_object.resolve(plains_handle));
+  // Its slot goes to the next tile placed, under a new generation.
+  ASSERT_EQ(common::ERR_NONE,
+            test_object.insert(1, 0, std::make_shared<Tile>(Terrain::plains)));
+  EXPECT_EQ(nullptr, test_object.resolve(plains_handle));
 }
 
 TEST(tile_map_test, valid_map_test)
@@ -192,7 +263,7 @@ TEST(tile_map_test, valid_map_test)
   Tile_map test_object = Tile_map();
   std::shared_ptr<Tile> base_tile = std::make_shared<Tile>();
   std::shared_ptr<Tile> sea_tile = std::make_shared<Tile>(Terrain::sea);
-  std::set<Direction> rp;
+  Direction_mask rp;
   rp.insert(Direction::east);
   std::shared_ptr<Tile> river_tile =
       std::make_shared<Tile>(rp, Terrain::mountain);
@@ -212,4 +283,712 @@ TEST(tile_map_test, valid_map_test)
   // River runs into a sea tile; map should be valid again
   ASSERT_EQ(common::ERR_NONE, test_object.insert(2, 0, sea_tile));
   EXPECT_TRUE(test_object.is_valid());
-}
\ No newline at end of file
+}
+
+TEST(tile_map_test, invalid_hexes_test)
+{
+  Tile_map test_object = Tile_map();
+  Direction_mask rp;
+  rp.insert(Direction::east);
+  rp.insert(Direction::west);
+  std::shared_ptr<Tile> river_tile =
+      std::make_shared<Tile>(rp, Terrain::mountain);
+  std::shared_ptr<Tile> west_tile = std::make_shared<Tile>(Terrain::sea);
+  std::shared_ptr<Tile> east_tile = std::make_shared<Tile>(Terrain::sea);
+  EXPECT_TRUE(test_object.invalid_hexes().empty());
+
+  // Both of the river's points run off the map.
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(0, 0, river_tile));
+  EXPECT_FALSE(test_object.is_valid());
+  std::vector<Hex> expected = {Hex(0, 0)};
+  EXPECT_EQ(expected, test_object.invalid_hexes());
+
+  // Covering only one of the points still leaves the tile invalid.
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(-1, 0, west_tile));
+  EXPECT_FALSE(test_object.is_valid());
+  EXPECT_EQ(expected, test_object.invalid_hexes());
+
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(1, 0, east_tile));
+  EXPECT_TRUE(test_object.is_valid());
+  EXPECT_TRUE(test_object.invalid_hexes().empty());
+
+  // Removing a neighbor leaves the river dangling again.
+  ASSERT_EQ(common::ERR_NONE, test_object.remove(1, 0));
+  EXPECT_FALSE(test_object.is_valid());
+  EXPECT_EQ(expected, test_object.invalid_hexes());
+
+  // Removing the river tile itself clears up the map.
+  ASSERT_EQ(common::ERR_NONE, test_object.remove(0, 0));
+  EXPECT_TRUE(test_object.is_valid());
+  EXPECT_TRUE(test_object.invalid_hexes().empty());
+
+  test_object.reset();
+  EXPECT_FALSE(test_object.is_valid());
+  EXPECT_TRUE(test_object.invalid_hexes().empty());
+}
+
+TEST(tile_map_test, chunk_boundary_test)
+{
+  // Tiles are stored in fixed-size chunks of coordinates. Lookups, inserts,
+  // and removes should behave the same on either side of a chunk boundary,
+  // including for negative coordinates.
+  Tile_map test_object = Tile_map();
+  std::vector<std::shared_ptr<Tile>> tiles;
+  for (int q = -20; q <= 20; q++)
+  {
+    tiles.push_back(std::make_shared<Tile>(Terrain::plains));
+    ASSERT_EQ(common::ERR_NONE, test_object.insert(q, -q / 2, tiles.back()));
+  }
+  EXPECT_EQ(tiles.size(), test_object.size());
+
+  std::shared_ptr<Tile> test_tile;
+  for (int q = -20; q <= 20; q++)
+  {
+    EXPECT_EQ(common::ERR_NONE, test_object.get_tile(q, -q / 2, test_tile));
+    EXPECT_EQ(tiles.at(q + 20), test_tile);
+    EXPECT_EQ(Hex(q, -q / 2), test_tile->get_hex());
+    EXPECT_EQ(common::ERR_FAIL, test_object.get_tile(q, 1 - q / 2, test_tile));
+  }
+
+  // Emptying out a chunk shouldn't disturb tiles stored in other chunks.
+  for (int q = -20; q < 0; q++)
+  {
+    EXPECT_EQ(common::ERR_NONE, test_object.remove(q, -q / 2));
+  }
+  EXPECT_EQ(21, test_object.size());
+  for (int q = -20; q <= 20; q++)
+  {
+    EXPECT_EQ((q < 0 ? common::ERR_FAIL : common::ERR_NONE),
+              test_object.get_tile(q, -q / 2, test_tile));
+  }
+  EXPECT_EQ(common::ERR_NONE, test_object.insert(-20, 10, tiles.at(0)));
+  EXPECT_EQ(common::ERR_NONE, test_object.get_tile(-20, 10, test_tile));
+  EXPECT_EQ(tiles.at(0), test_tile);
+}
+
+template <class Store> void check_store()
+{
+  // Shuffle inserts and erases across a board, checking the store against a
+  // plain std::map as we go.
+  Store store;
+  std::map<Hex, int> expected;
+  std::vector<Hex> coords;
+  for (Hex h : hex_range(Hex(3, -2), 12))
+  {
+    coords.push_back(h);
+  }
+  uint32_t seed = 12345;
+  for (int step = 0; step < 4000; step++)
+  {
+    seed = seed * 1103515245 + 12345;
+    const Hex &h = coords[(seed >> 8) % coords.size()];
+    if (seed & 0x10000)
+    {
+      EXPECT_EQ(!expected.contains(h), store.insert(h, step));
+      expected.insert({h, step});
+    }
+    else
+    {
+      EXPECT_EQ(expected.contains(h), store.erase(h));
+      expected.erase(h);
+    }
+  }
+  ASSERT_EQ(expected.size(), store.size());
+  for (const Hex &h : coords)
+  {
+    const int *value = store.find(h);
+    ASSERT_EQ(expected.contains(h), nullptr != value);
+    if (nullptr != value)
+    {
+      EXPECT_EQ(expected.at(h), *value);
+    }
+  }
+  size_t visited = 0;
+  store.for_each([&](const Hex &h, const int &value)
+                 {
+                   EXPECT_EQ(expected.at(h), value);
+                   visited++;
+                 });
+  EXPECT_EQ(expected.size(), visited);
+
+  // Region queries should agree with the plain map as well.
+  size_t in_box = 0;
+  for (const auto &item : expected)
+  {
+    in_box += ((-2 <= item.first.q()) && (item.first.q() <= 5) &&
+               (-6 <= item.first.r()) && (item.first.r() <= 1));
+  }
+  visited = 0;
+  store.for_each_in_box(Hex(-2, -6), Hex(5, 1),
+                        [&](const Hex &, const int &) { visited++; });
+  EXPECT_EQ(in_box, visited);
+  Hex at;
+  const int *nearest =
+      store.nearest(
+          Hex(40, 40), [](const Hex &, const int &) { return true; }, at);
+  ASSERT_NE(nullptr, nearest);
+  for (const auto &item : expected)
+  {
+    EXPECT_LE(Hex(40, 40).distance(at), Hex(40, 40).distance(item.first));
+  }
+
+  // Copies change apart from the store they were copied from.
+  Store copy = store;
+  for (const auto &item : expected)
+  {
+    *copy.find(item.first) = -1;
+  }
+  copy.erase(expected.begin()->first);
+  EXPECT_EQ(expected.size() - 1, copy.size());
+  ASSERT_EQ(expected.size(), store.size());
+  for (const auto &item : expected)
+  {
+    EXPECT_EQ(item.second, *std::as_const(store).find(item.first));
+  }
+  store.clear();
+  EXPECT_TRUE(store.empty());
+  EXPECT_EQ(nullptr, store.find(coords.front()));
+}
+
+TEST(tile_map_test, store_backend_test)
+{
+  check_store<Chunked_store<int>>();
+  check_store<Tree_store<int>>();
+  check_store<Hashed_store<int>>();
+  check_store<Flat_store<int>>();
+}
+
+struct Parity_tag
+{
+  uint32_t operator()(const int &value) const { return 1 << (value & 1); }
+};
+
+TEST(tile_map_test, chunked_nearest_test)
+{
+  // Scatter values over a few distant islands, then check ring-by-ring
+  // searches with tag filters against a brute-force scan.
+  Chunked_store<int, 3, Parity_tag> store;
+  std::map<Hex, int> expected;
+  int value = 0;
+  for (Hex center : {Hex(0, 0), Hex(60, -20), Hex(-45, 90)})
+  {
+    for (Hex h : hex_range(center, 5))
+    {
+      // Leave the far island without any odd values.
+      int stored = (center == Hex(-45, 90) ? 2 * value : value);
+      store.insert(h, stored);
+      expected.insert({h, stored});
+      value++;
+    }
+  }
+  for (Hex from : {Hex(0, 0), Hex(3, 3), Hex(59, -18), Hex(-44, 88),
+                   Hex(200, 200), Hex(-300, 7)})
+  {
+    for (uint32_t tags : {1u, 2u, 3u})
+    {
+      auto pred = [tags](const Hex &, const int &v)
+      { return 0 != (tags & (1u << (v & 1))); };
+      int best = -1;
+      for (const auto &item : expected)
+      {
+        if (pred(item.first, item.second) &&
+            ((best < 0) || (from.distance(item.first) < best)))
+        {
+          best = from.distance(item.first);
+        }
+      }
+      Hex at;
+      const int *found = store.nearest(from, pred, at, tags);
+      ASSERT_NE(nullptr, found);
+      EXPECT_EQ(best, from.distance(at));
+      EXPECT_EQ(expected.at(at), *found);
+    }
+  }
+
+  // Once the home island's odd values are erased, the closest odd value is
+  // on the next island over.
+  for (Hex h : hex_range(Hex(0, 0), 5))
+  {
+    if (expected.at(h) & 1)
+    {
+      store.erase(h);
+    }
+  }
+  Hex at;
+  const int *found = store.nearest(
+      Hex(0, 0), [](const Hex &, const int &v) { return 0 != (v & 1); }, at,
+      1);
+  ASSERT_NE(nullptr, found);
+  EXPECT_EQ(1, *found & 1);
+  EXPECT_LT(50, Hex(0, 0).distance(at));
+}
+
+TEST(tile_map_test, compiled_map_test)
+{
+  Tile_map test_object = Tile_map();
+  Direction_mask rp;
+  rp.insert(Direction::east);
+  std::shared_ptr<Tile> base_tile = std::make_shared<Tile>();
+  std::shared_ptr<Tile> river_tile =
+      std::make_shared<Tile>(rp, Terrain::mountain);
+  std::shared_ptr<Tile> sea_tile = std::make_shared<Tile>(Terrain::sea);
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(0, 0, base_tile));
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(1, 0, river_tile));
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(2, 0, sea_tile));
+
+  // There's no compiled view until the map is locked.
+  EXPECT_EQ(nullptr, test_object.compiled());
+  test_object.set_lock(true);
+  const Compiled_map *compiled = test_object.compiled();
+  ASSERT_NE(nullptr, compiled);
+  ASSERT_EQ(3, compiled->size());
+
+  // Every tile should get a dense index that maps back to its coordinates,
+  // with its neighbors and flags matching the tile itself.
+  int32_t base_idx = compiled->index_of(Hex(0, 0));
+  int32_t river_idx = compiled->index_of(Hex(1, 0));
+  int32_t sea_idx = compiled->index_of(Hex(2, 0));
+  ASSERT_NE(Compiled_map::NO_NEIGHBOR, base_idx);
+  ASSERT_NE(Compiled_map::NO_NEIGHBOR, river_idx);
+  ASSERT_NE(Compiled_map::NO_NEIGHBOR, sea_idx);
+  EXPECT_EQ(Compiled_map::NO_NEIGHBOR, compiled->index_of(Hex(3, 0)));
+  EXPECT_EQ(base_tile.get(), compiled->tiles.at(base_idx));
+  EXPECT_EQ(Hex(1, 0), compiled->hexes.at(river_idx));
+
+  EXPECT_EQ(river_idx, compiled->neighbors.at(base_idx)[Direction::east]);
+  EXPECT_EQ(base_idx, compiled->neighbors.at(river_idx)[Direction::west]);
+  EXPECT_EQ(sea_idx, compiled->neighbors.at(river_idx)[Direction::east]);
+  EXPECT_EQ(Compiled_map::NO_NEIGHBOR,
+            compiled->neighbors.at(base_idx)[Direction::west]);
+
+  EXPECT_EQ(Terrain::mountain, compiled->terrain.at(river_idx));
+  EXPECT_EQ(1 << Direction::east, compiled->river_mask.at(river_idx));
+  EXPECT_EQ(0, compiled->river_mask.at(base_idx));
+  EXPECT_TRUE(compiled->shore.at(river_idx));
+  EXPECT_FALSE(compiled->shore.at(base_idx));
+  EXPECT_FALSE(compiled->shore.at(sea_idx));
+
+  // Unlocking discards the compiled view.
+  test_object.set_lock(false);
+  EXPECT_EQ(nullptr, test_object.compiled());
+}
+
+TEST(tile_map_test, shore_flags_test)
+{
+  Tile_map test_object = Tile_map();
+  std::shared_ptr<Tile> river_tile =
+      std::make_shared<Tile>(Direction_mask{east, west}, Terrain::forest);
+  std::shared_ptr<Tile> land_tile = std::make_shared<Tile>(Terrain::plains);
+  std::shared_ptr<Tile> sea_tile = std::make_shared<Tile>(Terrain::sea);
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(0, 0, land_tile));
+  EXPECT_FALSE(land_tile->is_shore());
+  EXPECT_TRUE(land_tile->get_sea_sides().empty());
+
+  // Rivers alone make a shore, but no river mouths.
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(0, 1, river_tile));
+  EXPECT_TRUE(river_tile->is_shore());
+  EXPECT_TRUE(river_tile->get_river_mouths().empty());
+
+  // Inserting a sea tile flags the sides of every tile it touches.
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(1, 0, sea_tile));
+  EXPECT_EQ(Direction_mask{east}, land_tile->get_sea_sides());
+  EXPECT_TRUE(land_tile->is_shore());
+  EXPECT_TRUE(land_tile->get_river_mouths().empty());
+  EXPECT_EQ(Direction_mask{north_east}, river_tile->get_sea_sides());
+  EXPECT_TRUE(river_tile->get_river_mouths().empty());
+  EXPECT_TRUE(sea_tile->get_sea_sides().empty());
+  EXPECT_FALSE(sea_tile->is_shore());
+
+  // A river running into the sea is a river mouth.
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> batch{
+      {Hex(1, 1), std::make_shared<Tile>(Terrain::sea)}};
+  ASSERT_EQ(common::ERR_NONE, test_object.insert_many(batch));
+  EXPECT_EQ((Direction_mask{north_east, east}), river_tile->get_sea_sides());
+  EXPECT_EQ(Direction_mask{east}, river_tile->get_river_mouths());
+  EXPECT_EQ(Direction_mask{south_east}, sea_tile->get_sea_sides());
+
+  // Forks keep the flags on their own copies.
+  Tile_map fork = test_object.fork();
+  std::shared_ptr<Tile> forked_land;
+  ASSERT_EQ(common::ERR_NONE, fork.get_tile(Hex(0, 0), forked_land));
+  EXPECT_NE(land_tile, forked_land);
+  EXPECT_EQ(Direction_mask{east}, forked_land->get_sea_sides());
+
+  // Removing the sea tile clears the flags it set. The tiles are still shared
+  // with the fork, so the map changes copies of them instead.
+  ASSERT_EQ(common::ERR_NONE, test_object.remove(1, 0));
+  ASSERT_EQ(common::ERR_NONE, test_object.get_tile(Hex(0, 0), land_tile));
+  ASSERT_EQ(common::ERR_NONE, test_object.get_tile(Hex(0, 1), river_tile));
+  EXPECT_TRUE(land_tile->get_sea_sides().empty());
+  EXPECT_FALSE(land_tile->is_shore());
+  EXPECT_EQ(Direction_mask{east}, river_tile->get_sea_sides());
+  EXPECT_EQ(Direction_mask{east}, forked_land->get_sea_sides());
+
+  test_object.set_lock(true);
+  const Compiled_map *compiled = test_object.compiled();
+  ASSERT_NE(nullptr, compiled);
+  EXPECT_EQ(1 << east, compiled->sea_sides.at(compiled->index_of(Hex(0, 1))));
+  EXPECT_EQ(0, compiled->sea_sides.at(compiled->index_of(Hex(0, 0))));
+}
+
+TEST(tile_map_test, region_query_test)
+{
+  Tile_map test_object = Tile_map();
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> batch;
+  for (Hex h : hex_spiral(Hex(0, 0), 2))
+  {
+    // Leave a couple of holes in the map.
+    if ((Hex(1, 0) != h) && (Hex(-2, 1) != h))
+    {
+      batch.push_back({h, std::make_shared<Tile>(Terrain::plains)});
+    }
+  }
+  ASSERT_EQ(common::ERR_NONE, test_object.insert_many(batch));
+
+  // Only placed tiles should come back from a region.
+  std::set<Hex> found;
+  for (const Tile *tile : test_object.tiles_in_ring(Hex(), 1))
+  {
+    EXPECT_EQ(1, Hex().distance(tile->get_hex()));
+    found.insert(tile->get_hex());
+  }
+  EXPECT_EQ(5, found.size());
+  EXPECT_FALSE(found.contains(Hex(1, 0)));
+
+  size_t count = 0;
+  for (const Tile *tile : test_object.tiles_in_spiral(Hex(), 3))
+  {
+    EXPECT_NE(nullptr, tile);
+    count++;
+  }
+  EXPECT_EQ(batch.size(), count);
+  EXPECT_EQ(batch.size(),
+            std::ranges::distance(test_object.tiles_in_range(Hex(), 2)));
+
+  // A line crossing a hole should skip it.
+  EXPECT_EQ(2, std::ranges::distance(
+                   test_object.tiles_on_line(Hex(0, 0), Hex(2, 0))));
+  EXPECT_EQ(0, std::ranges::distance(test_object.tiles_in_ring(Hex(), 4)));
+}
+
+TEST(tile_map_test, spatial_query_test)
+{
+  // Spread tiles across several chunks, with sea tiles along one column.
+  Tile_map test_object = Tile_map();
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> batch;
+  for (int q = -12; q <= 12; q++)
+  {
+    for (int r = -12; r <= 12; r++)
+    {
+      Terrain terrain = (9 == q) ? Terrain::sea : Terrain::plains;
+      batch.push_back({Hex(q, r), std::make_shared<Tile>(terrain)});
+    }
+  }
+  ASSERT_EQ(common::ERR_NONE, test_object.insert_many(batch));
+
+  // Box queries should match a brute force scan, whichever corners are used.
+  std::vector<std::shared_ptr<const Tile>> found =
+      test_object.tiles_in_box(Hex(3, 2), Hex(-5, -9));
+  EXPECT_EQ(9 * 12, found.size());
+  for (const auto &tile : found)
+  {
+    EXPECT_LE(-5, tile->get_hex().q());
+    EXPECT_GE(3, tile->get_hex().q());
+    EXPECT_LE(-9, tile->get_hex().r());
+    EXPECT_GE(2, tile->get_hex().r());
+  }
+  EXPECT_TRUE(test_object.tiles_in_box(Hex(20, 20), Hex(30, 30)).empty());
+
+  // Viewport rectangles are in drawn rows/columns, not axial coordinates.
+  found = test_object.tiles_in_view(-2, 0, 2, 3);
+  EXPECT_EQ(5 * 4, found.size());
+  for (const auto &tile : found)
+  {
+    Hex h = tile->get_hex();
+    EXPECT_LE(-2, h.q() + (h.r() >> 1));
+    EXPECT_GE(2, h.q() + (h.r() >> 1));
+  }
+
+  // Radius queries match the hex range around the center.
+  found = test_object.tiles_within(Hex(1, 1), 3);
+  EXPECT_EQ(37, found.size());
+  for (const auto &tile : found)
+  {
+    EXPECT_GE(3, Hex(1, 1).distance(tile->get_hex()));
+  }
+
+  // Removed tiles should no longer show up.
+  for (auto &item : batch)
+  {
+    if ((item.first.q() > -4) && (item.first.q() < 4) &&
+        (item.first.r() > -4) && (item.first.r() < 4))
+    {
+      ASSERT_EQ(common::ERR_NONE, test_object.remove(item.first));
+    }
+  }
+  EXPECT_TRUE(test_object.tiles_within(Hex(0, 0), 2).empty());
+  // Six of the radius 4 ring's hexes, like (2, 2), fall inside the removed box.
+  EXPECT_EQ(24 - 6, test_object.tiles_within(Hex(0, 0), 4).size());
+
+  // Nearest queries should find the closest tile of the terrain.
+  std::shared_ptr<const Tile> tile;
+  EXPECT_EQ(common::ERR_NONE,
+            test_object.nearest(Hex(0, 0), Terrain::sea, tile));
+  ASSERT_NE(nullptr, tile);
+  EXPECT_EQ(9, Hex(0, 0).distance(tile->get_hex()));
+  EXPECT_EQ(Terrain::sea, tile->get_terrain());
+  EXPECT_EQ(common::ERR_NONE,
+            test_object.nearest(Hex(0, 0), Terrain::plains, tile));
+  ASSERT_NE(nullptr, tile);
+  EXPECT_EQ(4, Hex(0, 0).distance(tile->get_hex()));
+  EXPECT_EQ(common::ERR_NOT_FOUND,
+            test_object.nearest(Hex(0, 0), Terrain::desert, tile));
+  EXPECT_EQ(nullptr, tile);
+  EXPECT_EQ(common::ERR_INVALID,
+            test_object.nearest(Hex(0, 0), Terrain::invalid, tile));
+}
+
+TEST(tile_map_test, fork_test)
+{
+  Tile_map test_object = Tile_map();
+  std::shared_ptr<Tile> forest =
+      std::make_shared<Tile>(Direction_mask{east}, Terrain::forest);
+  std::shared_ptr<Tile> sea = std::make_shared<Tile>(Terrain::sea);
+  std::shared_ptr<Tile> desert = std::make_shared<Tile>(Terrain::desert);
+  std::shared_ptr<Tile> plains = std::make_shared<Tile>(Terrain::plains);
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(0, 0, forest));
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(1, 0, sea));
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(0, 1, desert));
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(2, 0, plains));
+
+  // A fork shares the original's tiles until one of them changes.
+  Tile_map fork = test_object.fork();
+  EXPECT_TRUE(test_object.is_shared());
+  EXPECT_TRUE(fork.is_shared());
+  std::shared_ptr<const Tile> peeked;
+  ASSERT_EQ(common::ERR_NONE, fork.get_tile(Hex(0, 0), peeked));
+  EXPECT_EQ(forest, peeked);
+  EXPECT_TRUE(fork.is_shared());
+
+  // Getting a tile to change gives the fork its own copies of the tile and
+  // its neighbors, linked to each other rather than to the original's tiles.
+  // Tiles further out are still shared.
+  std::shared_ptr<Tile> forked_forest;
+  ASSERT_EQ(common::ERR_NONE, fork.get_tile(Hex(0, 0), forked_forest));
+  EXPECT_FALSE(fork.is_shared());
+  EXPECT_FALSE(test_object.is_shared());
+  ASSERT_NE(forest, forked_forest);
+  EXPECT_EQ(Terrain::forest, forked_forest->get_terrain());
+  EXPECT_TRUE(forked_forest->has_river_point(east));
+  EXPECT_NE(&forest->get_areas().front(),
+            &forked_forest->get_areas().front());
+  ASSERT_EQ(common::ERR_NONE, fork.get_tile(Hex(1, 0), peeked));
+  EXPECT_NE(sea, peeked);
+  EXPECT_EQ(forked_forest, peeked->get_neighbor(west));
+  EXPECT_EQ(peeked, forked_forest->get_neighbor(east));
+  ASSERT_EQ(common::ERR_NONE, fork.get_tile(Hex(2, 0), peeked));
+  EXPECT_EQ(plains, peeked);
+  EXPECT_EQ(sea, peeked->get_neighbor(west));
+  EXPECT_EQ(forest.get(), test_object.resolve(forest->get_handle()));
+
+  // Getting the next tile over copies that one's neighbors in turn.
+  std::shared_ptr<Tile> forked_sea;
+  std::shared_ptr<Tile> forked_desert;
+  ASSERT_EQ(common::ERR_NONE, fork.get_tile(Hex(1, 0), forked_sea));
+  ASSERT_EQ(common::ERR_NONE, fork.get_tile(Hex(0, 1), forked_desert));
+  EXPECT_EQ(forked_sea, forked_forest->get_neighbor(east));
+  EXPECT_EQ(forked_forest, forked_sea->get_neighbor(west));
+  EXPECT_EQ(forked_desert, forked_forest->get_neighbor(south_east));
+  ASSERT_EQ(common::ERR_NONE, fork.get_tile(Hex(2, 0), peeked));
+  EXPECT_NE(plains, peeked);
+  EXPECT_EQ(forked_sea, peeked->get_neighbor(west));
+  EXPECT_EQ(peeked, forked_sea->get_neighbor(east));
+  EXPECT_EQ(sea, forest->get_neighbor(east));
+  EXPECT_EQ(sea, plains->get_neighbor(west));
+
+  // Changes to the fork stay in the fork.
+  ASSERT_EQ(common::ERR_NONE,
+            forked_forest->build_wall(east, player::Color::blue, 1));
+  EXPECT_EQ(player::Color::neutral, forest->get_wall(east).color);
+  ASSERT_EQ(common::ERR_NONE, fork.remove(Hex(0, 1)));
+  EXPECT_EQ(3, fork.size());
+  EXPECT_EQ(4, test_object.size());
+  EXPECT_EQ(desert, forest->get_neighbor(south_east));
+  EXPECT_EQ(nullptr, forked_forest->get_neighbor(south_east));
+
+  // Copies are forks too, and the original copies its tiles just the same
+  // when it's the one to change. Tiles it doesn't touch stay shared.
+  Tile_map copy(test_object);
+  EXPECT_TRUE(copy.is_shared());
+  ASSERT_EQ(common::ERR_NONE,
+            test_object.insert(1, -1, std::make_shared<Tile>(Terrain::sea)));
+  EXPECT_EQ(5, test_object.size());
+  EXPECT_EQ(4, copy.size());
+  ASSERT_EQ(common::ERR_NONE, copy.get_tile(Hex(0, 0), peeked));
+  EXPECT_EQ(forest, peeked);
+  EXPECT_EQ(nullptr, forest->get_neighbor(north_east));
+  ASSERT_EQ(common::ERR_NONE, test_object.get_tile(Hex(0, 0), peeked));
+  EXPECT_NE(forest, peeked);
+  EXPECT_NE(nullptr, peeked->get_neighbor(north_east));
+  ASSERT_EQ(common::ERR_NONE, test_object.get_tile(Hex(0, 1), peeked));
+  EXPECT_EQ(desert, peeked);
+
+  // A tile that can't be linked up is turned away before anything changes,
+  // so the map is left as it was, still shared.
+  Tile_map spare = copy.fork();
+  std::shared_ptr<Tile> stray = std::make_shared<Tile>(Terrain::plains);
+  std::shared_ptr<Tile> linked =
+      std::make_shared<Tile>(Hex(3, 0), Terrain::plains);
+  ASSERT_EQ(common::ERR_NONE, linked->add_neighbor(stray, west));
+  EXPECT_EQ(common::ERR_FAIL, spare.insert(Hex(3, 0), linked));
+  EXPECT_TRUE(spare.is_shared());
+  EXPECT_EQ(4, spare.size());
+
+  // Locked forks share the compiled view until they copy a tile.
+  copy.set_lock(true);
+  Tile_map locked_fork = copy.fork();
+  EXPECT_EQ(copy.compiled(), locked_fork.compiled());
+  ASSERT_EQ(common::ERR_NONE, locked_fork.get_tile(Hex(0, 0), forked_forest));
+  ASSERT_NE(nullptr, locked_fork.compiled());
+  EXPECT_NE(copy.compiled(), locked_fork.compiled());
+  EXPECT_EQ(forked_forest.get(), locked_fork.compiled()->tiles.at(
+                                     locked_fork.compiled()->index_of(
+                                         Hex(0, 0))));
+  EXPECT_EQ(forest.get(),
+            copy.compiled()->tiles.at(copy.compiled()->index_of(Hex(0, 0))));
+}
+
+TEST(tile_map_test, fork_threads_test)
+{
+  // Forks of one map may be taken and changed from several threads at once,
+  // without touching the map or each other.
+  Tile_map test_object;
+  std::vector<std::pair<Hex, std::shared_ptr<Tile>>> batch;
+  for (const Hex coord : hex_spiral(Hex(), 2))
+  {
+    batch.push_back({coord, std::make_shared<Tile>(Terrain::plains)});
+  }
+  ASSERT_EQ(common::ERR_NONE, test_object.insert_many(batch));
+  const Tile_map &shared = test_object;
+  std::vector<Hex> ring;
+  for (const Hex coord : hex_ring(Hex(), 2))
+  {
+    ring.push_back(coord);
+  }
+
+  constexpr size_t THREADS = 8;
+  std::vector<Tile_map> forks(THREADS);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < THREADS; i++)
+  {
+    threads.emplace_back(
+        [&shared, &forks, &ring, i]()
+        {
+          forks[i] = shared.fork();
+          std::shared_ptr<Tile> center;
+          if (common::ERR_NONE == forks[i].get_tile(Hex(), center))
+          {
+            (void)center->build_wall(Direction::east, player::Color::blue,
+                                     1);
+          }
+          (void)forks[i].remove(ring[i]);
+        });
+  }
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+
+  std::shared_ptr<const Tile> peeked;
+  ASSERT_EQ(common::ERR_NONE, test_object.get_tile(Hex(), peeked));
+  EXPECT_EQ(player::Color::neutral, peeked->get_wall(Direction::east).color);
+  EXPECT_EQ(batch.size(), test_object.size());
+  for (size_t i = 0; i < THREADS; i++)
+  {
+    EXPECT_EQ(batch.size() - 1, forks[i].size());
+    EXPECT_EQ(common::ERR_FAIL, forks[i].get_tile(ring[i], peeked));
+    ASSERT_EQ(common::ERR_NONE, forks[i].get_tile(Hex(), peeked));
+    EXPECT_EQ(player::Color::blue, peeked->get_wall(Direction::east).color);
+  }
+
+  // The map takes a new stamp of its own once it changes after the forks.
+  std::shared_ptr<Tile> center;
+  ASSERT_EQ(common::ERR_NONE, test_object.get_tile(Hex(), center));
+  ASSERT_EQ(common::ERR_NONE,
+            center->build_wall(Direction::west, player::Color::red, 1));
+  ASSERT_EQ(common::ERR_NONE, forks[0].get_tile(Hex(), peeked));
+  EXPECT_EQ(player::Color::neutral, peeked->get_wall(Direction::west).color);
+}
+
+TEST(tile_map_test, release_test)
+{
+  // Neighbors don't keep each other alive, so dropping a map frees its tiles
+  // without having to unlink them first.
+  std::vector<std::weak_ptr<Tile>> released;
+  {
+    Tile_map test_object;
+    std::vector<std::pair<Hex, std::shared_ptr<Tile>>> batch;
+    for (const Hex coord : hex_spiral(Hex(), 2))
+    {
+      batch.push_back({coord, std::make_shared<Tile>(Terrain::plains)});
+      released.push_back(batch.back().second);
+    }
+    ASSERT_EQ(common::ERR_NONE, test_object.insert_many(batch));
+    batch.clear();
+    std::shared_ptr<Tile> center;
+    ASSERT_EQ(common::ERR_NONE, test_object.get_tile(Hex(), center));
+    EXPECT_NE(nullptr, center->get_neighbor(Direction::east));
+  }
+  for (const auto &tile : released)
+  {
+    EXPECT_TRUE(tile.expired());
+  }
+
+  // Tiles taken out of a map by its owner are unlinked from the tiles left
+  // behind once they're gone.
+  Tile_map test_object;
+  std::shared_ptr<Tile> kept = std::make_shared<Tile>(Terrain::plains);
+  std::shared_ptr<Tile> dropped = std::make_shared<Tile>(Terrain::plains);
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(Hex(0, 0), kept));
+  ASSERT_EQ(common::ERR_NONE, test_object.insert(Hex(1, 0), dropped));
+  ASSERT_EQ(dropped.get(), kept->neighbor_at(Direction::east));
+  test_object.reset();
+  dropped.reset();
+  EXPECT_EQ(nullptr, kept->neighbor_at(Direction::east));
+  EXPECT_EQ(nullptr, kept->get_neighbor(Direction::east));
+}
+
+TEST(tile_map_test, phase_test)
+{
+  // Each map keeps its own movement phase; a new phase on one game leaves
+  // carried resources in another alone.
+  Tile_map game;
+  Tile_map other_game;
+  std::shared_ptr<Tile> tile = std::make_shared<Tile>(Terrain::plains);
+  std::shared_ptr<Tile> other_tile = std::make_shared<Tile>(Terrain::plains);
+  ASSERT_EQ(common::ERR_NONE, game.insert(Hex(0, 0), tile));
+  ASSERT_EQ(common::ERR_NONE, other_game.insert(Hex(0, 0), other_tile));
+  const portable::Resource carried(portable::Resource::Type::goose,
+                                   {player::Color::red});
+  ASSERT_EQ(common::ERR_NONE, tile->get_areas()[0].add_resource(carried));
+  ASSERT_EQ(common::ERR_NONE,
+            other_tile->get_areas()[0].add_resource(carried));
+  EXPECT_TRUE(tile->get_areas()[0]
+                  .get_moveable_resources(player::Color::red)
+                  .empty());
+
+  game.next_phase();
+  EXPECT_EQ(1, game.phase());
+  EXPECT_EQ(0, other_game.phase());
+  EXPECT_EQ(1, tile->get_areas()[0]
+                   .get_moveable_resources(player::Color::red)
+                   .size());
+  EXPECT_TRUE(other_tile->get_areas()[0]
+                  .get_moveable_resources(player::Color::red)
+                  .empty());
+
+  // Forks play out the same game.
+  Tile_map fork = game.fork();
+  fork.next_phase();
+  EXPECT_EQ(2, game.phase());
+}
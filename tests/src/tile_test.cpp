@@ -1,5 +1,6 @@
 #include <iostream>
 #include <set>
+#include <span>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -15,58 +16,57 @@
 
 using namespace tile;
 
-std::vector<std::shared_ptr<Area>>
-copy_areas(std::vector<std::shared_ptr<Area>> areas)
+std::vector<std::shared_ptr<Area>> copy_areas(std::span<const Area> areas)
 {
   std::vector<std::shared_ptr<Area>> copied;
-  for (auto area : areas)
+  for (const auto &area : areas)
   {
-    copied.push_back(std::make_shared<Area>(area->get_borders()));
+    copied.push_back(std::make_shared<Area>(area.get_borders()));
   }
   return copied;
 }
 
 std::vector<std::shared_ptr<River>>
-copy_rivers(std::vector<std::shared_ptr<River>> rivers)
+copy_rivers(const std::vector<River> &rivers)
 {
   std::vector<std::shared_ptr<River>> copied;
-  for (auto river : rivers)
+  for (const auto &river : rivers)
   {
-    copied.push_back(std::make_shared<River>(river->get_points()));
+    copied.push_back(std::make_shared<River>(river.get_points()));
   }
   return copied;
 }
 
 void check_rivers(std::vector<std::shared_ptr<River>> exp,
-                  std::vector<std::shared_ptr<River>> actual, bool should_equal)
+                  const std::vector<River> &actual, bool should_equal)
 {
   ASSERT_EQ(exp.size(), actual.size());
   for (size_t i = 0; i < exp.size(); i++)
   {
     if (should_equal)
     {
-      EXPECT_EQ(exp.at(i)->get_points(), actual.at(i)->get_points());
+      EXPECT_EQ(exp.at(i)->get_points(), actual.at(i).get_points());
     }
     else
     {
-      EXPECT_NE(exp.at(i)->get_points(), actual.at(i)->get_points());
+      EXPECT_NE(exp.at(i)->get_points(), actual.at(i).get_points());
     }
   }
 }
 
 void check_areas(std::vector<std::shared_ptr<Area>> exp,
-                 std::vector<std::shared_ptr<Area>> actual, bool should_equal)
+                 std::span<const Area> actual, bool should_equal)
 {
   ASSERT_EQ(exp.size(), actual.size());
   for (size_t i = 0; i < exp.size(); i++)
   {
     if (should_equal)
     {
-      EXPECT_EQ(exp.at(i)->get_borders(), actual.at(i)->get_borders());
+      EXPECT_EQ(exp.at(i)->get_borders(), actual[i].get_borders());
     }
     else
     {
-      EXPECT_NE(exp.at(i)->get_borders(), actual.at(i)->get_borders());
+      EXPECT_NE(exp.at(i)->get_borders(), actual[i].get_borders());
     }
   }
 }
@@ -94,12 +94,12 @@ TEST(tile_test, create_tile_test)
     ASSERT_EQ(0, wall.thickness);
   }
 
-  ASSERT_EQ(ALL_BORDERS, (*test_object.get_areas().at(0)));
+  ASSERT_EQ(ALL_BORDERS, test_object.get_areas()[0]);
 
   // When we create a tile with rivers, it should create areas based on
   // those river points.
   // A river with just one point should result in a single area.
-  std::set<Direction> river_points;
+  Direction_mask river_points;
   river_points.insert(Direction::north_west);
   test_object = Tile(hex, river_points, terrain);
 
@@ -110,7 +110,7 @@ TEST(tile_test, create_tile_test)
   // A river with two points should result in two areas.
   // With river points at north_west and south_west, the areas created should
   // be: NW_right->SW_left SW_right->NW_left
-  std::set<Border> area_1, area_2;
+  Border_mask area_1, area_2;
   area_1.insert(Border::NW_right);
   area_1.insert(Border::NE_left);
   area_1.insert(Border::NE_right);
@@ -138,7 +138,7 @@ TEST(tile_test, create_tile_test)
   // NW_right->SE_left,
   // SE_right->SW_left, &
   // SW_right->NW_left
-  std::set<Border> area_3;
+  Border_mask area_3;
   area_1.erase(Border::SE_right);
   area_1.erase(Border::SW_left);
   area_3.insert(Border::SE_right);
@@ -176,10 +176,10 @@ TEST(tile_test, create_tile_test)
   area_3.insert(Border::NW_left);
 
   river_points.erase(Direction::south_east);
-  std::set<Direction> river_points_2;
+  Direction_mask river_points_2;
   river_points_2.insert(Direction::east);
   river_points_2.insert(Direction::south_east);
-  std::vector<std::set<Direction>> river_point_sets;
+  std::vector<Direction_mask> river_point_sets;
   river_point_sets.push_back(river_points);
   river_point_sets.push_back(river_points_2);
   test_object = Tile(hex, river_point_sets, terrain);
@@ -201,7 +201,7 @@ TEST(tile_test, add_neighbor_test)
   // Rivers should continue from tile to tile; this means if a tile has a
   // river point on the side that we're trying to add a neighbor, the neighbor
   // must also have a river point on its corresponding side.
-  std::set<Direction> river_points;
+  Direction_mask river_points;
   river_points.insert(Direction::north_east);
 
   Hex hex(0, 0);
@@ -262,7 +262,7 @@ TEST(tile_test, add_neighbor_test)
 
   // Here we reset the test tile to have a river point on the south_west
   // border.
-  std::set<Direction> test_river_points;
+  Direction_mask test_river_points;
   test_river_points.insert(Direction::south_west);
   test_object.reset();
   test_object = std::make_shared<Tile>(Tile(hex, test_river_points));
@@ -316,7 +316,7 @@ TEST(tile_test, build_road_test)
   // that it has a neighboring tile to share the road with, and that neither are
   // sea tiles. On a successful build, the neighbor should list the road in its
   // corresponding border.
-  std::set<Direction> rp;
+  Direction_mask rp;
   rp.insert(Direction::north_east);
   rp.insert(Direction::south_west);
   rp.insert(Direction::west);
@@ -374,7 +374,7 @@ TEST(tile_test, build_bridge_test)
   // Building a bridge from the tile's perspective should be as simple as
   // telling the associated river to do it. That river should enforce any
   // restrictions it has to building a bridge.
-  std::set<Direction> rp;
+  Direction_mask rp;
   rp.insert(Direction::north_east);
   rp.insert(Direction::south_west);
   rp.insert(Direction::west);
@@ -412,7 +412,7 @@ TEST(tile_test, rotate_test)
   // Rotating a tile should be clockwise. If the input value is negative, then
   // rotation is counter-clockwise.
   // This should rotate all of the Tile's river points accordingly.
-  std::set<Direction> rp;
+  Direction_mask rp;
   rp.insert(Direction::north_east);
   rp.insert(Direction::south_west);
   rp.insert(Direction::west);
@@ -523,4 +523,249 @@ TEST(tile_test, rotate_test)
     EXPECT_EQ(common::ERR_NONE, a->rotate(-15));
   }
   check_areas(areas, test->get_areas(), true);
-}
\ No newline at end of file
+}
+
+TEST(tile_test, lookup_test)
+{
+  // Areas and rivers should be found by border or side, and follow the tile
+  // as it rotates.
+  Direction_mask rp{Direction::north_east, Direction::south_west,
+                    Direction::west};
+  Tile test_object(rp);
+  for (int rotation = 0; rotation < MAX_DIRECTIONS; rotation++)
+  {
+    for (Border b : ALL_BORDERS)
+    {
+      ASSERT_NE(nullptr, test_object.get_area(b));
+      EXPECT_TRUE(test_object.get_area(b)->has_border(b));
+    }
+    for (Direction d : ALL_DIRECTIONS)
+    {
+      EXPECT_EQ(rp.contains(d), test_object.has_river_point(d));
+      EXPECT_EQ(rp.contains(d), test_object.get_river(d).has_value());
+    }
+    ASSERT_EQ(common::ERR_NONE, test_object.rotate(1));
+    rp = test_object.get_river_points();
+  }
+  EXPECT_EQ(nullptr, test_object.get_area(Border::invalid_border));
+  EXPECT_FALSE(test_object.get_river(Direction::invalid_direction));
+  EXPECT_FALSE(test_object.has_river_point(Direction::invalid_direction));
+}
+
+TEST(tile_test, neighbor_handle_test)
+{
+  // Tiles refer to their neighbors by handle without owning them. A link to
+  // a neighbor that's been destroyed reads as empty rather than dangling.
+  std::shared_ptr<Tile> test_object = std::make_shared<Tile>(Hex(0, 0));
+  std::shared_ptr<Tile> neighbor = std::make_shared<Tile>();
+  // Tiles only take a slot once they're linked.
+  EXPECT_TRUE(test_object->get_handle().empty());
+  EXPECT_EQ(nullptr, test_object->get_slots());
+
+  ASSERT_EQ(common::ERR_NONE,
+            test_object->add_neighbor(neighbor, Direction::east));
+  EXPECT_EQ(neighbor, test_object->get_neighbor(Direction::east));
+  EXPECT_EQ(neighbor.get(), test_object->neighbor_at(Direction::east));
+  // Linked tiles share a table, and each has a slot of its own in it.
+  std::shared_ptr<Tile_slots> slots = test_object->get_slots();
+  ASSERT_NE(nullptr, slots);
+  EXPECT_EQ(slots, neighbor->get_slots());
+  EXPECT_FALSE(test_object->get_handle().empty());
+  EXPECT_NE(test_object->get_handle(), neighbor->get_handle());
+  EXPECT_EQ(test_object.get(), slots->resolve(test_object->get_handle()));
+  // Copies are tiles of their own, but see the same neighbors.
+  Tile copy(*test_object);
+  EXPECT_TRUE(copy.get_handle().empty());
+  EXPECT_EQ(neighbor.get(), copy.neighbor_at(Direction::east));
+
+  Tile_handle stale = neighbor->get_handle();
+  neighbor.reset();
+  EXPECT_EQ(nullptr, slots->resolve(stale));
+  EXPECT_EQ(nullptr, test_object->get_neighbor(Direction::east));
+  EXPECT_EQ(nullptr, test_object->neighbor_at(Direction::east));
+
+  // The slot is free for another neighbor, which the stale handle never
+  // resolves to.
+  neighbor = std::make_shared<Tile>();
+  EXPECT_EQ(common::ERR_NONE,
+            test_object->add_neighbor(neighbor, Direction::east));
+  EXPECT_EQ(stale.index(), neighbor->get_handle().index());
+  EXPECT_EQ(nullptr, slots->resolve(stale));
+
+  // Slots given back the longest ago are reused first.
+  Tile_slots table;
+  Tile first, second;
+  Tile_handle a = table.acquire(&first);
+  Tile_handle b = table.acquire(&second);
+  table.release(a);
+  table.release(b);
+  EXPECT_EQ(a.index(), table.acquire(&first).index());
+  EXPECT_EQ(b.index(), table.acquire(&second).index());
+
+  // Handles pack both into 4 bytes, so a slot is retired once its generation
+  // runs out, rather than reused under a generation old handles still carry.
+  Tile_slots worn;
+  const Tile_handle original = worn.acquire(&first);
+  Tile_handle handle = original;
+  for (uint32_t i = 0; i < Tile_handle::GENERATION_MASK; i++)
+  {
+    worn.release(handle);
+    handle = worn.acquire(&first);
+    ASSERT_EQ(original.index(), handle.index());
+  }
+  EXPECT_EQ(Tile_handle::GENERATION_MASK, handle.generation());
+  EXPECT_EQ(nullptr, worn.resolve(original));
+  worn.release(handle);
+  Tile_handle fresh = worn.acquire(&second);
+  EXPECT_NE(original.index(), fresh.index());
+  EXPECT_EQ(&second, worn.resolve(fresh));
+  EXPECT_EQ(nullptr, worn.resolve(handle));
+}
+
+static_assert(Direction::east == rotated(Direction::north_west, 2));
+static_assert(Border::NW_right == rotated(Border::W_right, 1));
+static_assert(Direction_mask{Direction::north_west, Direction::west} ==
+              rotated(Direction_mask{Direction::west, Direction::south_west},
+                      clockwise_steps(-5)));
+
+TEST(tile_test, rotated_view_test)
+{
+  // A view should see exactly what the tile would after rotating it, for
+  // every orientation, while the tile itself stays put.
+  Direction_mask rp{Direction::north_west, Direction::east};
+  Tile tile(rp, Terrain::plains);
+  for (int rotations = -6; rotations <= 6; rotations++)
+  {
+    Rotated_tile view = tile.rotated_view(rotations);
+    Tile turned(rp, Terrain::plains);
+    ASSERT_EQ(common::ERR_NONE, turned.rotate(rotations));
+
+    EXPECT_EQ(turned.get_river_points(), view.get_river_points());
+    for (Direction d : ALL_DIRECTIONS)
+    {
+      EXPECT_EQ(turned.has_river_point(d), view.has_river_point(d));
+    }
+    for (Border b : ALL_BORDERS)
+    {
+      EXPECT_EQ(turned.get_area(b)->get_borders(), view.get_area_borders(b));
+    }
+    EXPECT_EQ(rp, tile.get_river_points());
+  }
+  EXPECT_EQ(nullptr, tile.rotated_view(1).get_area(Border::invalid_border));
+  EXPECT_FALSE(tile.rotated_view(1).has_river_point(
+      Direction::invalid_direction));
+
+  // Fitting against a neighbor follows the neighbor's river points.
+  Tile neighbor(Direction_mask{Direction::west}, Terrain::plains);
+  EXPECT_TRUE(tile.rotated_view(0).fits(neighbor, Direction::east));
+  EXPECT_FALSE(tile.rotated_view(1).fits(neighbor, Direction::east));
+  EXPECT_TRUE(tile.rotated_view(2).fits(neighbor, Direction::east));
+  Tile sea(Terrain::sea);
+  EXPECT_TRUE(tile.rotated_view(1).fits(sea, Direction::east));
+}
+
+TEST(tile_test, prototype_test)
+{
+  // Tiles of the same shape share a prototype, whichever way they were made.
+  Direction_mask rp{Direction::north_east, Direction::south_west};
+  Tile first(rp, Terrain::forest);
+  Tile second(Hex(2, -1), rp, Terrain::forest);
+  Tile listed(std::vector<Direction_mask>{rp}, Terrain::forest);
+  EXPECT_EQ(first.get_prototype(), second.get_prototype());
+  EXPECT_EQ(first.get_prototype(), listed.get_prototype());
+  EXPECT_NE(first.get_prototype(), Tile(rp, Terrain::plains).get_prototype());
+  EXPECT_EQ(Terrain::forest, first.get_prototype()->terrain());
+  EXPECT_EQ(rp, first.get_prototype()->river_points());
+
+  size_t made = Tile_prototype::count();
+  for (int i = 0; i < 100; i++)
+  {
+    Tile other(rp, Terrain::forest);
+  }
+  EXPECT_EQ(made, Tile_prototype::count());
+
+  // Rotating moves a tile onto the rotated shape's prototype, and rotating
+  // back returns it to where it started.
+  const Tile_prototype *start = first.get_prototype();
+  ASSERT_EQ(common::ERR_NONE, first.rotate(2));
+  EXPECT_EQ(start->rotated(2), first.get_prototype());
+  EXPECT_EQ(rotated(rp, 2), first.get_river_points());
+  ASSERT_EQ(common::ERR_NONE, first.rotate(-2));
+  EXPECT_EQ(start, first.get_prototype());
+
+  // Loaded tiles land on the same prototype as the tile they were saved from.
+  nlohmann::json j = second;
+  Tile loaded = j.get<Tile>();
+  EXPECT_EQ(second.get_prototype(), loaded.get_prototype());
+
+  // Sea tiles never have rivers.
+  Tile sea(rp, Terrain::sea);
+  EXPECT_EQ(Tile(Terrain::sea).get_prototype(), sea.get_prototype());
+  EXPECT_EQ(0, sea.get_rivers().size());
+}
+
+TEST(tile_test, fingerprint_test)
+{
+  Direction_mask rp{Direction::north_west, Direction::south_east};
+  Tile tile(Hex(0, 0), rp, Terrain::plains);
+  Tile same(rp, Terrain::plains);
+  // Position isn't structure; matching tiles anywhere share a fingerprint.
+  EXPECT_EQ(tile.fingerprint(), same.fingerprint());
+  EXPECT_EQ(tile.fingerprint(),
+            Tile(Hex(4, 4), rp, Terrain::plains).fingerprint());
+  EXPECT_NE(tile.fingerprint(),
+            Tile(Hex(0, 0), rp, Terrain::forest).fingerprint());
+
+  // Copies compare equal, so they must share a fingerprint.
+  Tile copy(tile);
+  EXPECT_TRUE(copy == tile);
+  EXPECT_EQ(tile.fingerprint(), copy.fingerprint());
+
+  // Rotating, building and walling each change the fingerprint.
+  uint64_t before = same.fingerprint();
+  ASSERT_EQ(common::ERR_NONE, same.rotate(1));
+  EXPECT_NE(before, same.fingerprint());
+  ASSERT_EQ(common::ERR_NONE, same.rotate(-1));
+  EXPECT_EQ(before, same.fingerprint());
+
+  // Changes made straight to an area still show up.
+  before = tile.fingerprint();
+  ASSERT_EQ(common::ERR_NONE,
+            tile.get_area(Border::NE_left)->build(Border::NE_left));
+  EXPECT_NE(before, tile.fingerprint());
+
+  before = tile.fingerprint();
+  ASSERT_EQ(common::ERR_NONE, tile.build_bridge(Direction::north_west));
+  EXPECT_NE(before, tile.fingerprint());
+
+  // Walls need a neighbor to face, but the neighbor itself isn't structure.
+  before = tile.fingerprint();
+  std::shared_ptr<Tile> neighbor = std::make_shared<Tile>(Terrain::plains);
+  ASSERT_EQ(common::ERR_NONE, tile.add_neighbor(neighbor, Direction::east));
+  EXPECT_EQ(before, tile.fingerprint());
+  ASSERT_EQ(common::ERR_NONE,
+            tile.build_wall(Direction::east, player::Color::red, 1));
+  EXPECT_NE(before, tile.fingerprint());
+
+  // A matching tile can still be linked, while a copy of a linked one can't.
+  std::shared_ptr<Tile> twin = std::make_shared<Tile>(Terrain::plains);
+  EXPECT_EQ(neighbor->fingerprint(), twin->fingerprint());
+  EXPECT_EQ(common::ERR_NONE, tile.add_neighbor(twin, Direction::west));
+  std::shared_ptr<Tile> twin_copy = std::make_shared<Tile>(*twin);
+  EXPECT_EQ(common::ERR_FAIL,
+            tile.add_neighbor(twin_copy, Direction::south_west));
+
+  // Loading a saved tile gives back the same fingerprint.
+  nlohmann::json j = tile;
+  Tile loaded = j.get<Tile>();
+  EXPECT_EQ(tile.fingerprint(), loaded.fingerprint());
+
+  // Rivers and areas carry fingerprints of their own.
+  River river(rp);
+  River other(rp);
+  EXPECT_EQ(river.fingerprint(), other.fingerprint());
+  ASSERT_EQ(common::ERR_NONE, other.build(Direction::south_east));
+  EXPECT_NE(river.fingerprint(), other.fingerprint());
+  EXPECT_NE(Area(ALL_BORDERS).fingerprint(),
+            Area(Border_mask{Border::NW_left}).fingerprint());
+}